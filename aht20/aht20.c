@@ -1,5 +1,48 @@
 #include "aht20.h"
 
+#include <string.h>
+#include <hardware/sync.h>
+
+#if AHT20_CHECK_CRC
+#define AHT20_FRAME_LEN 7 // Status, 5 bytes de dados e CRC
+#else
+#define AHT20_FRAME_LEN 6
+#endif
+
+uint8_t aht20_crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Valida o quadro lido (CRC) e converte os dados brutos
+static bool aht20_parse(const uint8_t *buffer, AHT20_Fixed *data) {
+#if AHT20_CHECK_CRC
+    if (aht20_crc8(buffer, 6) != buffer[6]) {
+        return false;
+    }
+#endif
+
+    // Umidade e temperatura: 20 bits cada, com o byte 3 dividido entre as duas
+    data->raw_humidity = ((uint32_t)buffer[1] << 12) | ((uint32_t)buffer[2] << 4) | (buffer[3] >> 4);
+    data->raw_temperature = ((uint32_t)(buffer[3] & 0x0F) << 16) | ((uint32_t)buffer[4] << 8) | buffer[5];
+    data->humidity = aht20_humidity_centi(data->raw_humidity);
+    data->temperature = aht20_temperature_centi(data->raw_temperature);
+
+    return true;
+}
+
+void aht20_fixed_to_float(const AHT20_Fixed *fixed, AHT20_Data *data) {
+    // A resolução do sensor é de 0,01 °C / 0,024 %: os centésimos não perdem informação
+    data->temperature = (float)fixed->temperature * 0.01f;
+    data->humidity = (float)fixed->humidity * 0.01f;
+}
+
 bool aht20_init(i2c_inst_t *i2c) {
     uint8_t init_cmd[3] = {AHT20_CMD_INIT, 0x08, 0x00};
     i2c_write_blocking(i2c, AHT20_I2C_ADDR, init_cmd, 3, false);
@@ -18,9 +61,9 @@ bool aht20_init(i2c_inst_t *i2c) {
     return false; // Falhou na calibração
 }
 
-bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data) {
+bool aht20_read_fixed(i2c_inst_t *i2c, AHT20_Fixed *data) {
     uint8_t trigger_cmd[3] = {AHT20_CMD_TRIGGER, 0x33, 0x00};
-    uint8_t buffer[6];
+    uint8_t buffer[AHT20_FRAME_LEN];
 
     // Envia comando de medição
     i2c_write_blocking(i2c, AHT20_I2C_ADDR, trigger_cmd, 3, false);
@@ -40,19 +83,20 @@ bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data) {
         return false;
     }
 
-    // Lê os 6 bytes de dados
-    if (i2c_read_blocking(i2c, AHT20_I2C_ADDR, buffer, 6, false) != 6) {
+    // Lê o status, os dados e o CRC
+    if (i2c_read_blocking(i2c, AHT20_I2C_ADDR, buffer, AHT20_FRAME_LEN, false) != AHT20_FRAME_LEN) {
         return false;
     }
 
-    // Processa os dados de umidade (20 bits)
-    uint32_t raw_humidity = ((uint32_t)buffer[1] << 12) | ((uint32_t)buffer[2] << 4) | (buffer[3] >> 4);
-    data->humidity = (float)raw_humidity * 100.0 / 1048576.0;
-
-    // Processa os dados de temperatura (20 bits)
-    uint32_t raw_temp = ((uint32_t)(buffer[3] & 0x0F) << 16) | ((uint32_t)buffer[4] << 8) | buffer[5];
-    data->temperature = ((float)raw_temp * 200.0 / 1048576.0) - 50.0;
+    return aht20_parse(buffer, data);
+}
 
+bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data) {
+    AHT20_Fixed fixed;
+    if (!aht20_read_fixed(i2c, &fixed)) {
+        return false;
+    }
+    aht20_fixed_to_float(&fixed, data);
     return true;
 }
 
@@ -66,4 +110,312 @@ bool aht20_reset(i2c_inst_t *i2c) {
 bool aht20_check(i2c_inst_t *i2c) {
     uint8_t status;
     return i2c_read_blocking(i2c, AHT20_I2C_ADDR, &status, 1, false) == 1;
-}
\ No newline at end of file
+}
+
+// Alarme de hardware: apenas sinaliza; a transferência I2C fica para o poll
+static int64_t aht20_alarm(alarm_id_t id, void *user_data) {
+    AHT20_Timer *timer = (AHT20_Timer *)user_data;
+    timer->id = 0; // O ID volta a ficar livre e pode ser reusado por outro alarme
+    timer->due = true;
+    return 0;
+}
+
+// Agenda a próxima etapa de uma máquina de estados (sensor único ou conjunto)
+static bool aht20_timer_schedule(AHT20_Timer *timer, uint32_t ms) {
+    timer->due = false;
+    alarm_id_t id = add_alarm_in_ms(ms, aht20_alarm, timer, true);
+    if (id < 0) {
+        return false; // Sem alarmes livres
+    }
+    uint32_t irq = save_and_disable_interrupts();
+    if (!timer->due) {
+        timer->id = id; // Ainda pendente: se já disparou, o ID não é mais nosso
+    }
+    restore_interrupts(irq);
+    return true;
+}
+
+// Cancela a espera pendente, se houver
+static void aht20_timer_cancel(AHT20_Timer *timer) {
+    alarm_id_t id = timer->id;
+    if (id > 0) {
+        cancel_alarm(id);
+    }
+    timer->id = 0;
+    timer->due = false;
+}
+
+static bool aht20_schedule(AHT20_Async *sensor, uint32_t ms) {
+    return aht20_timer_schedule(&sensor->timer, ms);
+}
+
+bool aht20_begin(AHT20_Async *sensor, i2c_inst_t *i2c, AHT20_Callback callback) {
+    aht20_timer_cancel(&sensor->timer);
+    sensor->i2c = i2c;
+    sensor->callback = callback;
+    sensor->retries = 0;
+
+    uint8_t reset_cmd = AHT20_CMD_RESET;
+    if (i2c_write_blocking(i2c, AHT20_I2C_ADDR, &reset_cmd, 1, false) != 1 ||
+        !aht20_schedule(sensor, AHT20_RESET_MS)) {
+        sensor->state = AHT20_STATE_ERROR;
+        return false;
+    }
+    sensor->state = AHT20_STATE_RESETTING;
+    return true;
+}
+
+bool aht20_start_measurement(AHT20_Async *sensor) {
+    if (sensor->state != AHT20_STATE_IDLE) {
+        return false;
+    }
+
+    uint8_t trigger_cmd[3] = {AHT20_CMD_TRIGGER, 0x33, 0x00};
+    if (i2c_write_blocking(sensor->i2c, AHT20_I2C_ADDR, trigger_cmd, 3, false) != 3 ||
+        !aht20_schedule(sensor, AHT20_MEASURE_MS)) {
+        return false;
+    }
+    sensor->retries = 0;
+    sensor->state = AHT20_STATE_MEASURING;
+    return true;
+}
+
+// Termina a medição em andamento e avisa a aplicação
+static bool aht20_finish(AHT20_Async *sensor, bool ok) {
+    sensor->state = AHT20_STATE_IDLE;
+    if (sensor->callback) {
+        sensor->callback(sensor, ok);
+    }
+    return ok;
+}
+
+bool aht20_poll(AHT20_Async *sensor) {
+    if (!sensor->timer.due) {
+        return false;
+    }
+    sensor->timer.due = false;
+
+    switch (sensor->state) {
+        case AHT20_STATE_RESETTING: {
+            uint8_t init_cmd[3] = {AHT20_CMD_INIT, 0x08, 0x00};
+            if (i2c_write_blocking(sensor->i2c, AHT20_I2C_ADDR, init_cmd, 3, false) != 3 ||
+                !aht20_schedule(sensor, AHT20_INIT_MS)) {
+                sensor->state = AHT20_STATE_ERROR;
+                return false;
+            }
+            sensor->state = AHT20_STATE_INITIALIZING;
+            return false;
+        }
+
+        case AHT20_STATE_INITIALIZING: {
+            uint8_t status;
+            bool ok = i2c_read_blocking(sensor->i2c, AHT20_I2C_ADDR, &status, 1, false) == 1;
+            if (ok && (status & AHT20_STATUS_CALIBRATED)) {
+                sensor->state = AHT20_STATE_IDLE;
+            } else if (ok && sensor->retries++ < AHT20_RETRIES && aht20_schedule(sensor, AHT20_RETRY_MS)) {
+                // Ainda calibrando: consulta de novo
+            } else {
+                sensor->state = AHT20_STATE_ERROR;
+            }
+            return false;
+        }
+
+        case AHT20_STATE_MEASURING: {
+            uint8_t buffer[AHT20_FRAME_LEN];
+            if (i2c_read_blocking(sensor->i2c, AHT20_I2C_ADDR, buffer, AHT20_FRAME_LEN, false) != AHT20_FRAME_LEN) {
+                return aht20_finish(sensor, false);
+            }
+            if (buffer[0] & AHT20_STATUS_BUSY) {
+                // Conversão mais lenta que o previsto: consulta de novo em instantes
+                if (sensor->retries++ < AHT20_RETRIES && aht20_schedule(sensor, AHT20_RETRY_MS)) {
+                    return false;
+                }
+                return aht20_finish(sensor, false);
+            }
+            if (!aht20_parse(buffer, &sensor->fixed)) {
+                return aht20_finish(sensor, false);
+            }
+            aht20_fixed_to_float(&sensor->fixed, &sensor->data);
+            return aht20_finish(sensor, true);
+        }
+
+        default:
+            return false;
+    }
+}
+
+// Habilita os canais `mask` do multiplexador (0 libera todos)
+static bool tca9548a_select(i2c_inst_t *i2c, uint8_t mux_addr, uint8_t mask) {
+    return i2c_write_blocking(i2c, mux_addr, &mask, 1, false) == 1;
+}
+
+// Conecta o sensor `index` ao barramento, liberando o multiplexador anterior se for outro
+static bool aht20_array_select(AHT20_Array *array, uint8_t index) {
+    uint8_t mux_addr = array->sensors[index].mux_addr;
+    if (array->selected_mux && array->selected_mux != mux_addr) {
+        tca9548a_select(array->i2c, array->selected_mux, 0);
+    }
+    array->selected_mux = mux_addr;
+    return tca9548a_select(array->i2c, mux_addr, 1u << array->sensors[index].channel);
+}
+
+// Desconecta todos os sensores, deixando o barramento para os outros dispositivos
+static void aht20_array_release(AHT20_Array *array) {
+    if (array->selected_mux) {
+        tca9548a_select(array->i2c, array->selected_mux, 0);
+        array->selected_mux = 0;
+    }
+}
+
+// Envia `cmd` aos sensores de `mask`, em sequência; retorna os que aceitaram
+static uint32_t aht20_array_write(AHT20_Array *array, uint32_t mask, const uint8_t *cmd, size_t len) {
+    uint32_t ok = 0;
+    for (uint8_t i = 0; i < array->count; i++) {
+        if ((mask & (1u << i)) && aht20_array_select(array, i) &&
+            i2c_write_blocking(array->i2c, AHT20_I2C_ADDR, cmd, len, false) == (int)len) {
+            ok |= 1u << i;
+        }
+    }
+    aht20_array_release(array);
+    return ok;
+}
+
+_Static_assert(AHT20_ARRAY_MAX <= 32, "AHT20_ARRAY_MAX acima do tamanho das máscaras");
+
+void aht20_array_init(AHT20_Array *array, i2c_inst_t *i2c, AHT20_Array_Callback callback) {
+    memset(array, 0, sizeof(*array));
+    array->i2c = i2c;
+    array->callback = callback;
+    array->state = AHT20_STATE_ERROR; // Até aht20_array_begin
+}
+
+int aht20_array_add(AHT20_Array *array, uint8_t mux_addr, uint8_t channel) {
+    if (array->count >= AHT20_ARRAY_MAX || channel > 7 || mux_addr == 0) {
+        return -1;
+    }
+    array->sensors[array->count].mux_addr = mux_addr;
+    array->sensors[array->count].channel = channel;
+    return array->count++;
+}
+
+bool aht20_array_begin(AHT20_Array *array) {
+    aht20_timer_cancel(&array->timer);
+    array->retries = 0;
+    array->valid = 0;
+
+    // Reset de todos em sequência; os 20 ms de espera são compartilhados
+    uint8_t reset_cmd = AHT20_CMD_RESET;
+    uint32_t all = array->count ? UINT32_MAX >> (32 - array->count) : 0;
+    array->present = aht20_array_write(array, all, &reset_cmd, 1);
+    if (!array->present || !aht20_timer_schedule(&array->timer, AHT20_RESET_MS)) {
+        array->state = AHT20_STATE_ERROR;
+        return false;
+    }
+    array->state = AHT20_STATE_RESETTING;
+    return true;
+}
+
+bool aht20_array_start(AHT20_Array *array) {
+    if (array->state != AHT20_STATE_IDLE) {
+        return false;
+    }
+
+    // Dispara todos em sequência: as conversões acontecem em paralelo
+    uint8_t trigger_cmd[3] = {AHT20_CMD_TRIGGER, 0x33, 0x00};
+    array->pending = aht20_array_write(array, array->present, trigger_cmd, 3);
+    if (!array->pending || !aht20_timer_schedule(&array->timer, AHT20_MEASURE_MS)) {
+        return false;
+    }
+    array->valid = 0;
+    array->retries = 0;
+    array->state = AHT20_STATE_MEASURING;
+    return true;
+}
+
+// Lê o status dos sensores em calibração; os calibrados saem de `pending`
+static void aht20_array_check_calibration(AHT20_Array *array) {
+    for (uint8_t i = 0; i < array->count; i++) {
+        uint8_t status;
+        if (!(array->pending & (1u << i)) || !aht20_array_select(array, i)) {
+            continue;
+        }
+        if (i2c_read_blocking(array->i2c, AHT20_I2C_ADDR, &status, 1, false) != 1) {
+            array->pending &= ~(1u << i); // Não respondeu: fica fora do conjunto
+            array->present &= ~(1u << i);
+        } else if (status & AHT20_STATUS_CALIBRATED) {
+            array->pending &= ~(1u << i);
+        }
+    }
+    aht20_array_release(array);
+}
+
+// Coleta os sensores com medição pendente; os ainda ocupados continuam em `pending`
+static void aht20_array_collect(AHT20_Array *array) {
+    for (uint8_t i = 0; i < array->count; i++) {
+        uint8_t buffer[AHT20_FRAME_LEN];
+        if (!(array->pending & (1u << i))) {
+            continue;
+        }
+        if (!aht20_array_select(array, i) ||
+            i2c_read_blocking(array->i2c, AHT20_I2C_ADDR, buffer, AHT20_FRAME_LEN, false) != AHT20_FRAME_LEN) {
+            array->pending &= ~(1u << i);
+            continue;
+        }
+        if (buffer[0] & AHT20_STATUS_BUSY) {
+            continue;
+        }
+        array->pending &= ~(1u << i);
+        if (aht20_parse(buffer, &array->sensors[i].fixed)) {
+            aht20_fixed_to_float(&array->sensors[i].fixed, &array->sensors[i].data);
+            array->valid |= 1u << i;
+        }
+    }
+    aht20_array_release(array);
+}
+
+bool aht20_array_poll(AHT20_Array *array) {
+    if (!array->timer.due) {
+        return false;
+    }
+    array->timer.due = false;
+
+    switch (array->state) {
+        case AHT20_STATE_RESETTING: {
+            uint8_t init_cmd[3] = {AHT20_CMD_INIT, 0x08, 0x00};
+            array->pending = aht20_array_write(array, array->present, init_cmd, 3);
+            if (!array->pending || !aht20_timer_schedule(&array->timer, AHT20_INIT_MS)) {
+                array->state = AHT20_STATE_ERROR;
+                return false;
+            }
+            array->state = AHT20_STATE_INITIALIZING;
+            return false;
+        }
+
+        case AHT20_STATE_INITIALIZING:
+            aht20_array_check_calibration(array);
+            if (array->pending && array->retries++ < AHT20_RETRIES &&
+                aht20_timer_schedule(&array->timer, AHT20_RETRY_MS)) {
+                return false; // Algum sensor ainda calibrando
+            }
+            array->present &= ~array->pending; // Não calibraram: ficam fora do conjunto
+            array->pending = 0;
+            array->state = array->present ? AHT20_STATE_IDLE : AHT20_STATE_ERROR;
+            return false;
+
+        case AHT20_STATE_MEASURING:
+            aht20_array_collect(array);
+            if (array->pending && array->retries++ < AHT20_RETRIES &&
+                aht20_timer_schedule(&array->timer, AHT20_RETRY_MS)) {
+                return false; // Algum sensor ainda convertendo
+            }
+            array->pending = 0;
+            array->state = AHT20_STATE_IDLE;
+            if (array->callback) {
+                array->callback(array, array->valid);
+            }
+            return true;
+
+        default:
+            return false;
+    }
+}
@@ -23,6 +23,26 @@
 #define AHT20_STATUS_BUSY 0x80       // Bit de status ocupado
 #define AHT20_STATUS_CALIBRATED 0x08 // Bit de calibração
 
+// Tempos do datasheet, em ms
+#define AHT20_RESET_MS   20 // Reset por software
+#define AHT20_INIT_MS    10 // Comando de inicialização (calibração)
+#define AHT20_MEASURE_MS 80 // Conversão de uma medição
+#define AHT20_RETRY_MS   10 // Nova consulta enquanto o sensor ainda estiver ocupado
+#define AHT20_RETRIES    5  // Consultas extras antes de desistir da medição
+
+// Endereço padrão do multiplexador I2C TCA9548A (0x70 a 0x77, conforme os pinos A0–A2)
+#define TCA9548A_I2C_ADDR 0x70
+
+// Quantidade máxima de sensores em um AHT20_Array (até 32)
+#ifndef AHT20_ARRAY_MAX
+#define AHT20_ARRAY_MAX 16
+#endif
+
+// Verifica o byte de CRC-8 enviado após os dados. O AHT10 não envia o CRC: defina como 0 para ele.
+#ifndef AHT20_CHECK_CRC
+#define AHT20_CHECK_CRC 1
+#endif
+
 /**
  * @brief Estrutura para armazenar os dados lidos do sensor AHT20.
  */
@@ -31,6 +51,133 @@ typedef struct {
     float humidity;    // Relative Humidity in percentage
 } AHT20_Data;
 
+/**
+ * @brief Leitura do AHT20 em ponto fixo, sem operações de ponto flutuante.
+ *
+ * O RP2040 não tem FPU: prefira esta estrutura em taxas de amostragem altas.
+ */
+typedef struct {
+    int32_t temperature;      // Temperatura em centésimos de °C (2345 = 23,45 °C)
+    int32_t humidity;         // Umidade relativa em centésimos de % (4567 = 45,67 %)
+    uint32_t raw_temperature; // Código bruto de 20 bits
+    uint32_t raw_humidity;    // Código bruto de 20 bits
+} AHT20_Fixed;
+
+/**
+ * @brief Converte o código bruto de temperatura em centésimos de °C, com arredondamento.
+ *
+ * T = raw * 200 / 2^20 - 50 °C, ou seja, raw * 625 / 2^15 centésimos (cabe em 32 bits).
+ */
+static inline int32_t aht20_temperature_centi(uint32_t raw) {
+    return (int32_t)((raw * 625u + (1u << 14)) >> 15) - 5000;
+}
+
+/**
+ * @brief Converte o código bruto de umidade em centésimos de %, com arredondamento.
+ *
+ * UR = raw * 100 / 2^20 %, ou seja, raw * 625 / 2^16 centésimos (cabe em 32 bits).
+ */
+static inline int32_t aht20_humidity_centi(uint32_t raw) {
+    return (int32_t)((raw * 625u + (1u << 15)) >> 16);
+}
+
+/**
+ * @brief Estados da leitura assíncrona.
+ */
+typedef enum {
+    AHT20_STATE_IDLE,         // Pronto para iniciar uma medição
+    AHT20_STATE_RESETTING,    // Aguardando o reset por software
+    AHT20_STATE_INITIALIZING, // Aguardando a calibração
+    AHT20_STATE_MEASURING,    // Aguardando a conversão
+    AHT20_STATE_ERROR         // Falha na inicialização; chame aht20_begin novamente
+} AHT20_State;
+
+typedef struct AHT20_Async AHT20_Async;
+
+/**
+ * @brief Callback de fim de medição, chamado por aht20_poll (fora de interrupção).
+ *
+ * @param sensor Sensor que concluiu a medição; os dados ficam em sensor->data.
+ * @param ok     false se o sensor não respondeu, continuou ocupado ou o CRC não confere.
+ *               Em sucesso, os dados também ficam em sensor->fixed.
+ */
+typedef void (*AHT20_Callback)(AHT20_Async *sensor, bool ok);
+
+/**
+ * @brief Espera por alarme de hardware de uma máquina de estados assíncrona.
+ */
+typedef struct {
+    volatile alarm_id_t id; // Alarme pendente (0 se nenhum; zerado pelo próprio alarme ao disparar)
+    volatile bool due;      // Sinalizado pelo alarme; tratado no poll
+} AHT20_Timer;
+
+/**
+ * @brief Sensor AHT20 com leitura assíncrona: as esperas são feitas por alarmes de hardware,
+ *        sem bloquear o laço principal.
+ */
+struct AHT20_Async {
+    i2c_inst_t *i2c;
+    AHT20_Data data;         // Última medição válida
+    AHT20_Fixed fixed;       // A mesma medição, em ponto fixo
+    AHT20_Callback callback; // Opcional
+    void *user_data;         // Livre para a aplicação
+    AHT20_State state;
+    AHT20_Timer timer;       // Espera da etapa atual; tratada em aht20_poll
+    uint8_t retries;
+};
+
+typedef struct AHT20_Array AHT20_Array;
+
+/**
+ * @brief Callback de fim de uma rodada de medições, chamado por aht20_array_poll.
+ *
+ * @param array Conjunto que concluiu a rodada.
+ * @param valid Máscara dos sensores com leitura válida nesta rodada (bit i = sensor i).
+ */
+typedef void (*AHT20_Array_Callback)(AHT20_Array *array, uint32_t valid);
+
+/**
+ * @brief Um sensor do conjunto: canal do multiplexador e última leitura.
+ */
+typedef struct {
+    uint8_t mux_addr;  // Endereço do TCA9548A
+    uint8_t channel;   // Canal do multiplexador (0 a 7)
+    AHT20_Data data;   // Última medição válida
+    AHT20_Fixed fixed; // A mesma medição, em ponto fixo
+} AHT20_Array_Sensor;
+
+/**
+ * @brief Conjunto de AHT20 atrás de multiplexadores TCA9548A (todos no endereço 0x38).
+ *
+ * Os sensores são disparados em sequência e convertem em paralelo: uma rodada com N sensores
+ * leva cerca de um tempo de conversão (~80 ms) mais as transferências I2C (~150 µs por
+ * sensor a 400 kHz), em vez de N x 80 ms. Fora das transferências, todos os canais ficam
+ * desabilitados, liberando o barramento para os outros dispositivos.
+ */
+struct AHT20_Array {
+    i2c_inst_t *i2c;
+    AHT20_Array_Sensor sensors[AHT20_ARRAY_MAX];
+    uint8_t count;
+    uint32_t present;              // Sensores que responderam à inicialização
+    uint32_t valid;                // Sensores com leitura válida na última rodada
+    uint32_t pending;              // Sensores aguardando a etapa atual
+    AHT20_Array_Callback callback; // Opcional
+    void *user_data;               // Livre para a aplicação
+    AHT20_State state;
+    AHT20_Timer timer;             // Espera da etapa atual; tratada em aht20_array_poll
+    uint8_t retries;
+    uint8_t selected_mux;          // Multiplexador com canal habilitado (0 se nenhum)
+};
+
+/**
+ * @brief Calcula o CRC-8 do AHT20 (polinômio 0x31, valor inicial 0xFF).
+ *
+ * @param data Bytes recebidos.
+ * @param len Quantidade de bytes.
+ * @return CRC calculado.
+ */
+uint8_t aht20_crc8(const uint8_t *data, size_t len);
+
 /**
  * @brief Inicializa o sensor AHT20.
  * 
@@ -48,6 +195,25 @@ bool aht20_init(i2c_inst_t *i2c);
  */
 bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data);
 
+/**
+ * @brief Lê os dados de temperatura e umidade do sensor AHT20 em ponto fixo.
+ *
+ * Igual a aht20_read, mas a conversão usa apenas multiplicações e deslocamentos inteiros.
+ *
+ * @param i2c Ponteiro para a instância I2C.
+ * @param data Ponteiro para a estrutura onde os dados serão armazenados.
+ * @return true se a leitura for bem-sucedida, false caso contrário.
+ */
+bool aht20_read_fixed(i2c_inst_t *i2c, AHT20_Fixed *data);
+
+/**
+ * @brief Converte uma leitura em ponto fixo para a estrutura em ponto flutuante.
+ *
+ * @param fixed Leitura em ponto fixo.
+ * @param data Ponteiro para a estrutura onde os dados serão armazenados.
+ */
+void aht20_fixed_to_float(const AHT20_Fixed *fixed, AHT20_Data *data);
+
 /**
  * @brief Reseta o sensor AHT20 e inicia ele novamente.
  * 
@@ -65,4 +231,85 @@ bool aht20_reset(i2c_inst_t *i2c);
  */
 bool aht20_check(i2c_inst_t *i2c);
 
+/**
+ * @brief Reseta e inicializa o sensor sem bloquear.
+ *
+ * O reset e a calibração são aguardados por alarmes; acompanhe com aht20_poll até o estado
+ * AHT20_STATE_IDLE (ou AHT20_STATE_ERROR).
+ *
+ * @param sensor Sensor. Deve permanecer válido enquanto estiver em uso (prefira alocação estática).
+ * @param i2c Ponteiro para a instância I2C.
+ * @param callback Chamado ao fim de cada medição, ou NULL para consultar o estado.
+ * @return false se não houver alarme disponível.
+ */
+bool aht20_begin(AHT20_Async *sensor, i2c_inst_t *i2c, AHT20_Callback callback);
+
+/**
+ * @brief Envia o comando de medição e agenda a leitura para depois da conversão (~80 ms).
+ *
+ * @param sensor Sensor inicializado com aht20_begin.
+ * @return false se o sensor não estiver em AHT20_STATE_IDLE ou não responder.
+ */
+bool aht20_start_measurement(AHT20_Async *sensor);
+
+/**
+ * @brief Avança a máquina de estados. Chame no laço principal.
+ *
+ * Quando o alarme da etapa atual já disparou, faz a transferência I2C correspondente (poucas
+ * centenas de µs) e, ao fim de uma medição, chama o callback.
+ *
+ * @param sensor Sensor.
+ * @return true se uma medição terminou nesta chamada com sucesso (dados em sensor->data).
+ */
+bool aht20_poll(AHT20_Async *sensor);
+
+/**
+ * @brief Indica se o sensor está livre para uma nova medição.
+ */
+static inline bool aht20_is_idle(const AHT20_Async *sensor) {
+    return sensor->state == AHT20_STATE_IDLE;
+}
+
+/**
+ * @brief Prepara um conjunto vazio de sensores.
+ *
+ * @param array Conjunto. Deve permanecer válido enquanto estiver em uso (prefira alocação estática).
+ * @param i2c Ponteiro para a instância I2C dos multiplexadores.
+ * @param callback Chamado ao fim de cada rodada, ou NULL para consultar o estado.
+ */
+void aht20_array_init(AHT20_Array *array, i2c_inst_t *i2c, AHT20_Array_Callback callback);
+
+/**
+ * @brief Adiciona um sensor ligado ao canal `channel` do multiplexador `mux_addr`.
+ *
+ * Vários multiplexadores (endereços 0x70 a 0x77) podem ser usados no mesmo conjunto.
+ *
+ * @return Índice do sensor em array->sensors, ou -1 se o conjunto estiver cheio ou o canal for inválido.
+ */
+int aht20_array_add(AHT20_Array *array, uint8_t mux_addr, uint8_t channel);
+
+/**
+ * @brief Reseta e inicializa todos os sensores sem bloquear.
+ *
+ * Acompanhe com aht20_array_poll até o estado AHT20_STATE_IDLE. Sensores que não respondem
+ * ficam fora de array->present e não são medidos.
+ *
+ * @return false se nenhum sensor respondeu ou não houver alarme disponível.
+ */
+bool aht20_array_begin(AHT20_Array *array);
+
+/**
+ * @brief Dispara a medição em todos os sensores presentes e agenda a coleta.
+ *
+ * @return false se o conjunto não estiver em AHT20_STATE_IDLE ou nenhum sensor responder.
+ */
+bool aht20_array_start(AHT20_Array *array);
+
+/**
+ * @brief Avança a máquina de estados do conjunto. Chame no laço principal.
+ *
+ * @return true se uma rodada terminou nesta chamada (leituras válidas em array->valid).
+ */
+bool aht20_array_poll(AHT20_Array *array);
+
 #endif // AHT20_H
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <pico/stdlib.h>
+#include <hardware/structs/systick.h>
+
+#include "aht20.h"
+
+// Mede, em ciclos de CPU, a conversão dos códigos brutos do AHT20 em três versões: double
+// (expressões originais de aht20_read), float e ponto fixo (aht20_temperature_centi /
+// aht20_humidity_centi). Não precisa do sensor conectado.
+
+#define SAMPLES 256
+
+static uint32_t raw_codes[SAMPLES];
+static volatile int32_t sink_i;
+static volatile float sink_f;
+
+// SysTick: contador decrescente de 24 bits no clock do processador
+static inline uint32_t cycles_now(void) {
+    return systick_hw->cvr;
+}
+
+static inline uint32_t cycles_since(uint32_t start) {
+    return (start - systick_hw->cvr) & 0x00FFFFFF;
+}
+
+static uint32_t bench_double(void) {
+    uint32_t start = cycles_now();
+    for (int i = 0; i < SAMPLES; i++) {
+        sink_f = (float)raw_codes[i] * 200.0 / 1048576.0 - 50.0;
+        sink_f = (float)raw_codes[i] * 100.0 / 1048576.0;
+    }
+    return cycles_since(start);
+}
+
+static uint32_t bench_float(void) {
+    uint32_t start = cycles_now();
+    for (int i = 0; i < SAMPLES; i++) {
+        sink_f = (float)raw_codes[i] * (200.0f / 1048576.0f) - 50.0f;
+        sink_f = (float)raw_codes[i] * (100.0f / 1048576.0f);
+    }
+    return cycles_since(start);
+}
+
+static uint32_t bench_fixed(void) {
+    uint32_t start = cycles_now();
+    for (int i = 0; i < SAMPLES; i++) {
+        sink_i = aht20_temperature_centi(raw_codes[i]);
+        sink_i = aht20_humidity_centi(raw_codes[i]);
+    }
+    return cycles_since(start);
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000);
+
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // Habilitado, clock do processador
+
+    for (int i = 0; i < SAMPLES; i++) {
+        raw_codes[i] = (uint32_t)(i * 4099u) & 0xFFFFF;
+    }
+
+    while (true) {
+        uint32_t d = bench_double();
+        uint32_t f = bench_float();
+        uint32_t x = bench_fixed();
+        printf("AHT20 ---- ciclos por leitura (temperatura + umidade): double %lu | float %lu | ponto fixo %lu\n",
+               (unsigned long)(d / SAMPLES), (unsigned long)(f / SAMPLES), (unsigned long)(x / SAMPLES));
+        sleep_ms(1000);
+    }
+}
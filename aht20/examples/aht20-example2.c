@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <pico/stdlib.h>
+#include <hardware/i2c.h>
+
+#include "aht20.h"
+
+#define I2C_PORT i2c1
+#define I2C_SDA 14
+#define I2C_SCL 15
+
+// Chamado por aht20_poll, no laço principal, ao fim de cada medição
+static void on_measurement(AHT20_Async *sensor, bool ok) {
+    if (ok) {
+        printf("AHT20 ---- Temperatura: %.2f C ||| Umidade: %.2f %%\n", sensor->data.temperature, sensor->data.humidity);
+    } else {
+        printf("AHT20 ---- Erro na leitura do AHT20!\n");
+    }
+}
+
+int main() {
+    stdio_init_all();
+
+    // Inicializa o I2C
+    i2c_init(I2C_PORT, 400 * 1000);
+    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA);
+    gpio_pull_up(I2C_SCL);
+
+    // Reset e calibração acontecem em segundo plano
+    static AHT20_Async aht20;
+    aht20_begin(&aht20, I2C_PORT, on_measurement);
+
+    absolute_time_t next_sample = get_absolute_time();
+    uint32_t loops = 0;
+    while (true) {
+        aht20_poll(&aht20);
+
+        if (aht20.state == AHT20_STATE_ERROR) {
+            printf("AHT20 ---- Sensor AHT20 não está ativo!\n");
+            sleep_ms(1000);
+            aht20_begin(&aht20, I2C_PORT, on_measurement);
+        } else if (aht20_is_idle(&aht20) && absolute_time_diff_us(next_sample, get_absolute_time()) >= 0) {
+            aht20_start_measurement(&aht20);
+            next_sample = delayed_by_ms(next_sample, 1000);
+            printf("Laço principal: %lu iterações no último segundo\n", (unsigned long)loops);
+            loops = 0;
+        }
+
+        // Aqui o laço continua livre para display, rede etc. durante a conversão
+        loops++;
+    }
+}
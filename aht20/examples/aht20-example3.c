@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <pico/stdlib.h>
+#include <hardware/i2c.h>
+
+#include "aht20.h"
+
+#define I2C_PORT i2c1
+#define I2C_SDA 14
+#define I2C_SCL 15
+
+#define ZONES 4 // Sensores nos canais 0 a 3 do TCA9548A
+
+// Chamado por aht20_array_poll ao fim de cada rodada
+static void on_round(AHT20_Array *array, uint32_t valid) {
+    for (uint8_t i = 0; i < array->count; i++) {
+        const AHT20_Fixed *t = &array->sensors[i].fixed;
+        if (valid & (1u << i)) {
+            // Ponto fixo impresso sem float: centésimos separados da parte inteira
+            long temp = t->temperature < 0 ? -t->temperature : t->temperature;
+            printf("Zona %u ---- Temperatura: %s%ld.%02ld C ||| Umidade: %ld.%02ld %%\n", i,
+                   t->temperature < 0 ? "-" : "", temp / 100, temp % 100,
+                   (long)(t->humidity / 100), (long)(t->humidity % 100));
+        } else {
+            printf("Zona %u ---- Erro na leitura do AHT20!\n", i);
+        }
+    }
+}
+
+int main() {
+    stdio_init_all();
+
+    // Inicializa o I2C
+    i2c_init(I2C_PORT, 400 * 1000);
+    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA);
+    gpio_pull_up(I2C_SCL);
+
+    // Todos os sensores no endereço 0x38, um por canal do multiplexador
+    static AHT20_Array zones;
+    aht20_array_init(&zones, I2C_PORT, on_round);
+    for (uint8_t ch = 0; ch < ZONES; ch++) {
+        aht20_array_add(&zones, TCA9548A_I2C_ADDR, ch);
+    }
+    aht20_array_begin(&zones);
+
+    absolute_time_t next_round = get_absolute_time();
+    while (true) {
+        aht20_array_poll(&zones);
+
+        if (zones.state == AHT20_STATE_ERROR) {
+            printf("AHT20 ---- Nenhum sensor respondeu!\n");
+            sleep_ms(1000);
+            aht20_array_begin(&zones);
+        } else if (zones.state == AHT20_STATE_IDLE && absolute_time_diff_us(next_round, get_absolute_time()) >= 0) {
+            // Todas as zonas convertem juntas: a rodada leva ~80 ms, qualquer que seja ZONES
+            aht20_array_start(&zones);
+            next_round = delayed_by_ms(next_round, 1000);
+        }
+    }
+}
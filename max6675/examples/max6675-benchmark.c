@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <pico/stdlib.h>
+#include <hardware/structs/systick.h>
+
+#include "max6675.h"
+
+// Mede, em ciclos de CPU, a conversão dos códigos brutos do MAX6675 em °C e °F em três
+// versões: double (expressões originais de max6675_read), float e ponto fixo
+// (max6675_celsius_centi / max6675_fahrenheit_centi). Não precisa do sensor conectado.
+
+#define SAMPLES 256
+
+static uint16_t raw_codes[SAMPLES];
+static volatile int32_t sink_i;
+static volatile float sink_f;
+
+// SysTick: contador decrescente de 24 bits no clock do processador
+static inline uint32_t cycles_now(void) {
+    return systick_hw->cvr;
+}
+
+static inline uint32_t cycles_since(uint32_t start) {
+    return (start - systick_hw->cvr) & 0x00FFFFFF;
+}
+
+static uint32_t bench_double(void) {
+    uint32_t start = cycles_now();
+    for (int i = 0; i < SAMPLES; i++) {
+        float celsius = raw_codes[i] * 0.25;
+        sink_f = celsius;
+        sink_f = (celsius * 9.0 / 5.0) + 32.0;
+    }
+    return cycles_since(start);
+}
+
+static uint32_t bench_float(void) {
+    uint32_t start = cycles_now();
+    for (int i = 0; i < SAMPLES; i++) {
+        float celsius = raw_codes[i] * 0.25f;
+        sink_f = celsius;
+        sink_f = celsius * 1.8f + 32.0f;
+    }
+    return cycles_since(start);
+}
+
+static uint32_t bench_fixed(void) {
+    uint32_t start = cycles_now();
+    for (int i = 0; i < SAMPLES; i++) {
+        sink_i = max6675_celsius_centi(raw_codes[i]);
+        sink_i = max6675_fahrenheit_centi(raw_codes[i]);
+    }
+    return cycles_since(start);
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000);
+
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // Habilitado, clock do processador
+
+    for (int i = 0; i < SAMPLES; i++) {
+        raw_codes[i] = (uint16_t)((i * 37u) & 0x0FFF);
+    }
+
+    while (true) {
+        uint32_t d = bench_double();
+        uint32_t f = bench_float();
+        uint32_t x = bench_fixed();
+        printf("MAX6675 - ciclos por leitura (°C + °F): double %lu | float %lu | ponto fixo %lu\n",
+               (unsigned long)(d / SAMPLES), (unsigned long)(f / SAMPLES), (unsigned long)(x / SAMPLES));
+        sleep_ms(1000);
+    }
+}
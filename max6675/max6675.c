@@ -29,7 +29,7 @@ uint8_t _max6675_read_byte(MAX6675_t max6675) {
     return value;
 }
 
-bool max6675_read(MAX6675_t max6675, MAX6675_Data *data) {
+bool max6675_read_fixed(MAX6675_t max6675, MAX6675_Fixed *data) {
     uint16_t value = 0;
 
     gpio_put(max6675.cs, 0);
@@ -49,7 +49,20 @@ bool max6675_read(MAX6675_t max6675, MAX6675_Data *data) {
     // Os 3 bits menos significativos são status, então deslocamos para a direita
     value >>= 3;
 
-    data->t_celsius = value * 0.25;
-    data->t_fahrenheit = (data->t_celsius * 9.0 / 5.0) + 32.0;
+    data->raw = value;
+    data->t_celsius = max6675_celsius_centi(value);
+    data->t_fahrenheit = max6675_fahrenheit_centi(value);
+    return true;
+}
+
+bool max6675_read(MAX6675_t max6675, MAX6675_Data *data) {
+    MAX6675_Fixed fixed;
+    if (!max6675_read_fixed(max6675, &fixed)) {
+        return false;
+    }
+
+    // Precisão simples basta: os valores são múltiplos exatos de 0,25 °C / 0,45 °F
+    data->t_celsius = (float)fixed.t_celsius * 0.01f;
+    data->t_fahrenheit = (float)fixed.t_fahrenheit * 0.01f;
     return true;
 }
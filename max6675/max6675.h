@@ -29,6 +29,33 @@ typedef struct {
     float t_fahrenheit; // Temperatura em graus Fahrenheit
 } MAX6675_Data;
 
+/**
+ * @brief Estrutura para armazenar os dados lidos do sensor MAX6675 em ponto fixo.
+ *
+ * O RP2040 não tem FPU: prefira esta estrutura em taxas de amostragem altas.
+ */
+typedef struct {
+    int32_t t_celsius;    // Temperatura em centésimos de °C (2525 = 25,25 °C)
+    int32_t t_fahrenheit; // Temperatura em centésimos de °F
+    uint16_t raw;         // Código bruto de 12 bits, em passos de 0,25 °C
+} MAX6675_Fixed;
+
+/**
+ * @brief Converte o código bruto em centésimos de °C (passos de 0,25 °C, conversão exata).
+ */
+static inline int32_t max6675_celsius_centi(uint16_t raw) {
+    return (int32_t)raw * 25;
+}
+
+/**
+ * @brief Converte o código bruto em centésimos de °F (conversão exata).
+ *
+ * F = C * 9 / 5 + 32, com C = raw * 0,25: em centésimos, raw * 45 + 3200, sem divisão.
+ */
+static inline int32_t max6675_fahrenheit_centi(uint16_t raw) {
+    return (int32_t)raw * 45 + 3200;
+}
+
 /**
  * @brief Inicializa o sensor MAX6675.
  * 
@@ -50,6 +77,16 @@ MAX6675_t max6675_init(uint8_t sckl, int8_t cs, int8_t miso);
  */
 bool max6675_read(MAX6675_t max6675, MAX6675_Data *data);
 
+/**
+ * @brief Lê a temperatura do sensor MAX6675 em ponto fixo, sem operações de ponto flutuante.
+ * 
+ * @param max6675 Estrutura do sensor MAX6675.
+ * @param data Ponteiro para a estrutura onde os dados serão armazenados.
+ * 
+ * @return true se a leitura for bem-sucedida, false caso contrário.
+ */
+bool max6675_read_fixed(MAX6675_t max6675, MAX6675_Fixed *data);
+
 /**
  * @brief Função interna para ler um byte do sensor MAX6675.
  * 
@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "pico/stdlib.h"     // Biblioteca da Raspberry Pi Pico para funções padrão (GPIO, temporização, etc.)
+#include "pico/cyw43_arch.h" // Biblioteca para arquitetura Wi-Fi da Pico com CYW43
+
+#include "mqtt_pico.h"
+
+// WIFI credentials
+#include "credentials.h"
+
+#define DEVICE_NAME     "pico"
+#define KEEP_ALIVE      60
+#define PUB_QOS         1
+#define SUB_QOS         1
+#define PUB_PERIOD_MS   1000
+#define SEND_TIMEOUT_MS 100
+
+#define NET_PRIORITY    (tskIDLE_PRIORITY + 3)
+#define APP_PRIORITY    (tskIDLE_PRIORITY + 2)
+
+/**
+ * Exemplo da variante FreeRTOS: uma tarefa de rede dona do CYW43, do lwIP e do cliente MQTT,
+ * uma tarefa que publica pela fila de comandos e outra que recebe mensagens por uma fila,
+ * acordada por notificação de tarefa.
+ */
+
+static mqtt_config_t mqtt;
+static mqtt_rtos_t rtos;
+static mqtt_topic_t counter_topic;
+static const char *cmd_filter;
+
+/**
+ * Inicialização da rede, executada na tarefa de rede após cyw43_arch_init.
+ */
+static void net_setup(mqtt_config_t *mqtt, void *arg) {
+    cyw43_arch_enable_sta_mode();
+    while (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK, 5000)) {
+        printf("[WIFI] nova tentativa\n");
+    }
+    printf("[WIFI] conectado\n");
+    mqtt_start_client(mqtt, MQTT_SERVER, NULL, NULL, NULL, NULL);
+}
+
+/**
+ * Publica um contador a cada PUB_PERIOD_MS.
+ */
+static void publisher_task(void *arg) {
+    TickType_t last = xTaskGetTickCount();
+    uint32_t counter = 0;
+
+    for (;;) {
+        uint8_t msg[16];
+        mqtt_encoder_t enc;
+        mqtt_enc_init(&enc, MQTT_ENC_JSON, msg, sizeof(msg));
+        mqtt_enc_int(&enc, (int32_t)counter++);
+        uint16_t len = mqtt_enc_finish(&enc);
+        if (len && mqtt_rtos_publish(&rtos, counter_topic, msg, len, pdMS_TO_TICKS(SEND_TIMEOUT_MS)) != ERR_OK) {
+            printf("[APP] fila de comandos cheia\n");
+        }
+        vTaskDelayUntil(&last, pdMS_TO_TICKS(PUB_PERIOD_MS));
+    }
+}
+
+/**
+ * Inscreve-se em "cmd/#" e imprime as mensagens recebidas; dorme até ser notificada.
+ */
+static void subscriber_task(void *arg) {
+    static mqtt_rtos_sub_t sub;
+    static mqtt_rtos_msg_t msg;
+
+    // a inscrição falha enquanto o cliente não estiver conectado
+    while (mqtt_rtos_subscribe(&rtos, &sub, cmd_filter, 4, pdMS_TO_TICKS(5000)) != ERR_OK) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    printf("[APP] inscrito\n");
+
+    for (;;) {
+        xTaskNotifyWait(0, MQTT_RTOS_NOTIFY_RX, NULL, portMAX_DELAY);
+        while (mqtt_rtos_receive(&sub, &msg, 0)) {
+            printf("[APP] %s: %s\n", msg.topic, (const char *)msg.data);
+        }
+    }
+}
+
+static void main_task(void *arg) {
+    if (!mqtt_rtos_start(&rtos, &mqtt, net_setup, NULL, NET_PRIORITY)) {
+        panic("[CYW43] falha na inicialização da tarefa de rede");
+    }
+    xTaskCreate(publisher_task, "pub", 1024, NULL, APP_PRIORITY, NULL);
+    xTaskCreate(subscriber_task, "sub", 1024, NULL, APP_PRIORITY, NULL);
+    vTaskDelete(NULL);
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(5000); // espera para que seja possível debugar via monitor serial
+
+    mqtt_config_init(&mqtt);
+    mqtt.client_info.client_id = mqtt_generate_client_id(DEVICE_NAME);
+    if (!mqtt.client_info.client_id) {
+        mqtt.client_info.client_id = DEVICE_NAME;
+    }
+    mqtt.client_info.client_user = MQTT_USERNAME;
+    mqtt.client_info.client_pass = MQTT_PASSWORD;
+    mqtt.client_info.keep_alive = KEEP_ALIVE;
+    mqtt.sub_qos = SUB_QOS;
+    mqtt.pub_qos = PUB_QOS;
+    mqtt.unique_topic = true;
+    mqtt_tls(&mqtt);
+    mqtt_queue_config(&mqtt, true, NULL, NULL);
+
+    // tópicos de publicação registrados antes de entregar o cliente à tarefa de rede
+    counter_topic = mqtt_topic_register(&mqtt, "counter");
+    cmd_filter = mqtt_full_topic(&mqtt, "cmd/#");
+
+    xTaskCreate(main_task, "main", 1024, NULL, APP_PRIORITY, NULL);
+    vTaskStartScheduler();
+    return 0;
+}
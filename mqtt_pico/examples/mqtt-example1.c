@@ -41,7 +41,7 @@ void dns_found(const char *hostname, const ip_addr_t *ipaddr, void *arg) {
 
 void pub_cb(__unused void *arg, err_t err) {
     if (err != 0) {
-        return;
+        printf("[MQTT PUB] ERRO NA PUBLICACAO: %d\n", err);
     }
 }
 
@@ -53,45 +53,33 @@ void sub_cb(void *arg, err_t err) {
     mqtt->sub_count++;
 }
 
-void in_data_cb(void *arg, const u8_t *data, u16_t len, u8_t flags) {
-    mqtt_config_t *mqtt = (mqtt_config_t *)arg;
-
-    strncpy(mqtt->data.data, (const char *)data, len);
-    mqtt->data.len = (uint32_t) len;
-    mqtt->data.data[len] = '\0';
-
-    printf("Topico: %s\n", mqtt->data.topic);
-    printf("Mensagem: %s\n", mqtt->data.data);
-}
-
-void in_pub_cb(void *arg, const char *topic, u32_t tot_len) {
-    mqtt_config_t *mqtt = (mqtt_config_t *)arg;
-    
-    size_t len = strlen(topic);
-    if (len >= sizeof(mqtt->data.topic)) { // verifica para nao passar do tamanho do buffer topic
-        len = sizeof(mqtt->data.topic) - 1;
+void payload_cb(mqtt_config_t *mqtt, const mqtt_payload_t *payload, void *arg) {
+    if (payload->offset == 0 && payload->last) {
+        printf("Topico: %s\n", payload->topic);
+        printf("Mensagem: %s\n", (const char *)payload->data);
+    } else {
+        // Mensagem maior que a arena: chega em fragmentos
+        printf("Topico: %s [%lu/%lu bytes]\n", payload->topic,
+               (unsigned long)(payload->offset + payload->len), (unsigned long)payload->tot_len);
     }
-
-    memcpy(mqtt->data.topic, topic, len);
-    mqtt->data.topic[len] = '\0';
 }
 
 void conn_cb(mqtt_client_t *client, void *arg, mqtt_connection_status_t status) {
     mqtt_config_t *mqtt = (mqtt_config_t *) arg;
 
+    // a biblioteca reinscreve os tópicos e reconecta sozinha; aqui apenas informamos o estado
     if (status == MQTT_CONNECT_ACCEPTED) {
-        mqtt->connect_done = true;
-        char *topics[] = {
-            mqtt_full_topic(mqtt, "test-sub")
-        };
-        size_t num_topics = sizeof(topics)/sizeof(topics[0]);
-        mqtt_manage_topics(mqtt, topics, num_topics, MQTT_SUBSCRIBE, sub_cb);
-
-        printf("[MQTT CONN] MQTT CONNECTED\n");
+        printf("[MQTT CONN] MQTT CONNECTED (reconexoes: %lu)\n", (unsigned long)mqtt->conn.reconnects);
+        #if LWIP_ALTCP && LWIP_ALTCP_TLS
+            // compara o custo do handshake completo com o da sessão retomada
+            mqtt_tls_stats_t *tls = &mqtt->tls.stats;
+            printf("[MQTT TLS] ultima conexao: %lu ms, heap %u B (pico %u B) | completo: %lu x, %lu ms, pico %u B | retomado: %lu x, %lu ms, pico %u B\n",
+                   (unsigned long)tls->last_ms, (unsigned)tls->heap_used, (unsigned)tls->heap_peak,
+                   (unsigned long)tls->full, (unsigned long)tls->full_ms, (unsigned)tls->full_heap_peak,
+                   (unsigned long)tls->resumed, (unsigned long)tls->resumed_ms, (unsigned)tls->resumed_heap_peak);
+        #endif
     } else if (status == MQTT_CONNECT_DISCONNECTED) {
-        if (!mqtt->connect_done) {
-            printf("[MQTT CONN] MQTT DISCONNECTED\n");
-        }
+        printf("[MQTT CONN] MQTT DISCONNECTED, nova tentativa em ~%lu ms\n", (unsigned long)mqtt->conn.backoff_ms);
     } else {
         printf("[MQTT CONN] BAD STATUS: %d\n", status);
     }
@@ -127,8 +115,9 @@ int main() {
     }
     printf("\nWiFi conectado com sucesso!\n");
 
-    // struct para MQTT
-    mqtt_config_t mqtt;
+    // struct para MQTT (estática, pois contém a arena de recepção)
+    static mqtt_config_t mqtt;
+    mqtt_config_init(&mqtt);
     mqtt.client_info.client_id = mqtt_generate_client_id(DEVICE_NAME);
     if (!mqtt.client_info.client_id) {
         // se ocorrer erro ao criar o client_id único, utiliza o DEVICE_NAME
@@ -150,23 +139,54 @@ int main() {
     mqtt.unique_topic = UNIQUE_TOPIC;
 
     mqtt_tls(&mqtt); // configura o certificado TLS, se definido.
+    mqtt.tls.resume = true; // false para medir todas as conexões com handshake completo
+
+    // publicações passam pela fila; o último valor de cada tópico substitui o pendente
+    mqtt_queue_config(&mqtt, true, pub_cb, &mqtt);
+
+    // payloads são montados na arena e entregues completos
+    mqtt_set_payload_handler(&mqtt, MQTT_PAYLOAD_ASSEMBLE, payload_cb, NULL);
+
+    // tópicos registrados uma vez; são inscritos a cada conexão aceita
+    char *topics[] = {
+        mqtt_full_topic(&mqtt, "test-sub")
+    };
+    size_t num_topics = sizeof(topics)/sizeof(topics[0]);
+    mqtt_manage_topics(&mqtt, topics, num_topics, MQTT_SUBSCRIBE, sub_cb);
+
+    // tópico de publicação montado uma única vez; o laço usa apenas o handle
+    mqtt_topic_t pub_topic = mqtt_topic_register(&mqtt, "test-pub");
+
+    // snapshot binário de latências, reconexões e memória a cada 5 minutos em "sys/metrics"
+    mqtt_metrics_start(&mqtt, NULL, 5 * 60 * 1000);
+
+    // publicações e keep alive concentrados em janelas a cada 30 s; entre elas, o rádio fica
+    // em economia e as mensagens do broker continuam chegando (com atraso de um DTIM)
+    static mqtt_power_t power;
+    mqtt_power_start(&power, &mqtt, 30 * 1000, 2000);
 
-    mqtt_start_client(&mqtt, MQTT_SERVER, conn_cb, in_pub_cb, in_data_cb, dns_found);
+    mqtt_start_client(&mqtt, MQTT_SERVER, conn_cb, NULL, NULL, dns_found);
 
     while(true){
         if (mqtt.connect_done) {
-            char msg[] = "im alive";
-            mqtt_publish(
-                mqtt.client,
-                mqtt_full_topic(&mqtt, "test-pub"),
-                msg,
-                strlen(msg),
-                mqtt.pub_qos,
-                mqtt.retain,
-                pub_cb,
-                &mqtt
-            );
-            printf("Mensagem publicada\n");
+            // payload montado direto no buffer, sem printf: {"alive":true,"uptime":123.4}
+            uint8_t msg[32];
+            mqtt_encoder_t enc;
+            mqtt_enc_init(&enc, MQTT_ENC_JSON, msg, sizeof(msg));
+            mqtt_enc_map_begin(&enc, 2);
+            mqtt_enc_key(&enc, "alive");
+            mqtt_enc_bool(&enc, true);
+            mqtt_enc_key(&enc, "uptime");
+            mqtt_enc_fixed(&enc, to_ms_since_boot(get_absolute_time()) / 100, 1);
+            mqtt_enc_map_end(&enc);
+            uint16_t len = mqtt_enc_finish(&enc);
+
+            // a fila guarda a mensagem até a próxima janela; a mais recente substitui a pendente
+            if (len) {
+                mqtt_queue_publish_topic(&mqtt, pub_topic, msg, len);
+                printf("Mensagem enfileirada (radio ativo: %lu ms/h)\n",
+                       (unsigned long)mqtt_power_radio_on_per_hour(&power));
+            }
         }
         cyw43_arch_poll();
         cyw43_arch_wait_for_work_until(make_timeout_time_ms(10000));
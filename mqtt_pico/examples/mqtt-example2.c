@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "pico/stdlib.h"     // Biblioteca da Raspberry Pi Pico para funções padrão (GPIO, temporização, etc.)
+#include "pico/cyw43_arch.h" // Biblioteca para arquitetura Wi-Fi da Pico com CYW43
+
+#include "mqtt_pico.h"
+
+// WIFI credentials
+#include "credentials.h"
+
+#define DEVICE_NAME     "pico"
+#define KEEP_ALIVE      60
+#define PUB_QOS         1
+#define SUB_QOS         1
+#define CONTROL_PERIOD_US 1000 // laço de controle de 1 kHz no núcleo 0
+
+/**
+ * Exemplo do modo de dois núcleos: Wi-Fi, lwIP, TLS e MQTT rodam no núcleo 1, e o
+ * núcleo 0 executa um laço de controle com período fixo, publicando e recebendo
+ * mensagens apenas pelos anéis de `mqtt_dual_t`, sem travas.
+ */
+
+/**
+ * Inicialização da rede, executada no núcleo 1 após cyw43_arch_init.
+ */
+static void net_setup(mqtt_config_t *mqtt, void *arg) {
+    cyw43_arch_enable_sta_mode();
+    while (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK, 5000)) {
+        printf("[WIFI] nova tentativa\n");
+    }
+    printf("[WIFI] conectado (núcleo %u)\n", get_core_num());
+    mqtt_start_client(mqtt, MQTT_SERVER, NULL, NULL, NULL, NULL);
+}
+
+/**
+ * Handler da rota de setpoint: chamado no núcleo 0, dentro de mqtt_dual_poll.
+ */
+static void setpoint_cb(mqtt_config_t *mqtt, const mqtt_payload_t *payload, void *arg) {
+    int32_t *setpoint = (int32_t *)arg;
+    if (payload->offset == 0 && payload->last) {
+        *setpoint = atoi((const char *)payload->data);
+    }
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(5000); // espera para que seja possível debugar via monitor serial
+
+    static mqtt_config_t mqtt;
+    mqtt_config_init(&mqtt);
+    mqtt.client_info.client_id = mqtt_generate_client_id(DEVICE_NAME);
+    if (!mqtt.client_info.client_id) {
+        mqtt.client_info.client_id = DEVICE_NAME;
+    }
+    mqtt.client_info.client_user = MQTT_USERNAME;
+    mqtt.client_info.client_pass = MQTT_PASSWORD;
+    mqtt.client_info.keep_alive = KEEP_ALIVE;
+    mqtt.sub_qos = SUB_QOS;
+    mqtt.pub_qos = PUB_QOS;
+    mqtt.unique_topic = true;
+    mqtt_tls(&mqtt);
+    mqtt_queue_config(&mqtt, true, NULL, NULL);
+
+    // tópicos e rotas registrados antes de entregar o cliente ao núcleo 1
+    static int32_t setpoint = 0;
+    mqtt_topic_t out_topic = mqtt_topic_register(&mqtt, "control/output");
+    mqtt_route_t routes[] = {
+        { mqtt_full_topic(&mqtt, "control/setpoint"), setpoint_cb, &setpoint }
+    };
+    mqtt_manage_routes(&mqtt, routes, 1, MQTT_SUBSCRIBE, NULL);
+
+    static mqtt_dual_t dual;
+    if (!mqtt_dual_start(&dual, &mqtt, net_setup, NULL)) {
+        panic("[CYW43] falha na inicialização no núcleo 1");
+    }
+
+    int32_t output = 0;
+    uint32_t ticks = 0;
+    absolute_time_t next = get_absolute_time();
+    while (true) {
+        mqtt_dual_poll(&dual);
+
+        // controle proporcional simples: o período não depende do tráfego de rede
+        output += (setpoint - output) / 8;
+
+        // publica a saída a cada segundo
+        if (++ticks % 1000 == 0) {
+            uint8_t msg[16];
+            mqtt_encoder_t enc;
+            mqtt_enc_init(&enc, MQTT_ENC_JSON, msg, sizeof(msg));
+            mqtt_enc_int(&enc, output);
+            uint16_t len = mqtt_enc_finish(&enc);
+            if (len) {
+                mqtt_dual_publish(&dual, out_topic, msg, len);
+            }
+        }
+
+        next = delayed_by_us(next, CONTROL_PERIOD_US);
+        busy_wait_until(next);
+    }
+}
@@ -0,0 +1,431 @@
+/**
+ * @file fake_broker.c
+ *
+ * @brief Broker MQTT mínimo para os testes de `mqtt_pico` no Linux (ver fake_broker.h).
+ */
+#include <string.h>
+
+#include "lwip/tcp.h"
+
+#include "fake_broker.h"
+
+typedef struct {
+    struct tcp_pcb *pcb;
+    uint8_t rx[FAKE_BROKER_RX_SIZE];
+    uint16_t rx_len;
+    uint8_t tx[FAKE_BROKER_TX_SIZE];
+    uint16_t tx_len;
+    char subs[FAKE_BROKER_MAX_SUBS][FAKE_BROKER_FILTER_LEN];
+    uint8_t sub_qos[FAKE_BROKER_MAX_SUBS];
+    uint16_t next_id;
+} broker_conn_t;
+
+static broker_conn_t broker_conns[FAKE_BROKER_MAX_CONNS];
+static fake_broker_stats_t broker_stats;
+
+/**
+ * @brief Envia o máximo possível do buffer de saída para o TCP.
+ */
+static void broker_flush(broker_conn_t *conn) {
+    uint16_t sent = 0;
+
+    while (sent < conn->tx_len) {
+        uint16_t len = conn->tx_len - sent;
+        if (len > tcp_sndbuf(conn->pcb)) {
+            len = tcp_sndbuf(conn->pcb);
+        }
+        if (len == 0 || tcp_write(conn->pcb, &conn->tx[sent], len, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+            break;
+        }
+        sent += len;
+    }
+    if (sent) {
+        memmove(conn->tx, &conn->tx[sent], conn->tx_len - sent);
+        conn->tx_len -= sent;
+        tcp_output(conn->pcb);
+    }
+}
+
+/**
+ * @brief Acrescenta um pacote (cabeçalho + corpo) ao buffer de saída.
+ */
+static bool broker_send(broker_conn_t *conn, uint8_t type, const uint8_t *body, uint32_t len) {
+    uint8_t head[5];
+    uint8_t head_len = 1;
+
+    head[0] = type;
+    uint32_t remaining = len;
+    do {
+        head[head_len] = remaining % 128;
+        remaining /= 128;
+        if (remaining) {
+            head[head_len] |= 0x80;
+        }
+        head_len++;
+    } while (remaining);
+
+    if (conn->tx_len + head_len + len > FAKE_BROKER_TX_SIZE) {
+        broker_stats.dropped++;
+        return false;
+    }
+    memcpy(&conn->tx[conn->tx_len], head, head_len);
+    if (len) {
+        memcpy(&conn->tx[conn->tx_len + head_len], body, len);
+    }
+    conn->tx_len += head_len + len;
+    return true;
+}
+
+static void broker_send_id(broker_conn_t *conn, uint8_t type, uint16_t id) {
+    uint8_t body[2] = {id >> 8, id & 0xFF};
+    broker_send(conn, type, body, 2);
+}
+
+/**
+ * @brief Verifica se um tópico casa com um filtro (`+` e `#`).
+ */
+static bool broker_match(const char *filter, const char *topic, uint16_t topic_len) {
+    uint16_t t = 0;
+
+    if (topic_len && topic[0] == '$' && (filter[0] == '+' || filter[0] == '#')) {
+        return false;
+    }
+    while (*filter) {
+        if (filter[0] == '#') {
+            return true;
+        }
+        if (filter[0] == '+') {
+            while (t < topic_len && topic[t] != '/') {
+                t++;
+            }
+            filter++;
+        } else {
+            while (*filter && *filter != '/') {
+                if (t >= topic_len || topic[t] != *filter) {
+                    return false;
+                }
+                filter++;
+                t++;
+            }
+            if (t < topic_len && topic[t] != '/') {
+                return false;
+            }
+        }
+        if (*filter == '/') {
+            if (t >= topic_len) {
+                return strcmp(filter, "/#") == 0; // "a/#" também casa com "a"
+            }
+            filter++;
+            t++;
+        }
+    }
+    return t == topic_len;
+}
+
+/**
+ * @brief Entrega uma publicação a todos os inscritos cujos filtros casam com o tópico.
+ */
+static void broker_forward(const char *topic, uint16_t topic_len, const uint8_t *payload, uint32_t len, uint8_t qos) {
+    static uint8_t body[FAKE_BROKER_RX_SIZE + 4];
+
+    for (int c = 0; c < FAKE_BROKER_MAX_CONNS; c++) {
+        broker_conn_t *conn = &broker_conns[c];
+        if (!conn->pcb) {
+            continue;
+        }
+        for (int s = 0; s < FAKE_BROKER_MAX_SUBS; s++) {
+            if (!conn->subs[s][0] || !broker_match(conn->subs[s], topic, topic_len)) {
+                continue;
+            }
+            uint8_t out_qos = qos < conn->sub_qos[s] ? qos : conn->sub_qos[s];
+            uint32_t n = 0;
+            body[n++] = topic_len >> 8;
+            body[n++] = topic_len & 0xFF;
+            memcpy(&body[n], topic, topic_len);
+            n += topic_len;
+            if (out_qos) {
+                if (++conn->next_id == 0) {
+                    conn->next_id = 1;
+                }
+                body[n++] = conn->next_id >> 8;
+                body[n++] = conn->next_id & 0xFF;
+            }
+            memcpy(&body[n], payload, len);
+            n += len;
+            if (broker_send(conn, 0x30 | (out_qos << 1), body, n)) {
+                broker_stats.forwarded++;
+            }
+            broker_flush(conn);
+            break; // uma entrega por conexão, mesmo que vários filtros casem
+        }
+    }
+}
+
+static void broker_subscribe(broker_conn_t *conn, const uint8_t *body, uint32_t len, bool subscribe) {
+    uint8_t ack[2 + FAKE_BROKER_MAX_SUBS];
+    uint8_t ack_len = 2;
+    uint32_t pos = 2;
+
+    memcpy(ack, body, 2);
+    while (pos + 2 <= len) {
+        uint16_t filter_len = (body[pos] << 8) | body[pos + 1];
+        pos += 2;
+        if (pos + filter_len + (subscribe ? 1 : 0) > len) {
+            break;
+        }
+        char filter[FAKE_BROKER_FILTER_LEN];
+        bool fits = filter_len < FAKE_BROKER_FILTER_LEN;
+        if (fits) {
+            memcpy(filter, &body[pos], filter_len);
+            filter[filter_len] = '\0';
+        }
+        pos += filter_len;
+
+        uint8_t qos = 0;
+        if (subscribe) {
+            qos = body[pos++] & 0x03;
+        }
+
+        int slot = -1;
+        for (int s = 0; fits && s < FAKE_BROKER_MAX_SUBS; s++) {
+            if (strcmp(conn->subs[s], filter) == 0) {
+                slot = s;
+                break;
+            }
+            if (slot < 0 && !conn->subs[s][0]) {
+                slot = s;
+            }
+        }
+        if (subscribe) {
+            if (slot >= 0) {
+                strcpy(conn->subs[slot], filter);
+                conn->sub_qos[slot] = qos > 2 ? 2 : qos;
+            }
+            if (ack_len < sizeof(ack)) {
+                ack[ack_len++] = slot >= 0 ? conn->sub_qos[slot] : 0x80;
+            }
+        } else if (slot >= 0 && strcmp(conn->subs[slot], filter) == 0) {
+            conn->subs[slot][0] = '\0';
+        }
+    }
+
+    if (subscribe) {
+        broker_send(conn, 0x90, ack, ack_len);
+    } else {
+        broker_send(conn, 0xB0, ack, 2);
+    }
+}
+
+/**
+ * @brief Trata um pacote completo recebido de um cliente.
+ *
+ * @return false se a conexão deve ser encerrada.
+ */
+static bool broker_packet(broker_conn_t *conn, uint8_t head, const uint8_t *body, uint32_t len) {
+    uint8_t type = head >> 4;
+
+    switch (type) {
+        case 1: { // CONNECT
+            static const uint8_t connack[2] = {0x00, 0x00};
+            broker_stats.connects++;
+            broker_send(conn, 0x20, connack, 2);
+            return true;
+        }
+        case 3: { // PUBLISH
+            uint8_t qos = (head >> 1) & 0x03;
+            if (len < 2) {
+                return false;
+            }
+            uint16_t topic_len = (body[0] << 8) | body[1];
+            uint32_t pos = 2 + topic_len;
+            if (pos + (qos ? 2 : 0) > len) {
+                return false;
+            }
+            uint16_t id = 0;
+            if (qos) {
+                id = (body[pos] << 8) | body[pos + 1];
+                pos += 2;
+            }
+            broker_stats.publishes++;
+            if (qos == 1) {
+                broker_send_id(conn, 0x40, id); // PUBACK
+            } else if (qos == 2) {
+                broker_send_id(conn, 0x50, id); // PUBREC
+            }
+            broker_forward((const char *)&body[2], topic_len, &body[pos], len - pos, qos);
+            return true;
+        }
+        case 5: // PUBREC de uma entrega QoS 2
+            if (len >= 2) {
+                broker_send_id(conn, 0x62, (body[0] << 8) | body[1]); // PUBREL
+            }
+            return true;
+        case 6: // PUBREL de uma publicação QoS 2
+            if (len >= 2) {
+                broker_send_id(conn, 0x70, (body[0] << 8) | body[1]); // PUBCOMP
+            }
+            return true;
+        case 4: // PUBACK
+        case 7: // PUBCOMP
+            return true;
+        case 8: // SUBSCRIBE
+        case 10: // UNSUBSCRIBE
+            if (len < 2) {
+                return false;
+            }
+            broker_subscribe(conn, body, len, type == 8);
+            return true;
+        case 12: // PINGREQ
+            broker_send(conn, 0xD0, NULL, 0);
+            return true;
+        default: // DISCONNECT ou pacote inválido
+            return false;
+    }
+}
+
+/**
+ * @brief Encerra a conexão.
+ *
+ * @return ERR_ABRT se o pcb precisou ser abortado (deve ser repassado ao lwIP pelo callback).
+ */
+static err_t broker_close(broker_conn_t *conn) {
+    struct tcp_pcb *pcb = conn->pcb;
+    err_t err = ERR_OK;
+
+    memset(conn, 0, sizeof(*conn));
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_err(pcb, NULL);
+    if (tcp_close(pcb) != ERR_OK) {
+        tcp_abort(pcb);
+        err = ERR_ABRT;
+    }
+    return err;
+}
+
+/**
+ * @brief Extrai e trata os pacotes completos do buffer de entrada.
+ */
+static bool broker_parse(broker_conn_t *conn) {
+    uint16_t pos = 0;
+
+    while (conn->rx_len - pos >= 2) {
+        uint32_t len = 0;
+        uint32_t shift = 0;
+        uint16_t i = pos + 1;
+        bool complete = false;
+        while (i < conn->rx_len && i - pos <= 4) {
+            len |= (uint32_t)(conn->rx[i] & 0x7F) << shift;
+            shift += 7;
+            if (!(conn->rx[i++] & 0x80)) {
+                complete = true;
+                break;
+            }
+        }
+        if (!complete) {
+            if (i - pos > 4) {
+                return false; // tamanho restante inválido
+            }
+            break;
+        }
+        if ((i - pos) + len > FAKE_BROKER_RX_SIZE) {
+            return false; // pacote maior que o buffer
+        }
+        if (i + len > conn->rx_len) {
+            break;
+        }
+        if (!broker_packet(conn, conn->rx[pos], &conn->rx[i], len)) {
+            return false;
+        }
+        pos = i + len;
+    }
+
+    memmove(conn->rx, &conn->rx[pos], conn->rx_len - pos);
+    conn->rx_len -= pos;
+    return true;
+}
+
+static err_t broker_recv_cb(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+    broker_conn_t *conn = (broker_conn_t *)arg;
+
+    if (!p) {
+        return broker_close(conn);
+    }
+
+    uint16_t offset = 0;
+    while (offset < p->tot_len) {
+        uint16_t len = p->tot_len - offset;
+        if (len > FAKE_BROKER_RX_SIZE - conn->rx_len) {
+            len = FAKE_BROKER_RX_SIZE - conn->rx_len;
+        }
+        pbuf_copy_partial(p, &conn->rx[conn->rx_len], len, offset);
+        conn->rx_len += len;
+        offset += len;
+        if (!broker_parse(conn)) {
+            tcp_recved(pcb, p->tot_len);
+            pbuf_free(p);
+            return broker_close(conn);
+        }
+    }
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+    broker_flush(conn);
+    return ERR_OK;
+}
+
+static err_t broker_sent_cb(void *arg, struct tcp_pcb *pcb, u16_t len) {
+    broker_flush((broker_conn_t *)arg);
+    return ERR_OK;
+}
+
+static void broker_err_cb(void *arg, err_t err) {
+    broker_conn_t *conn = (broker_conn_t *)arg;
+    if (conn) {
+        memset(conn, 0, sizeof(*conn)); // o pcb já foi liberado pelo lwIP
+    }
+}
+
+static err_t broker_accept_cb(void *arg, struct tcp_pcb *pcb, err_t err) {
+    if (err != ERR_OK || !pcb) {
+        return ERR_VAL;
+    }
+    for (int c = 0; c < FAKE_BROKER_MAX_CONNS; c++) {
+        broker_conn_t *conn = &broker_conns[c];
+        if (conn->pcb) {
+            continue;
+        }
+        memset(conn, 0, sizeof(*conn));
+        conn->pcb = pcb;
+        tcp_arg(pcb, conn);
+        tcp_recv(pcb, broker_recv_cb);
+        tcp_sent(pcb, broker_sent_cb);
+        tcp_err(pcb, broker_err_cb);
+        tcp_nagle_disable(pcb);
+        return ERR_OK;
+    }
+    tcp_abort(pcb);
+    return ERR_ABRT;
+}
+
+bool fake_broker_start(uint16_t port) {
+    struct tcp_pcb *pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+    if (!pcb) {
+        return false;
+    }
+    if (tcp_bind(pcb, IP_ANY_TYPE, port) != ERR_OK) {
+        tcp_close(pcb);
+        return false;
+    }
+    struct tcp_pcb *listen = tcp_listen(pcb);
+    if (!listen) {
+        tcp_close(pcb);
+        return false;
+    }
+    tcp_accept(listen, broker_accept_cb);
+    return true;
+}
+
+const fake_broker_stats_t *fake_broker_stats(void) {
+    return &broker_stats;
+}
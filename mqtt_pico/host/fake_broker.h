@@ -0,0 +1,46 @@
+/**
+ * @file fake_broker.h
+ *
+ * @brief Broker MQTT 3.1.1 mínimo sobre a API raw TCP do lwIP, para testes e benchmarks
+ *      de `mqtt_pico` no Linux sem depender de um broker externo.
+ *
+ *      Suporta CONNECT, SUBSCRIBE/UNSUBSCRIBE (com curingas `+` e `#`), PUBLISH com
+ *      QoS 0, 1 e 2 (incluindo o encaminhamento aos inscritos) e PINGREQ. Não guarda
+ *      sessões, mensagens retidas nem mensagens de "last will".
+ */
+#ifndef FAKE_BROKER_H
+#define FAKE_BROKER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FAKE_BROKER_MAX_CONNS 4     // Conexões simultâneas
+#define FAKE_BROKER_MAX_SUBS 8      // Filtros por conexão
+#define FAKE_BROKER_FILTER_LEN 64   // Tamanho máximo de um filtro
+#define FAKE_BROKER_RX_SIZE 4096    // Maior pacote aceito
+#define FAKE_BROKER_TX_SIZE 8192    // Buffer de saída por conexão
+
+/**
+ * @brief Contadores do broker.
+ */
+typedef struct {
+    uint32_t connects;      // CONNECTs aceitos
+    uint32_t publishes;     // PUBLISHs recebidos
+    uint32_t forwarded;     // PUBLISHs entregues a inscritos
+    uint32_t dropped;       // Pacotes descartados por falta de espaço no buffer de saída
+} fake_broker_stats_t;
+
+/**
+ * @brief Inicia o broker escutando em todas as interfaces do lwIP.
+ *
+ * @param port Porta TCP (normalmente 1883).
+ * @return true se o broker foi iniciado.
+ */
+bool fake_broker_start(uint16_t port);
+
+/**
+ * @brief Retorna os contadores do broker.
+ */
+const fake_broker_stats_t *fake_broker_stats(void);
+
+#endif // FAKE_BROKER_H
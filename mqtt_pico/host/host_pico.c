@@ -0,0 +1,135 @@
+/**
+ * @file host_pico.c
+ *
+ * @brief Implementação, para o Linux, das funções do Pico SDK usadas por `mqtt_pico`.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "pico/unique_id.h"
+#include "pico/rand.h"
+
+#include "lwip/init.h"
+#include "lwip/netif.h"
+#include "lwip/timeouts.h"
+
+#include "host_pico.h"
+
+cyw43_t cyw43_state;
+
+static uint64_t host_epoch_us;
+static async_at_time_worker_t *host_workers; // ordenados por next_time
+
+static uint64_t host_clock_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+absolute_time_t get_absolute_time(void) {
+    return host_clock_us() - host_epoch_us;
+}
+
+uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000u);
+}
+
+uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t ms) {
+    return get_absolute_time() + (uint64_t)ms * 1000u;
+}
+
+void sleep_ms(uint32_t ms) {
+    absolute_time_t until = make_timeout_time_ms(ms);
+    while (get_absolute_time() < until) {
+        host_poll();
+    }
+}
+
+uint32_t get_rand_32(void) {
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+void pico_get_unique_board_id_string(char *id_out, uint len) {
+    const char *id = getenv("MQTT_PICO_BOARD_ID");
+    if (!id) {
+        id = "E6614103E7452D2F";
+    }
+    if (len) {
+        strncpy(id_out, id, len - 1);
+        id_out[len - 1] = '\0';
+    }
+}
+
+/**
+ * @brief Relógio do lwIP (NO_SYS), em ms.
+ */
+u32_t sys_now(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+async_context_t *cyw43_arch_async_context(void) {
+    return NULL; // há um único contexto, implícito
+}
+
+bool async_context_add_at_time_worker_in_ms(async_context_t *context, async_at_time_worker_t *worker, uint32_t ms) {
+    async_context_remove_at_time_worker(context, worker);
+
+    worker->next_time = make_timeout_time_ms(ms);
+    async_at_time_worker_t **pos = &host_workers;
+    while (*pos && (*pos)->next_time <= worker->next_time) {
+        pos = &(*pos)->next;
+    }
+    worker->next = *pos;
+    *pos = worker;
+    return true;
+}
+
+bool async_context_remove_at_time_worker(async_context_t *context, async_at_time_worker_t *worker) {
+    for (async_at_time_worker_t **pos = &host_workers; *pos; pos = &(*pos)->next) {
+        if (*pos == worker) {
+            *pos = worker->next;
+            worker->next = NULL;
+            return true;
+        }
+    }
+    return false;
+}
+
+int cyw43_arch_init(void) {
+    host_init();
+    return 0;
+}
+
+void cyw43_arch_poll(void) {
+    host_poll();
+}
+
+void host_init(void) {
+    host_epoch_us = host_clock_us();
+    srand((unsigned)host_epoch_us);
+    lwip_init(); // cria a interface de loopback (127.0.0.1)
+}
+
+void host_poll(void) {
+    netif_poll_all();
+    sys_check_timeouts();
+
+    absolute_time_t now = get_absolute_time();
+    while (host_workers && host_workers->next_time <= now) {
+        async_at_time_worker_t *worker = host_workers;
+        host_workers = worker->next;
+        worker->next = NULL;
+        worker->do_work(NULL, worker);
+    }
+}
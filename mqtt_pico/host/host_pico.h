@@ -0,0 +1,21 @@
+/**
+ * @file host_pico.h
+ *
+ * @brief Ambiente de execução de `mqtt_pico` no Linux: relógio, workers agendados e
+ *      lwIP (NO_SYS) sobre a interface de loopback, tudo em uma única thread.
+ */
+#ifndef HOST_PICO_H
+#define HOST_PICO_H
+
+/**
+ * @brief Inicializa o relógio e o lwIP. Deve ser chamada antes de qualquer outra função.
+ */
+void host_init(void);
+
+/**
+ * @brief Processa os pacotes pendentes na interface de loopback, os timeouts do lwIP e
+ *      os workers agendados que já venceram.
+ */
+void host_poll(void);
+
+#endif // HOST_PICO_H
@@ -0,0 +1,19 @@
+/**
+ * @file cc.h
+ *
+ * @brief Port mínimo do lwIP para Linux (NO_SYS, uma thread, interface de loopback).
+ */
+#ifndef HOST_ARCH_CC_H
+#define HOST_ARCH_CC_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef int sys_prot_t;
+
+#define LWIP_RAND() ((u32_t)rand())
+
+#define LWIP_PLATFORM_DIAG(x) do { printf x; } while (0)
+#define LWIP_PLATFORM_ASSERT(x) do { fprintf(stderr, "lwIP assert: %s (%s:%d)\n", x, __FILE__, __LINE__); abort(); } while (0)
+
+#endif // HOST_ARCH_CC_H
@@ -0,0 +1,25 @@
+/**
+ * @file async_context.h
+ *
+ * @brief Substituto de `pico/async_context.h`: apenas os workers agendados por tempo,
+ *      executados por `host_poll`.
+ */
+#ifndef HOST_PICO_ASYNC_CONTEXT_H
+#define HOST_PICO_ASYNC_CONTEXT_H
+
+#include "pico/stdlib.h"
+
+typedef struct async_context async_context_t;
+
+typedef struct async_work_on_timeout {
+    struct async_work_on_timeout *next;
+    void (*do_work)(async_context_t *context, struct async_work_on_timeout *timeout);
+    absolute_time_t next_time;
+    void *user_data;
+} async_at_time_worker_t;
+
+bool async_context_add_at_time_worker_in_ms(async_context_t *context, async_at_time_worker_t *worker, uint32_t ms);
+
+bool async_context_remove_at_time_worker(async_context_t *context, async_at_time_worker_t *worker);
+
+#endif // HOST_PICO_ASYNC_CONTEXT_H
@@ -0,0 +1,36 @@
+/**
+ * @file cyw43_arch.h
+ *
+ * @brief Substituto de `pico/cyw43_arch.h` para o Linux. Não há rádio: o lwIP roda
+ *      em uma única thread sobre a interface de loopback, e `cyw43_arch_poll`
+ *      processa pacotes, timeouts do lwIP e workers agendados.
+ */
+#ifndef HOST_PICO_CYW43_ARCH_H
+#define HOST_PICO_CYW43_ARCH_H
+
+#include "pico/async_context.h"
+
+// Uma única thread: não há o que travar
+static inline void cyw43_arch_lwip_begin(void) {}
+static inline void cyw43_arch_lwip_end(void) {}
+
+// Sem rádio: RSSI indisponível
+typedef struct cyw43_t {
+    int itf_state;
+} cyw43_t;
+
+extern cyw43_t cyw43_state;
+
+static inline int cyw43_wifi_get_rssi(cyw43_t *self, int32_t *rssi) {
+    *rssi = 0;
+    return -1;
+}
+
+// Inicializa o relógio e o lwIP (host_init); usada pela tarefa de rede da variante FreeRTOS
+int cyw43_arch_init(void);
+
+async_context_t *cyw43_arch_async_context(void);
+
+void cyw43_arch_poll(void);
+
+#endif // HOST_PICO_CYW43_ARCH_H
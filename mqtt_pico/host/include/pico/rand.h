@@ -0,0 +1,13 @@
+/**
+ * @file rand.h
+ *
+ * @brief Substituto de `pico/rand.h`.
+ */
+#ifndef HOST_PICO_RAND_H
+#define HOST_PICO_RAND_H
+
+#include "pico/stdlib.h"
+
+uint32_t get_rand_32(void);
+
+#endif // HOST_PICO_RAND_H
@@ -0,0 +1,29 @@
+/**
+ * @file stdlib.h
+ *
+ * @brief Substituto de `pico/stdlib.h` para a compilação de `mqtt_pico` no Linux.
+ *      Apenas os tipos e funções de tempo usados pela biblioteca.
+ */
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t; // microssegundos desde o início do processo
+
+absolute_time_t get_absolute_time(void);
+
+uint32_t to_ms_since_boot(absolute_time_t t);
+
+uint64_t to_us_since_boot(absolute_time_t t);
+
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to);
+
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+
+void sleep_ms(uint32_t ms);
+
+#endif // HOST_PICO_STDLIB_H
@@ -0,0 +1,14 @@
+/**
+ * @file unique_id.h
+ *
+ * @brief Substituto de `pico/unique_id.h`: ID fixo, sobrescrito pela variável de
+ *      ambiente `MQTT_PICO_BOARD_ID` se definida.
+ */
+#ifndef HOST_PICO_UNIQUE_ID_H
+#define HOST_PICO_UNIQUE_ID_H
+
+#include "pico/stdlib.h"
+
+void pico_get_unique_board_id_string(char *id_out, uint len);
+
+#endif // HOST_PICO_UNIQUE_ID_H
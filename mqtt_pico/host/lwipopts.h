@@ -0,0 +1,34 @@
+#ifndef _HOST_LWIPOPTS_H
+#define _HOST_LWIPOPTS_H
+
+// Mesmas opções do firmware, para que as medições reflitam a configuração de produção.
+// Para avaliar outra configuração, defina as opções na linha de comando do CMake
+// (ex.: -DMQTT_PICO_HOST_DEFS="MEM_SIZE=16000;MQTT_OUTPUT_RINGBUF_SIZE=1024").
+#include "../lwipopts.h"
+
+// lwIP sempre sem sistema operacional: mesmo na variante FreeRTOS (porta POSIX), ele roda
+// apenas na tarefa de rede, que chama host_poll
+#undef NO_SYS
+#define NO_SYS                      1
+
+// Uma única thread: sem proteção de região crítica
+#define SYS_LIGHTWEIGHT_PROT        0
+
+// Cliente e broker conversam pela interface de loopback (127.0.0.1)
+#define LWIP_HAVE_LOOPIF            1
+#define LWIP_NETIF_LOOPBACK         1
+
+// Estatísticas para o pico de memória do lwIP
+#undef LWIP_STATS
+#define LWIP_STATS                  1
+#undef LWIP_STATS_DISPLAY
+#define LWIP_STATS_DISPLAY          0
+#undef MEM_STATS
+#define MEM_STATS                   1
+#undef MEMP_STATS
+#define MEMP_STATS                  1
+
+// Conexões do cliente e do broker
+#define MEMP_NUM_TCP_PCB            8
+
+#endif
@@ -0,0 +1,223 @@
+/**
+ * @file mqtt_bench.c
+ *
+ * @brief Benchmark de `mqtt_pico` no Linux, contra o broker falso na interface de loopback.
+ *
+ *      Para cada QoS (0, 1 e 2) e tamanho de payload, publica `count` mensagens em um
+ *      tópico no qual o próprio cliente está inscrito e mede:
+ *        - vazão (mensagens/s e KiB/s de payload) até a última mensagem voltar;
+ *        - latência ponta a ponta (publicação → recepção), percentis 50/90/99 e máximo;
+ *        - pico de memória do heap do lwIP, da fila de publicação e da arena de recepção.
+ *
+ *      Uso: mqtt_bench [mensagens por cenário] [tamanhos de payload separados por vírgula]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+
+#include "mqtt_pico.h"
+#include "host_pico.h"
+#include "fake_broker.h"
+
+#define BENCH_PORT 1883
+#define BENCH_TOPIC "bench/echo"
+#define BENCH_MAX_COUNT 100000
+#define BENCH_TIMEOUT_MS 30000
+#define BENCH_HEADER_LEN 12 // sequência (4 bytes) + instante de envio em us (8 bytes)
+
+static mqtt_config_t mqtt;
+static uint64_t *bench_sent_us;
+static uint32_t *bench_latency_us;
+static uint32_t bench_received;
+static uint32_t bench_count;
+
+/**
+ * @brief Handler do tópico de eco: calcula a latência de cada mensagem recebida.
+ */
+static void bench_payload_cb(mqtt_config_t *mqtt, const mqtt_payload_t *payload, void *arg) {
+    if (!payload->last || payload->tot_len < BENCH_HEADER_LEN) {
+        return;
+    }
+    uint32_t seq;
+    uint64_t sent_us;
+    memcpy(&seq, payload->data, sizeof(seq));
+    memcpy(&sent_us, (const uint8_t *)payload->data + sizeof(seq), sizeof(sent_us));
+    if (seq < bench_count && bench_received < bench_count) {
+        bench_latency_us[bench_received++] = (uint32_t)(to_us_since_boot(get_absolute_time()) - sent_us);
+    }
+}
+
+static void bench_conn_cb(mqtt_client_t *client, void *arg, mqtt_connection_status_t status) {
+    if (status != MQTT_CONNECT_ACCEPTED) {
+        printf("[bench] conexão perdida (status %d)\n", status);
+    }
+}
+
+static int bench_cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t bench_percentile(const uint32_t *sorted, uint32_t n, uint32_t p) {
+    if (n == 0) {
+        return 0;
+    }
+    uint32_t i = (uint32_t)(((uint64_t)n * p + 99) / 100);
+    return sorted[i ? i - 1 : 0];
+}
+
+/**
+ * @brief Processa a rede até `done` ficar verdadeiro ou o tempo acabar.
+ */
+static bool bench_wait(bool (*done)(void), uint32_t timeout_ms) {
+    absolute_time_t until = make_timeout_time_ms(timeout_ms);
+    while (!done()) {
+        if (get_absolute_time() > until) {
+            return false;
+        }
+        host_poll();
+    }
+    return true;
+}
+
+static bool bench_running(void) {
+    return mqtt.conn.state == MQTT_STATE_RUNNING;
+}
+
+static bool bench_all_received(void) {
+    return bench_received >= bench_count;
+}
+
+static void bench_reset_stats(void) {
+    lwip_stats.mem.max = lwip_stats.mem.used;
+    for (int i = 0; i < MEMP_MAX; i++) {
+        lwip_stats.memp[i]->max = lwip_stats.memp[i]->used;
+    }
+    memset(&mqtt.pub_queue.stats, 0, sizeof(mqtt.pub_queue.stats));
+    mqtt.rx.arena_hwm = 0;
+}
+
+/**
+ * @brief Executa um cenário (QoS, tamanho) e imprime uma linha da tabela.
+ */
+static void bench_run(uint8_t qos, uint16_t size) {
+    static uint8_t payload[MQTT_OUTPUT_RINGBUF_SIZE];
+
+    mqtt.pub_qos = qos;
+    bench_received = 0;
+    bench_reset_stats();
+
+    absolute_time_t start = get_absolute_time();
+    for (uint32_t seq = 0; seq < bench_count; seq++) {
+        memset(payload, (uint8_t)seq, size);
+        bench_sent_us[seq] = to_us_since_boot(get_absolute_time());
+        memcpy(payload, &seq, sizeof(seq));
+        memcpy(payload + sizeof(seq), &bench_sent_us[seq], sizeof(bench_sent_us[seq]));
+
+        // Fila cheia: processa a rede até liberar espaço
+        absolute_time_t until = make_timeout_time_ms(BENCH_TIMEOUT_MS);
+        while (mqtt_queue_publish(&mqtt, BENCH_TOPIC, payload, size) != ERR_OK) {
+            if (get_absolute_time() > until) {
+                printf("[bench] fila travada (QoS %u, %u bytes)\n", qos, size);
+                return;
+            }
+            host_poll();
+        }
+        host_poll();
+    }
+    bool complete = bench_wait(bench_all_received, BENCH_TIMEOUT_MS);
+    double elapsed_s = absolute_time_diff_us(start, get_absolute_time()) / 1e6;
+
+    qsort(bench_latency_us, bench_received, sizeof(bench_latency_us[0]), bench_cmp_u32);
+    printf("%3u %6u %8u %10.0f %9.1f %8u %8u %8u %8u %8u %5u %5u %6u %5u%s\n",
+           qos, size, bench_received,
+           bench_received / elapsed_s,
+           bench_received * (double)size / 1024.0 / elapsed_s,
+           bench_percentile(bench_latency_us, bench_received, 50),
+           bench_percentile(bench_latency_us, bench_received, 90),
+           bench_percentile(bench_latency_us, bench_received, 99),
+           bench_received ? bench_latency_us[bench_received - 1] : 0,
+           (unsigned)lwip_stats.mem.max,
+           (unsigned)lwip_stats.memp[MEMP_TCP_SEG]->max,
+           (unsigned)lwip_stats.memp[MEMP_PBUF_POOL]->max,
+           (unsigned)mqtt.pub_queue.stats.arena_high_water,
+           (unsigned)mqtt.rx.arena_hwm,
+           complete ? "" : "  (incompleto)");
+}
+
+int main(int argc, char **argv) {
+    static const uint16_t default_sizes[] = {16, 64, 128, 192};
+    uint16_t sizes[16];
+    size_t num_sizes = 0;
+
+    bench_count = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 2000;
+    if (bench_count == 0 || bench_count > BENCH_MAX_COUNT) {
+        bench_count = 2000;
+    }
+    if (argc > 2) {
+        for (char *tok = strtok(argv[2], ","); tok && num_sizes < 16; tok = strtok(NULL, ",")) {
+            sizes[num_sizes++] = (uint16_t)strtoul(tok, NULL, 10);
+        }
+    } else {
+        memcpy(sizes, default_sizes, sizeof(default_sizes));
+        num_sizes = sizeof(default_sizes) / sizeof(default_sizes[0]);
+    }
+
+    bench_sent_us = calloc(bench_count, sizeof(*bench_sent_us));
+    bench_latency_us = calloc(bench_count, sizeof(*bench_latency_us));
+    if (!bench_sent_us || !bench_latency_us) {
+        return 1;
+    }
+
+    host_init();
+    if (!fake_broker_start(BENCH_PORT)) {
+        printf("[bench] não foi possível iniciar o broker\n");
+        return 1;
+    }
+
+    mqtt_config_init(&mqtt);
+    mqtt.client_info.client_id = "mqtt-bench";
+    mqtt.client_info.keep_alive = 60;
+    mqtt.sub_qos = 2;
+    mqtt_queue_config(&mqtt, false, NULL, NULL);
+    mqtt_set_payload_handler(&mqtt, MQTT_PAYLOAD_ASSEMBLE, NULL, NULL);
+
+    mqtt_route_t routes[] = {
+        { BENCH_TOPIC, bench_payload_cb, NULL }
+    };
+    mqtt_manage_routes(&mqtt, routes, 1, MQTT_SUBSCRIBE, NULL);
+    mqtt_start_client(&mqtt, "127.0.0.1", bench_conn_cb, NULL, NULL, NULL);
+    if (!bench_wait(bench_running, 5000)) {
+        printf("[bench] cliente não conectou ao broker\n");
+        return 1;
+    }
+
+    // Maior payload que cabe no buffer de saída do lwIP junto com o cabeçalho PUBLISH
+    uint16_t max_size = MQTT_OUTPUT_RINGBUF_SIZE - (5 + 2 + sizeof(BENCH_TOPIC) - 1 + 2);
+
+    printf("mqtt_pico host benchmark: %u mensagens por cenário, MQTT_OUTPUT_RINGBUF_SIZE=%u, MEM_SIZE=%u, "
+           "TCP_SND_BUF=%u, MQTT_REQ_MAX_IN_FLIGHT=%u\n",
+           bench_count, MQTT_OUTPUT_RINGBUF_SIZE, MEM_SIZE, TCP_SND_BUF, MQTT_REQ_MAX_IN_FLIGHT);
+    printf("qos  bytes      msgs      msg/s     KiB/s  p50(us)  p90(us)  p99(us)  max(us) lwipmem   seg  pbuf  fila  arena\n");
+    for (uint8_t qos = 0; qos <= 2; qos++) {
+        for (size_t i = 0; i < num_sizes; i++) {
+            if (sizes[i] < BENCH_HEADER_LEN || sizes[i] > max_size) {
+                printf("%3u %6u  ignorado: entre %u e %u bytes\n", qos, sizes[i], BENCH_HEADER_LEN, max_size);
+                continue;
+            }
+            bench_run(qos, sizes[i]);
+        }
+    }
+
+    const fake_broker_stats_t *stats = fake_broker_stats();
+    printf("broker: %u publicações recebidas, %u entregues, %u descartadas; RAM estática do cliente: %u bytes\n",
+           (unsigned)stats->publishes, (unsigned)stats->forwarded, (unsigned)stats->dropped,
+           (unsigned)sizeof(mqtt_config_t));
+
+    mqtt_stop_client(&mqtt);
+    return 0;
+}
@@ -0,0 +1,271 @@
+/**
+ * @file mqtt_compress_test.c
+ *
+ * @brief Teste de ida e volta da compressão de payloads (`mqtt_compress.c`) no Linux.
+ *
+ *      Comprime com `mqtt_compress` / `mqtt_compress_payload` e descomprime com
+ *      `mqtt_inflate_feed`, em fragmentos de vários tamanhos, cobrindo:
+ *        - mensagens maiores que a janela (a janela dá várias voltas);
+ *        - referências com distância 256 e comprimento 258 (os limites do formato);
+ *        - o caminho `MQTT_COMPRESS_STORED` de um payload incompressível;
+ *        - a rejeição de dados malformados (método, distância, truncamento, tamanho).
+ *
+ *      Uso: mqtt_compress_test
+ *      Código de saída 0 se todos os casos conferirem.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mqtt_pico.h"
+
+#define TEST_MAX_LEN 8192
+
+static const uint32_t test_frags[] = {1, 2, 7, 64, 255, 256, 1000, TEST_MAX_LEN * 2};
+
+static uint32_t test_errors;
+
+/**
+ * @brief Saída do descompressor: reconstrói o payload e confere a continuidade dos trechos.
+ */
+typedef struct {
+    uint8_t data[TEST_MAX_LEN];
+    uint32_t len;       // bytes recebidos
+    uint32_t calls_last; // chamadas com last = true
+    bool gap;           // trecho fora de ordem ou além do buffer
+} test_sink_t;
+
+static void test_out(void *arg, uint32_t offset, const uint8_t *data, uint32_t len, bool last) {
+    test_sink_t *sink = (test_sink_t *)arg;
+    if (offset != sink->len || offset + len > sizeof(sink->data)) {
+        sink->gap = true;
+        return;
+    }
+    memcpy(&sink->data[offset], data, len);
+    sink->len += len;
+    sink->calls_last += last;
+}
+
+static void test_fail(const char *name, const char *what) {
+    printf("[compress] %s: %s\n", name, what);
+    test_errors++;
+}
+
+/**
+ * @brief Descomprime `in` em fragmentos de `frag` bytes.
+ *
+ * @return true se não houve erro de formato.
+ */
+static bool test_inflate(const uint8_t *in, uint32_t len, uint32_t frag, test_sink_t *sink) {
+    static mqtt_inflate_t z;
+    memset(sink, 0, sizeof(*sink));
+    mqtt_inflate_begin(&z);
+    uint32_t i = 0;
+    do {
+        uint32_t n = len - i < frag ? len - i : frag;
+        mqtt_inflate_feed(&z, &in[i], n, i + n == len, test_out, sink);
+        i += n;
+    } while (i < len);
+    return !z.error;
+}
+
+/**
+ * @brief Confere a ida e volta de um payload comprimido em todos os tamanhos de fragmento.
+ */
+static void test_round_trip(const char *name, const uint8_t *raw, uint32_t raw_len, const uint8_t *comp, uint32_t comp_len) {
+    static test_sink_t sink;
+    for (size_t f = 0; f < sizeof(test_frags) / sizeof(test_frags[0]); f++) {
+        char what[64];
+        bool ok = test_inflate(comp, comp_len, test_frags[f], &sink);
+        snprintf(what, sizeof(what), "fragmentos de %u bytes", (unsigned)test_frags[f]);
+        if (!ok || sink.gap || sink.calls_last != 1 || sink.len != raw_len || memcmp(sink.data, raw, raw_len) != 0) {
+            test_fail(name, what);
+        }
+    }
+}
+
+/**
+ * @brief Procura no fluxo LZSS uma referência com a distância e o comprimento dados.
+ */
+static bool test_has_ref(const uint8_t *comp, uint32_t len, uint32_t dist, uint32_t match) {
+    uint32_t i = MQTT_COMPRESS_HEADER;
+    while (i < len) {
+        uint8_t flags = comp[i++];
+        for (int bit = 0; bit < 8 && i < len; bit++) {
+            if (flags & (1 << bit)) {
+                if (comp[i] + 1u == dist && comp[i + 1] + 3u == match) {
+                    return true;
+                }
+                i += 2;
+            } else {
+                i++;
+            }
+        }
+    }
+    return false;
+}
+
+static uint32_t test_rand_state = 12345;
+
+static uint8_t test_rand(void) {
+    test_rand_state = test_rand_state * 1103515245u + 12345u;
+    return (uint8_t)(test_rand_state >> 16);
+}
+
+/**
+ * @brief Ida e volta com janela dando a volta, distância 256 e comprimento 258.
+ */
+static void test_lzss(void) {
+    static uint8_t raw[TEST_MAX_LEN];
+    static uint8_t comp[TEST_MAX_LEN + TEST_MAX_LEN / 8 + 16];
+    uint32_t len = 0;
+
+    // bloco aleatório repetido logo em seguida: a melhor referência está a exatamente 256 bytes
+    for (uint32_t i = 0; i < 256; i++) {
+        raw[len++] = test_rand();
+    }
+    memcpy(&raw[len], raw, 256);
+    len += 256;
+    // sequência longa de um mesmo byte: referências de 258 bytes à distância 1
+    memset(&raw[len], 'a', 1000);
+    len += 1000;
+    // texto com linhas repetidas, até o fim do buffer
+    while (len < TEST_MAX_LEN) {
+        char line[64];
+        int n = snprintf(line, sizeof(line), "{\"t\":%u,\"v\":%u}\n", (unsigned)len, (unsigned)(test_rand() % 8));
+        if (len + (uint32_t)n > TEST_MAX_LEN) {
+            break;
+        }
+        memcpy(&raw[len], line, (size_t)n);
+        len += (uint32_t)n;
+    }
+
+    uint16_t n = mqtt_compress(raw, (uint16_t)len, comp, sizeof(comp));
+    if (n == 0 || n >= len) {
+        test_fail("lzss", "payload não comprimiu");
+        return;
+    }
+    if (comp[0] != MQTT_COMPRESS_LZSS || ((uint32_t)comp[1] << 8 | comp[2]) != len) {
+        test_fail("lzss", "cabeçalho incorreto");
+    }
+    if (!test_has_ref(comp, n, 256, 258) && !test_has_ref(comp, n, 256, 256)) {
+        test_fail("lzss", "nenhuma referência à distância 256");
+    }
+    if (!test_has_ref(comp, n, 1, 258)) {
+        test_fail("lzss", "nenhuma referência de comprimento 258");
+    }
+    test_round_trip("lzss", raw, len, comp, n);
+
+    // sem espaço para o resultado
+    if (mqtt_compress(raw, (uint16_t)len, comp, (uint16_t)(n - 1)) != 0) {
+        test_fail("lzss", "saída truncada não retornou 0");
+    }
+
+    // payload vazio
+    n = mqtt_compress(raw, 0, comp, sizeof(comp));
+    test_round_trip("vazio", raw, 0, comp, n);
+}
+
+/**
+ * @brief Payload incompressível de um tópico com compressão: segue como `MQTT_COMPRESS_STORED`.
+ */
+static void test_stored(void) {
+    static mqtt_config_t mqtt;
+    static uint8_t raw[MQTT_OUTPUT_RINGBUF_SIZE - MQTT_COMPRESS_HEADER];
+
+    mqtt_config_init(&mqtt);
+    mqtt_topic_t topic = mqtt_topic_register(&mqtt, "teste/comprimido");
+    if (topic < 0 || !mqtt_topic_compress(&mqtt, topic, true)) {
+        test_fail("stored", "registro do tópico");
+        return;
+    }
+    for (size_t i = 0; i < sizeof(raw); i++) {
+        raw[i] = test_rand();
+    }
+    uint16_t len = sizeof(raw);
+    const uint8_t *comp = mqtt_compress_payload(&mqtt, topic, raw, &len);
+    if (!comp || comp[0] != MQTT_COMPRESS_STORED || len != sizeof(raw) + MQTT_COMPRESS_HEADER) {
+        test_fail("stored", "payload aleatório não saiu como MQTT_COMPRESS_STORED");
+        return;
+    }
+    if (mqtt.compress.stats.tx_stored != 1) {
+        test_fail("stored", "tx_stored não contado");
+    }
+    test_round_trip("stored", raw, sizeof(raw), comp, len);
+}
+
+/**
+ * @brief Dados malformados: `z->error` marcado e nenhuma entrega final.
+ */
+static void test_malformed(void) {
+    static const struct {
+        const char *name;
+        uint8_t data[16];
+        uint32_t len;
+    } cases[] = {
+        {"método desconhecido", {2, 0, 1, 0x00, 'x'}, 5},
+        {"distância antes do início", {MQTT_COMPRESS_LZSS, 0, 5, 0x02, 'x', 1, 0}, 7},
+        {"referência além do tamanho", {MQTT_COMPRESS_LZSS, 0, 3, 0x02, 'x', 0, 0}, 7},
+        {"literal além do tamanho", {MQTT_COMPRESS_LZSS, 0, 1, 0x00, 'x', 'y'}, 6},
+        {"lzss truncado", {MQTT_COMPRESS_LZSS, 0, 3, 0x00, 'x', 'y'}, 6},
+        {"referência incompleta", {MQTT_COMPRESS_LZSS, 0, 4, 0x02, 'x', 0}, 6},
+        {"cabeçalho incompleto", {MQTT_COMPRESS_LZSS, 0}, 2},
+        {"stored truncado", {MQTT_COMPRESS_STORED, 0, 3, 'x', 'y'}, 5},
+        {"stored além do tamanho", {MQTT_COMPRESS_STORED, 0, 1, 'x', 'y'}, 5},
+    };
+    static test_sink_t sink;
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        for (uint32_t frag = 1; frag <= cases[c].len; frag++) {
+            if (test_inflate(cases[c].data, cases[c].len, frag, &sink) || sink.calls_last != 0) {
+                test_fail("malformado", cases[c].name);
+                break;
+            }
+        }
+    }
+
+    // referência válida à distância 256, depois uma à distância 256 com apenas 255 bytes produzidos
+    static uint8_t raw[300];
+    static uint8_t comp[400];
+    for (size_t i = 0; i < 256; i++) {
+        raw[i] = (uint8_t)i;
+    }
+    memcpy(&raw[256], raw, sizeof(raw) - 256);
+    uint16_t n = mqtt_compress(raw, sizeof(raw), comp, sizeof(comp));
+    test_round_trip("distância 256", raw, sizeof(raw), comp, n);
+    if (!test_has_ref(comp, n, 256, sizeof(raw) - 256)) {
+        test_fail("distância 256", "referência não gerada");
+    }
+    // 255 literais seguidos de uma referência à distância 256: um byte antes do início
+    uint32_t o = 0;
+    comp[o++] = MQTT_COMPRESS_LZSS;
+    comp[o++] = 258 >> 8;
+    comp[o++] = 258 & 0xFF;
+    for (uint32_t item = 0; item < 256; item++) {
+        if (item % 8 == 0) {
+            comp[o++] = item == 248 ? 0x80 : 0x00;
+        }
+        if (item < 255) {
+            comp[o++] = (uint8_t)item;
+        } else {
+            comp[o++] = 255;
+            comp[o++] = 0;
+        }
+    }
+    if (test_inflate(comp, o, o, &sink) || sink.calls_last != 0) {
+        test_fail("malformado", "distância 256 com 255 bytes produzidos");
+    }
+    comp[1] = 0; // mesmo fluxo sem a referência inválida, cortado antes dela
+    comp[2] = 255;
+    if (!test_inflate(comp, o - 2, o, &sink) || sink.len != 255) {
+        test_fail("malformado", "controle do caso anterior");
+    }
+}
+
+int main(void) {
+    test_lzss();
+    test_stored();
+    test_malformed();
+    printf("[compress] %s\n", test_errors ? "falhou" : "ok");
+    return test_errors ? 1 : 0;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file mqtt_rtos_test.c
+ *
+ * @brief Teste da variante FreeRTOS de `mqtt_pico` no Linux, sobre a porta POSIX do kernel
+ *      e o broker falso na interface de loopback.
+ *
+ *      A tarefa de rede (`mqtt_rtos_start`) inicia o broker e o cliente; uma tarefa de
+ *      aplicação se inscreve em um tópico de eco, publica `count` mensagens pela fila e as
+ *      recebe por notificação, medindo a latência publicação → recepção.
+ *
+ *      Uso: mqtt_rtos_test [mensagens]
+ *      Código de saída 0 se todas as mensagens voltarem dentro do prazo.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mqtt_pico.h"
+#include "host_pico.h"
+#include "fake_broker.h"
+
+#define TEST_PORT 1883
+#define TEST_TOPIC "rtos/echo"
+#define TEST_MAX_COUNT 10000
+#define TEST_TIMEOUT_MS 5000
+
+static mqtt_config_t mqtt;
+static mqtt_rtos_t rtos;
+static mqtt_rtos_sub_t sub;
+static uint32_t test_count;
+
+/**
+ * @brief Inicialização da rede, executada na tarefa de rede após `cyw43_arch_init`.
+ */
+static void test_setup(mqtt_config_t *mqtt, void *arg) {
+    if (!fake_broker_start(TEST_PORT)) {
+        printf("[rtos] não foi possível iniciar o broker\n");
+        return;
+    }
+    mqtt_start_client(mqtt, "127.0.0.1", NULL, NULL, NULL, NULL);
+}
+
+static int test_cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void test_task(void *arg) {
+    static uint32_t latency_us[TEST_MAX_COUNT];
+    static mqtt_rtos_msg_t msg;
+    int status = 1;
+
+    mqtt_topic_t topic = mqtt_topic_register(&mqtt, TEST_TOPIC);
+    if (!mqtt_rtos_start(&rtos, &mqtt, test_setup, NULL, tskIDLE_PRIORITY + 2)) {
+        printf("[rtos] falha ao iniciar a tarefa de rede\n");
+        exit(1);
+    }
+
+    // espera a conexão antes de se inscrever, para receber o SUBACK
+    for (uint32_t ms = 0; mqtt.conn.state != MQTT_STATE_RUNNING; ms += 10) {
+        if (ms > TEST_TIMEOUT_MS) {
+            printf("[rtos] cliente não conectou ao broker\n");
+            exit(1);
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    err_t err = mqtt_rtos_subscribe(&rtos, &sub, TEST_TOPIC, 8, pdMS_TO_TICKS(TEST_TIMEOUT_MS));
+    if (err != ERR_OK) {
+        printf("[rtos] inscrição falhou (%d)\n", err);
+        exit(1);
+    }
+
+    uint32_t received = 0;
+    for (uint32_t seq = 0; seq < test_count; seq++) {
+        uint64_t sent_us = to_us_since_boot(get_absolute_time());
+        uint8_t payload[12];
+        memcpy(payload, &seq, sizeof(seq));
+        memcpy(payload + sizeof(seq), &sent_us, sizeof(sent_us));
+        if (mqtt_rtos_publish(&rtos, topic, payload, sizeof(payload), pdMS_TO_TICKS(TEST_TIMEOUT_MS)) != ERR_OK) {
+            printf("[rtos] publicação %u expirou\n", seq);
+            break;
+        }
+
+        // uma mensagem por vez: a latência medida é a do caminho completo pelas filas
+        uint32_t bits = 0;
+        if (xTaskNotifyWait(0, MQTT_RTOS_NOTIFY_RX, &bits, pdMS_TO_TICKS(TEST_TIMEOUT_MS)) != pdTRUE) {
+            printf("[rtos] mensagem %u não voltou\n", seq);
+            break;
+        }
+        while (mqtt_rtos_receive(&sub, &msg, 0)) {
+            uint64_t now_us = to_us_since_boot(get_absolute_time());
+            if (msg.len >= sizeof(payload) && received < test_count) {
+                memcpy(&sent_us, msg.data + sizeof(seq), sizeof(sent_us));
+                latency_us[received++] = (uint32_t)(now_us - sent_us);
+            }
+        }
+    }
+
+    qsort(latency_us, received, sizeof(latency_us[0]), test_cmp_u32);
+    printf("mqtt_pico FreeRTOS (POSIX): %u/%u mensagens, latência p50 %u us, p99 %u us, máx %u us, "
+           "%u descartadas na fila da inscrição\n",
+           received, test_count,
+           received ? latency_us[received / 2] : 0,
+           received ? latency_us[(uint32_t)((uint64_t)received * 99 / 100)] : 0,
+           received ? latency_us[received - 1] : 0,
+           (unsigned)sub.dropped);
+    if (received == test_count && mqtt_rtos_unsubscribe(&rtos, TEST_TOPIC, pdMS_TO_TICKS(TEST_TIMEOUT_MS)) == ERR_OK) {
+        status = 0;
+    }
+    exit(status);
+}
+
+int main(int argc, char **argv) {
+    test_count = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 1000;
+    if (test_count == 0 || test_count > TEST_MAX_COUNT) {
+        test_count = 1000;
+    }
+
+    mqtt_config_init(&mqtt);
+    mqtt.client_info.client_id = "mqtt-rtos-test";
+    mqtt.client_info.keep_alive = 60;
+    mqtt.sub_qos = 1;
+    mqtt.pub_qos = 1;
+    mqtt_queue_config(&mqtt, false, NULL, NULL);
+
+    xTaskCreate(test_task, "test", 4096, NULL, tskIDLE_PRIORITY + 1, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
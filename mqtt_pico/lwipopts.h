@@ -6,6 +6,18 @@
 #define MEM_SIZE 8000
 #endif
 
+// Variante FreeRTOS (mqtt_pico_freertos): lwIP com sistema operacional e thread tcpip
+#ifdef MQTT_PICO_FREERTOS
+#undef NO_SYS
+#define NO_SYS                      0
+#define TCPIP_THREAD_STACKSIZE      1024
+#define DEFAULT_THREAD_STACKSIZE    1024
+#define DEFAULT_RAW_RECVMBOX_SIZE   8
+#define TCPIP_MBOX_SIZE             8
+#define LWIP_TIMEVAL_PRIVATE        0
+#define LWIP_TCPIP_CORE_LOCKING_INPUT 1
+#endif
+
 // Generally you would define your own explicit list of lwIP options
 // (see https://www.nongnu.org/lwip/2_1_x/group__lwip__opts.html)
 //
@@ -27,6 +39,56 @@
 #define TCP_WND  16384
 #endif // MQTT_CERT_INC
 
+// Perfis de RAM reduzida (CMake: -DMQTT_RAM_PROFILE=LOW ou MIN), não validados em dispositivo.
+// mqtt_budget.c só rejeita na compilação as combinações que o seu modelo de alocação já mostra
+// insuficientes (MEM_SIZE para o cliente MQTT, o estado do TLS e um segmento; TCP_WND para um
+// registro TLS; pbufs para a janela), e tools/mqtt_budget.py mostra quanto cada perfil ocupa.
+// Confirme cada perfil no dispositivo, com um handshake TLS real e o tráfego esperado, por
+// mqtt_budget_sample(): lwip_heap_err e pools_err em zero e tls_heap_high abaixo de tls_heap_budget.
+// Os perfis também reduzem as arenas e buffers de texto do cliente (MQTT_RAM_SCALE, mqtt_pico.h).
+//  LOW: metade dos pbufs e da janela TCP. Com TLS, exige registros do broker de até 8 KB.
+//  MIN: uma conexão com pouco tráfego. Com TLS, somente ECDSA e registros de 4 KB negociados
+//       pela extensão max_fragment_length (o broker deve aceitá-la, ex.: OpenSSL >= 1.1.1).
+#if defined(MQTT_RAM_PROFILE_LOW)
+#undef MEM_SIZE
+#undef PBUF_POOL_SIZE
+#undef MEMP_NUM_TCP_SEG
+#undef TCP_SND_BUF
+#undef TCP_WND
+#define PBUF_POOL_SIZE              12
+#define MEMP_NUM_TCP_SEG            16
+#define TCP_SND_BUF                 (4 * TCP_MSS)
+#ifdef MQTT_CERT_INC
+#define MEM_SIZE                    7000
+#define TCP_WND                     8192 // MBEDTLS_SSL_IN_CONTENT_LEN do perfil
+#else
+#define MEM_SIZE                    4000
+#define TCP_WND                     (4 * TCP_MSS)
+#endif
+#elif defined(MQTT_RAM_PROFILE_MIN)
+#undef MEM_SIZE
+#undef PBUF_POOL_SIZE
+#undef MEMP_NUM_TCP_SEG
+#undef TCP_SND_BUF
+#undef TCP_WND
+#define PBUF_POOL_SIZE              6
+#define MEMP_NUM_TCP_SEG            8
+#define TCP_SND_BUF                 (2 * TCP_MSS)
+#ifdef MQTT_CERT_INC
+#define MEM_SIZE                    6000
+#define TCP_WND                     4096 // MBEDTLS_SSL_IN_CONTENT_LEN do perfil
+#else
+#define MEM_SIZE                    3000
+#define TCP_WND                     (2 * TCP_MSS)
+#endif
+#endif
+
+// Contadores de memória do lwIP publicados pelas métricas do cliente (mqtt_metrics.c)
+#undef MEM_STATS
+#define MEM_STATS                   1
+#undef MEMP_STATS
+#define MEMP_STATS                  1
+
 // This defaults to 4
 #define MQTT_REQ_MAX_IN_FLIGHT 5
 
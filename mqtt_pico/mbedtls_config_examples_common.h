@@ -71,4 +71,60 @@
 // The following significantly speeds up mbedtls due to NIST optimizations.
 #define MBEDTLS_ECP_NIST_OPTIM
 
+// Session resumption: the client keeps the ticket/session ID across reconnects
+#define MBEDTLS_SSL_SESSION_TICKETS
+
+/* mbedTLS allocates on the C heap through mqtt_pico's counting wrappers, which record the
+   handshake peak (mqtt_tls_stats_t, mqtt_budget_sample). With both macros defined mbedTLS has no
+   mbedtls_platform_set_calloc_free, so lwIP's altcp_tls cannot route the allocations to its own
+   MEM_SIZE heap, where the 16 KB receive record buffer never fits; its call becomes a no-op. */
+#include <stddef.h>
+void *mqtt_tls_calloc(size_t n, size_t size);
+void mqtt_tls_free(void *ptr);
+#define MBEDTLS_PLATFORM_MEMORY
+#define MBEDTLS_PLATFORM_CALLOC_MACRO mqtt_tls_calloc
+#define MBEDTLS_PLATFORM_FREE_MACRO mqtt_tls_free
+#define mbedtls_platform_set_calloc_free(calloc_func, free_func) ((void)(calloc_func), (void)(free_func))
+
+/* Low-RAM profiles (see lwipopts.h). LOW halves the receive record buffer: the broker must
+   not send records over 8 KB (certificate chain included). MIN also shrinks the send buffer,
+   negotiates 4 KB records with max_fragment_length (set by mqtt_tls) and implies the
+   ECDSA-only profile below, whose certificates and handshake messages are smaller. */
+#if defined(MQTT_RAM_PROFILE_LOW)
+#define MBEDTLS_SSL_IN_CONTENT_LEN     8192
+#elif defined(MQTT_RAM_PROFILE_MIN)
+#define MBEDTLS_SSL_IN_CONTENT_LEN     4096
+#undef MBEDTLS_SSL_OUT_CONTENT_LEN
+#define MBEDTLS_SSL_OUT_CONTENT_LEN    1024
+#define MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+#ifndef MQTT_TLS_ECDSA_ONLY
+#define MQTT_TLS_ECDSA_ONLY
+#endif
+#endif
+
+/* ECDSA-only profile (define MQTT_TLS_ECDSA_ONLY): ECDHE-ECDSA with AES-128-GCM on
+   P-256/P-384 only. Drops RSA, CBC, the server side and unused curves, reducing code
+   size and handshake time. Requires broker and CA certificates with ECDSA keys. */
+#ifdef MQTT_TLS_ECDSA_ONLY
+#undef MBEDTLS_KEY_EXCHANGE_RSA_ENABLED
+#undef MBEDTLS_RSA_C
+#undef MBEDTLS_PKCS1_V15
+#undef MBEDTLS_PKCS5_C
+#undef MBEDTLS_MD5_C
+#undef MBEDTLS_SHA1_C
+#undef MBEDTLS_CIPHER_MODE_CBC
+#undef MBEDTLS_SSL_SRV_C
+#undef MBEDTLS_ECP_DP_SECP192R1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP224R1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP521R1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP192K1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP224K1_ENABLED
+#undef MBEDTLS_ECP_DP_SECP256K1_ENABLED
+#undef MBEDTLS_ECP_DP_BP256R1_ENABLED
+#undef MBEDTLS_ECP_DP_BP384R1_ENABLED
+#undef MBEDTLS_ECP_DP_BP512R1_ENABLED
+#undef MBEDTLS_ECP_DP_CURVE25519_ENABLED
+#define MBEDTLS_SSL_CIPHERSUITES MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256
+#endif
+
 #endif
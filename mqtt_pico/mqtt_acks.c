@@ -0,0 +1,118 @@
+#include "mqtt_pico.h"
+
+#define MQTT_ACKS_PUBACK  4 // tipos de pacote no cabeçalho fixo
+#define MQTT_ACKS_PUBREC  5
+#define MQTT_ACKS_PUBCOMP 7
+#define MQTT_ACKS_SUBACK  9
+
+/**
+ * @brief Repassa uma confirmação recebida, já com o ID de pacote, a quem a acompanha.
+ */
+static void acks_packet(mqtt_config_t *mqtt, uint8_t type, uint16_t pkt_id) {
+    if (type == MQTT_ACKS_PUBREC) {
+        mqtt_queue_pubrec(mqtt, pkt_id);
+    } else if (type == MQTT_ACKS_PUBACK || type == MQTT_ACKS_PUBCOMP) {
+        mqtt_queue_late_ack(mqtt, pkt_id);
+    }
+}
+
+/**
+ * @brief Acompanha os limites dos pacotes MQTT recebidos, sem copiá-los.
+ *
+ * Lê o cabeçalho fixo de cada pacote e, nas confirmações, o ID de pacote que o segue e os
+ * códigos de retorno do SUBACK; o restante é pulado.
+ */
+static void acks_scan(mqtt_config_t *mqtt, const uint8_t *data, uint16_t len) {
+    mqtt_acks_t *a = &mqtt->acks;
+
+    while (len) {
+        if (a->rx_skip && a->rx_pos < 2) {
+            a->rx_pkt_id = (uint16_t)(a->rx_pkt_id << 8) | *data++;
+            len--;
+            a->rx_skip--;
+            if (++a->rx_pos == 2) {
+                acks_packet(mqtt, a->rx_type, a->rx_pkt_id);
+            }
+            continue;
+        }
+        if (a->rx_skip && a->rx_type == MQTT_ACKS_SUBACK) {
+            mqtt_sub_suback(mqtt, a->rx_pkt_id, *data++);
+            len--;
+            a->rx_skip--;
+            continue;
+        }
+        if (a->rx_skip) {
+            uint32_t n = a->rx_skip < len ? a->rx_skip : len;
+            data += n;
+            len -= n;
+            a->rx_skip -= n;
+            continue;
+        }
+
+        uint8_t b = *data++;
+        len--;
+        if (!a->rx_in_len) {
+            a->rx_type = b >> 4;
+            a->rx_in_len = true;
+            a->rx_len = 0;
+            a->rx_shift = 0;
+            continue;
+        }
+
+        a->rx_len |= (uint32_t)(b & 0x7F) << a->rx_shift;
+        a->rx_shift += 7;
+        if ((b & 0x80) == 0 || a->rx_shift >= 28) {
+            a->rx_in_len = false;
+            a->rx_skip = a->rx_len;
+            a->rx_pkt_id = 0;
+            bool ack = a->rx_type == MQTT_ACKS_PUBACK || a->rx_type == MQTT_ACKS_PUBREC ||
+                       a->rx_type == MQTT_ACKS_PUBCOMP || a->rx_type == MQTT_ACKS_SUBACK;
+            a->rx_pos = ack ? 0 : 2;
+        }
+    }
+}
+
+/**
+ * @brief Callback de recepção instalado na conexão: inspeciona os pacotes e repassa ao lwIP.
+ *
+ * Como na inspeção das métricas, só começa quando o lwIP está no início de um pacote. As
+ * confirmações são vistas antes de o lwIP tratá-las.
+ */
+static err_t acks_recv(void *arg, struct altcp_pcb *conn, struct pbuf *p, err_t err) {
+    mqtt_client_t *client = (mqtt_client_t *)arg;
+    mqtt_config_t *mqtt = (mqtt_config_t *)client->connect_arg;
+    mqtt_acks_t *a = &mqtt->acks;
+    altcp_recv_fn next = a->recv;
+
+    if (p && err == ERR_OK) {
+        if (a->rx_skip == UINT32_MAX && mqtt_lwip_rx_at_packet_start(client)) {
+            a->rx_skip = 0;
+            a->rx_in_len = false;
+        }
+        if (a->rx_skip != UINT32_MAX) {
+            for (struct pbuf *q = p; q; q = q->next) {
+                acks_scan(mqtt, (const uint8_t *)q->payload, q->len);
+            }
+        }
+    }
+    return next(arg, conn, p, err);
+}
+
+/**
+ * @brief Instala a inspeção das confirmações recebidas na conexão recém-aceita.
+ *
+ * O lwIP não avisa o PUBREC nem as confirmações que chegam depois de `MQTT_REQ_TIMEOUT`, que
+ * a sessão persistente precisa para saber o que reenviar na reconexão, e do SUBACK repassa só
+ * o código de retorno do primeiro filtro. Chamada pela máquina de estados a cada CONNACK
+ * aceito, no contexto do lwIP.
+ *
+ * @param[in] mqtt Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ */
+void mqtt_acks_attach(mqtt_config_t *mqtt) {
+    mqtt_acks_t *a = &mqtt->acks;
+
+    if (!mqtt_lwip_hook_recv(mqtt->client, acks_recv, &a->recv)) {
+        return;
+    }
+    a->rx_skip = UINT32_MAX; // aguardando o início de um pacote
+}
@@ -0,0 +1,169 @@
+#include "mqtt_pico.h"
+
+/**
+ * @brief Bytes reservados para fechar o payload: "]}" no JSON, byte de parada no CBOR.
+ */
+static uint16_t batch_closing(const mqtt_batch_t *batch) {
+    return batch->enc.format == MQTT_ENC_JSON ? 2 : 1;
+}
+
+/**
+ * @brief Fecha o lote atual e o entrega à fila de publicação.
+ *
+ * Deve ser chamada no contexto do lwIP (callback ou entre `cyw43_arch_lwip_begin/end`).
+ */
+static void batch_publish(mqtt_batch_t *batch) {
+    if (batch->count == 0) {
+        return;
+    }
+    async_context_remove_at_time_worker(cyw43_arch_async_context(), &batch->timer);
+
+    mqtt_encoder_t *enc = &batch->enc;
+    enc->size += batch_closing(batch);
+    mqtt_enc_array_end(enc);
+    mqtt_enc_map_end(enc);
+
+    uint16_t len = mqtt_enc_finish(enc);
+    if (len && mqtt_queue_publish_keep(batch->mqtt, batch->topic, batch->buf, len) == ERR_OK) {
+        batch->stats.publishes++;
+    } else {
+        batch->stats.dropped += batch->count;
+    }
+    batch->count = 0;
+}
+
+/**
+ * @brief Worker do prazo máximo: publica o lote quando a amostra mais antiga expira.
+ */
+static void batch_timer(async_context_t *context, async_at_time_worker_t *worker) {
+    mqtt_batch_t *batch = (mqtt_batch_t *)worker->user_data;
+
+    if (batch->count) {
+        batch->stats.by_deadline++;
+        batch_publish(batch);
+    }
+}
+
+/**
+ * @brief Acrescenta uma amostra ao lote, abrindo-o se estiver vazio.
+ *
+ * @return false se a amostra não couber no limite de bytes (o lote fica inalterado).
+ */
+static bool batch_append(mqtt_batch_t *batch, uint32_t now, int32_t value) {
+    mqtt_encoder_t *enc = &batch->enc;
+
+    if (batch->count == 0) {
+        mqtt_enc_init(enc, enc->format, batch->buf, batch->max_bytes - batch_closing(batch));
+        batch->t0 = now;
+        mqtt_enc_map_begin(enc, 2);
+        mqtt_enc_key(enc, "t0");
+        mqtt_enc_fixed(enc, (int32_t)now, 0);
+        mqtt_enc_key(enc, "s");
+        mqtt_enc_array_begin_indefinite(enc);
+    }
+
+    mqtt_encoder_t saved = *enc;
+    mqtt_enc_array_begin(enc, 2);
+    mqtt_enc_fixed(enc, (int32_t)(now - batch->t0), 0);
+    mqtt_enc_fixed(enc, value, batch->decimals);
+    mqtt_enc_array_end(enc);
+    if (enc->overflow) {
+        *enc = saved;
+        return false;
+    }
+
+    if (batch->count++ == 0 && batch->max_latency_ms) {
+        async_context_add_at_time_worker_in_ms(cyw43_arch_async_context(), &batch->timer, batch->max_latency_ms);
+    }
+    return true;
+}
+
+/**
+ * @brief Inicializa um lote de telemetria para um fluxo de amostras.
+ *
+ * As amostras são acumuladas e publicadas juntas, em uma única mensagem, quando o
+ * primeiro dos limites é atingido: quantidade de amostras, tamanho do payload ou idade
+ * da amostra mais antiga. A publicação usa a fila de `mqtt_pico` (com `mqtt->pub_qos` e
+ * `mqtt->retain`) e nunca é descartada pela coalescência.
+ *
+ * @param[out] batch          Lote a inicializar. Deve permanecer válido enquanto estiver em uso
+ *                            (prefira alocação estática).
+ * @param[in]  mqtt           Cliente MQTT usado na publicação.
+ * @param[in]  topic          Tópico do fluxo, registrado com `mqtt_topic_register`.
+ * @param[in]  format         Formato do payload (`MQTT_ENC_JSON` ou `MQTT_ENC_CBOR`).
+ * @param[in]  decimals       Casas decimais dos valores passados a `mqtt_batch_add`.
+ * @param[in]  max_samples    Quantidade máxima de amostras por publicação (0 = sem limite).
+ * @param[in]  max_bytes      Tamanho máximo do payload (0 ou acima de `MQTT_BATCH_BUF_SIZE` usa
+ *                            `MQTT_BATCH_BUF_SIZE`).
+ * @param[in]  max_latency_ms Idade máxima da amostra mais antiga antes da publicação (0 = sem prazo).
+ *
+ * @code
+ * // Exemplo de uso: temperatura a cada 1 s, publicada a cada 30 amostras ou 60 s
+ * static mqtt_batch_t temp_batch;
+ * mqtt_batch_init(&temp_batch, &mqtt, mqtt_topic_register(&mqtt, "temp"), MQTT_ENC_CBOR, 2, 30, 0, 60000);
+ * ...
+ * mqtt_batch_add(&temp_batch, 2345); // 23,45 °C
+ * @endcode
+ *
+ * @see mqtt_batch_add, mqtt_batch_flush
+ */
+void mqtt_batch_init(mqtt_batch_t *batch, mqtt_config_t *mqtt, mqtt_topic_t topic, mqtt_enc_format_t format,
+                     uint8_t decimals, uint16_t max_samples, uint16_t max_bytes, uint32_t max_latency_ms) {
+    memset(batch, 0, sizeof(*batch));
+    batch->mqtt = mqtt;
+    batch->topic = topic;
+    batch->decimals = decimals;
+    batch->max_samples = max_samples;
+    batch->max_bytes = (max_bytes == 0 || max_bytes > MQTT_BATCH_BUF_SIZE) ? MQTT_BATCH_BUF_SIZE : max_bytes;
+    batch->max_latency_ms = max_latency_ms;
+    batch->enc.format = format;
+    batch->timer.do_work = batch_timer;
+    batch->timer.user_data = batch;
+}
+
+/**
+ * @brief Acrescenta uma amostra ao lote, com o instante atual.
+ *
+ * Se a amostra não couber no limite de bytes, o lote atual é publicado antes e a amostra
+ * abre o próximo. Ao atingir `max_samples`, o lote é publicado imediatamente.
+ *
+ * @param[in] batch Lote inicializado com `mqtt_batch_init`.
+ * @param[in] value Valor em ponto fixo, com `decimals` casas (ex.: 2345 com 2 casas = 23,45).
+ *
+ * @return true se a amostra foi aceita, false se ela sozinha não cabe no lote.
+ */
+bool mqtt_batch_add(mqtt_batch_t *batch, int32_t value) {
+    cyw43_arch_lwip_begin();
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    bool ok = batch_append(batch, now, value);
+    if (!ok && batch->count) {
+        batch->stats.by_bytes++;
+        batch_publish(batch);
+        ok = batch_append(batch, now, value);
+    }
+
+    if (ok) {
+        batch->stats.samples++;
+        if (batch->max_samples && batch->count >= batch->max_samples) {
+            batch->stats.by_count++;
+            batch_publish(batch);
+        }
+    } else {
+        batch->stats.dropped++;
+    }
+
+    cyw43_arch_lwip_end();
+    return ok;
+}
+
+/**
+ * @brief Publica imediatamente as amostras acumuladas, se houver.
+ *
+ * @param[in] batch Lote inicializado com `mqtt_batch_init`.
+ */
+void mqtt_batch_flush(mqtt_batch_t *batch) {
+    cyw43_arch_lwip_begin();
+    batch_publish(batch);
+    cyw43_arch_lwip_end();
+}
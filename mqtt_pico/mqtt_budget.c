@@ -0,0 +1,167 @@
+#include "mqtt_pico.h"
+
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+#include "lwip/priv/memp_priv.h"
+
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+#include "mbedtls/ssl.h"
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/pk.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#endif
+
+/**
+ * Heap do C usado pelo mbedTLS em um handshake completo além dos buffers de registro:
+ * certificados analisados, estado do handshake e ECDH. Estimativa do relatório até haver uma
+ * medição: o pico real é `mqtt_budget_usage_t.tls_heap_high` (e `mqtt_tls_stats_t.full_heap_peak`),
+ * que pode ser passado a `tools/mqtt_budget.py --tls-heap-high` ou usado para ajustar este valor.
+ */
+#ifndef MQTT_BUDGET_TLS_HANDSHAKE
+#ifdef MQTT_TLS_ECDSA_ONLY
+#define MQTT_BUDGET_TLS_HANDSHAKE 8192
+#else
+#define MQTT_BUDGET_TLS_HANDSHAKE 12288
+#endif
+#endif
+
+#define MQTT_BUDGET_TLS_RECORD_OVERHEAD 400 // cabeçalho, IV, MAC e padding de cada buffer de registro
+
+#define MQTT_BUDGET_LWIP_MEM_OVERHEAD 96 // cabeçalhos do heap do lwIP e campos próprios do altcp_tls
+
+#if defined(MQTT_RAM_PROFILE_LOW)
+#define MQTT_BUDGET_PROFILE 1
+#elif defined(MQTT_RAM_PROFILE_MIN)
+#define MQTT_BUDGET_PROFILE 2
+#else
+#define MQTT_BUDGET_PROFILE 0
+#endif
+
+#if MEM_LIBC_MALLOC
+#define MQTT_BUDGET_LWIP_HEAP 0
+#else
+#define MQTT_BUDGET_LWIP_HEAP MEM_SIZE
+#endif
+
+/*
+ * Onde cada parte da conexão é alocada:
+ *  - heap do C (calloc): buffers de registro do mbedTLS e todo o estado do handshake, alocados
+ *    por mqtt_tls_calloc (MBEDTLS_PLATFORM_CALLOC_MACRO, ver mqtt_pico.c);
+ *  - heap do lwIP (MEM_SIZE): mqtt_client_t (mqtt_client_new), a configuração TLS e o gerador
+ *    aleatório (altcp_mbedtls_alloc_config), o estado de cada conexão TLS, com seu
+ *    mbedtls_ssl_context, e os segmentos TCP de saída (PBUF_RAM) até TCP_SND_BUF;
+ *  - pool de pbufs (PBUF_POOL_SIZE): os dados recebidos, até TCP_WND.
+ */
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+// altcp_tls_config com CA, certificado e chave do cliente; entropia e DRBG; altcp_mbedtls_state_t
+#define MQTT_BUDGET_LWIP_TLS (sizeof(mbedtls_ssl_config) + 3 * sizeof(mbedtls_x509_crt) + \
+                              sizeof(mbedtls_pk_context) + sizeof(mbedtls_entropy_context) + \
+                              sizeof(mbedtls_ctr_drbg_context) + sizeof(mbedtls_ssl_context))
+#else
+#define MQTT_BUDGET_LWIP_TLS 0
+#endif
+
+// Heap do lwIP ocupado enquanto a conexão existe, antes de qualquer segmento de saída
+#define MQTT_BUDGET_LWIP_FIXED (sizeof(mqtt_client_t) + MQTT_BUDGET_LWIP_TLS + MQTT_BUDGET_LWIP_MEM_OVERHEAD)
+
+// Um segmento TCP de saída em pbuf PBUF_RAM: MSS, cabeçalhos e a estrutura do pbuf
+#define MQTT_BUDGET_TCP_SEGMENT (PBUF_POOL_BUFSIZE + 32)
+
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+#define MQTT_BUDGET_TLS_IN  MBEDTLS_SSL_IN_CONTENT_LEN
+#define MQTT_BUDGET_TLS_OUT MBEDTLS_SSL_OUT_CONTENT_LEN
+#define MQTT_BUDGET_TLS_HEAP (MBEDTLS_SSL_IN_CONTENT_LEN + MBEDTLS_SSL_OUT_CONTENT_LEN + \
+                              2 * MQTT_BUDGET_TLS_RECORD_OVERHEAD + MQTT_BUDGET_TLS_HANDSHAKE)
+#else
+#define MQTT_BUDGET_TLS_IN   0
+#define MQTT_BUDGET_TLS_OUT  0
+#define MQTT_BUDGET_TLS_HEAP 0
+#endif
+
+// Verificações dos perfis: combinações que compilam mas travam ou falham em execução
+#if LWIP_ALTCP && LWIP_ALTCP_TLS && TCP_WND < MBEDTLS_SSL_IN_CONTENT_LEN
+#error "TCP_WND menor que MBEDTLS_SSL_IN_CONTENT_LEN: a recepção de um registro TLS completo trava"
+#endif
+#if PBUF_POOL_SIZE * TCP_MSS < TCP_WND
+#error "PBUF_POOL_SIZE não comporta uma janela TCP_WND de dados recebidos"
+#endif
+#if !MEM_LIBC_MALLOC
+// sizeof não é avaliado pelo pré-processador
+_Static_assert(MEM_SIZE >= MQTT_BUDGET_LWIP_FIXED + MQTT_BUDGET_TCP_SEGMENT,
+               "MEM_SIZE não comporta o cliente MQTT, o estado do TLS e um segmento TCP");
+#endif
+
+/**
+ * @brief Configuração de memória deste firmware, lida do ELF por `tools/mqtt_budget.py`.
+ *
+ * Mantida pelo ligador mesmo sem referências (`--undefined=mqtt_budget_config` no CMake).
+ */
+__attribute__((used)) const mqtt_budget_config_t mqtt_budget_config = {
+    .magic = MQTT_BUDGET_MAGIC,
+    .version = MQTT_BUDGET_VERSION,
+    .profile = MQTT_BUDGET_PROFILE,
+    .config_size = sizeof(mqtt_config_t),
+    .output_ringbuf = MQTT_OUTPUT_RINGBUF_SIZE,
+    .lwip_heap = MQTT_BUDGET_LWIP_HEAP,
+    .pbuf_pool = PBUF_POOL_SIZE,
+    .pbuf_bufsize = PBUF_POOL_BUFSIZE,
+    .tcp_seg = MEMP_NUM_TCP_SEG,
+    .tcp_mss = TCP_MSS,
+    .tcp_wnd = TCP_WND,
+    .tcp_snd_buf = TCP_SND_BUF,
+    .tls_in = MQTT_BUDGET_TLS_IN,
+    .tls_out = MQTT_BUDGET_TLS_OUT,
+    .tls_heap = MQTT_BUDGET_TLS_HEAP,
+    .lwip_fixed = MQTT_BUDGET_LWIP_FIXED,
+    .tcp_segment = MQTT_BUDGET_TCP_SEGMENT,
+};
+
+/**
+ * @brief Lê o uso de memória do lwIP (heap e pools) e do mbedTLS, com os picos desde o boot.
+ *
+ * Compare os picos com o tamanho de cada recurso depois de exercitar o pior caso (handshake
+ * TLS completo, rajada de publicações, reconexões) para saber quanto um perfil menor ainda
+ * comporta. Falhas (`lwip_heap_err`, `pools_err`) indicam que o perfil é pequeno demais.
+ *
+ * O pico do heap do mbedTLS é contado a cada alocação (`mqtt_tls_calloc`), handshakes
+ * incluídos: `tls_heap_high` acima de `tls_heap_budget` indica que o relatório de
+ * `tools/mqtt_budget.py` subestima o perfil (rode-o com `--tls-heap-high`).
+ *
+ * @param[out] usage Uso atual e picos. Campos sem estatísticas compiladas ficam em zero.
+ *
+ * @note Os contadores do lwIP exigem `MEM_STATS` e `MEMP_STATS` (habilitados no lwipopts.h do
+ *       projeto).
+ */
+void mqtt_budget_sample(mqtt_budget_usage_t *usage) {
+    memset(usage, 0, sizeof(*usage));
+
+    cyw43_arch_lwip_begin();
+    #if LWIP_STATS && MEM_STATS
+        usage->lwip_heap_used = lwip_stats.mem.used;
+        usage->lwip_heap_high = lwip_stats.mem.max;
+        usage->lwip_heap_size = lwip_stats.mem.avail;
+        usage->lwip_heap_err = lwip_stats.mem.err;
+    #endif
+    #if LWIP_STATS && MEMP_STATS && !MEMP_MEM_MALLOC
+        for (uint8_t i = 0; i < MEMP_MAX; i++) {
+            const struct stats_mem *stats = lwip_stats.memp[i];
+            uint32_t size = memp_pools[i]->size;
+            usage->pools_used += stats->used * size;
+            usage->pools_high += stats->max * size;
+            usage->pools_size += memp_pools[i]->num * size;
+            usage->pools_err += stats->err;
+        }
+        usage->pbuf_used = lwip_stats.memp[MEMP_PBUF_POOL]->used;
+        usage->pbuf_high = lwip_stats.memp[MEMP_PBUF_POOL]->max;
+        usage->pbuf_total = PBUF_POOL_SIZE;
+        usage->tcp_seg_high = lwip_stats.memp[MEMP_TCP_SEG]->max;
+    #endif
+    cyw43_arch_lwip_end();
+
+    size_t used, high;
+    mqtt_tls_heap_usage(&used, &high);
+    usage->tls_heap_used = used;
+    usage->tls_heap_high = high;
+    usage->tls_heap_budget = MQTT_BUDGET_TLS_HEAP;
+}
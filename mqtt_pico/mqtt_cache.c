@@ -0,0 +1,300 @@
+#include "mqtt_pico.h"
+
+#include "hardware/flash.h"
+#include "pico/flash.h"
+
+#if LWIP_ALTCP && LWIP_ALTCP_TLS && MQTT_CACHE_TLS_SIZE
+#include "mbedtls/ssl.h"
+#endif
+
+#define MQTT_CACHE_MAGIC    0x4D514343 // "MQCC"
+#define MQTT_CACHE_FLASH_MS 100        // espera máxima pelo outro núcleo/tarefas antes de gravar
+
+/**
+ * Posição do registro na flash: por padrão, o último setor. Redefina se a aplicação já usar
+ * o fim da flash (sistema de arquivos, por exemplo).
+ */
+#ifndef MQTT_CACHE_FLASH_OFFSET
+#define MQTT_CACHE_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+#endif
+
+#if MQTT_CACHE_TLS_SIZE > FLASH_SECTOR_SIZE - 256
+#error "MQTT_CACHE_TLS_SIZE não cabe em um setor da flash"
+#endif
+
+static uint8_t cache_page[FLASH_PAGE_SIZE]; // última página do registro, completada com 0xFF
+
+/**
+ * @brief FNV-1a dos campos do registro após `crc`.
+ */
+static uint32_t cache_crc(const mqtt_cache_record_t *r) {
+    const uint8_t *p = (const uint8_t *)&r->magic;
+    size_t len = sizeof(*r) - offsetof(mqtt_cache_record_t, magic);
+    uint32_t hash = 2166136261u;
+
+    while (len--) {
+        hash = (hash ^ *p++) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Apaga o setor e grava o registro. Executada por `flash_safe_execute`, com o outro
+ *        núcleo (ou as demais tarefas) parado e as interrupções desativadas.
+ */
+static void cache_flash_write(void *param) {
+    const uint8_t *data = (const uint8_t *)param;
+    size_t full = sizeof(mqtt_cache_record_t) & ~(size_t)(FLASH_PAGE_SIZE - 1);
+    size_t tail = sizeof(mqtt_cache_record_t) - full;
+
+    flash_range_erase(MQTT_CACHE_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    if (full) {
+        flash_range_program(MQTT_CACHE_FLASH_OFFSET, data, full);
+    }
+    if (tail) {
+        memset(cache_page, 0xFF, sizeof(cache_page));
+        memcpy(cache_page, data + full, tail);
+        flash_range_program(MQTT_CACHE_FLASH_OFFSET + full, cache_page, FLASH_PAGE_SIZE);
+    }
+}
+
+/**
+ * @brief Registra o ponto de acesso, o canal e a concessão da associação atual.
+ */
+static void cache_update_net(mqtt_cache_t *cache, const char *ssid) {
+    mqtt_cache_net_t *net = &cache->record.net;
+    struct netif *netif = &cyw43_state.netif[CYW43_ITF_STA];
+
+    memset(net, 0, sizeof(*net));
+    strncpy(net->ssid, ssid, sizeof(net->ssid) - 1);
+    cyw43_wifi_get_bssid(&cyw43_state, net->bssid);
+    #ifdef CYW43_IOCTL_GET_CHANNEL
+        // channel_info_t: hw_channel, target_channel, scan_channel (little-endian)
+        uint8_t info[12] = {0};
+        if (cyw43_ioctl(&cyw43_state, CYW43_IOCTL_GET_CHANNEL, sizeof(info), info, CYW43_ITF_STA) == 0) {
+            net->channel = info[0];
+        }
+    #endif
+
+    cyw43_arch_lwip_begin();
+    net->ip = ip4_addr_get_u32(netif_ip4_addr(netif));
+    net->netmask = ip4_addr_get_u32(netif_ip4_netmask(netif));
+    net->gw = ip4_addr_get_u32(netif_ip4_gw(netif));
+    const ip_addr_t *dns = dns_getserver(0);
+    net->dns = IP_IS_V4(dns) ? ip4_addr_get_u32(ip_2_ip4(dns)) : 0;
+    cyw43_arch_lwip_end();
+}
+
+/**
+ * @brief Associa direto ao ponto de acesso e canal do cache, sem varredura, e aplica a
+ *        concessão anterior assim que a associação termina, sem esperar o DHCP.
+ *
+ * O cliente DHCP do CYW43 continua em segundo plano: se o servidor conceder outro endereço,
+ * a interface muda, a conexão com o broker cai e a máquina de estados reconecta.
+ *
+ * @return true se a interface ficou pronta dentro de `MQTT_CACHE_JOIN_MS`.
+ */
+static bool cache_fast_join(mqtt_cache_t *cache, const char *ssid, const char *pw, uint32_t auth) {
+    const mqtt_cache_net_t *net = &cache->record.net;
+    struct netif *netif = &cyw43_state.netif[CYW43_ITF_STA];
+
+    if (!pw) {
+        auth = CYW43_AUTH_OPEN;
+    }
+    if (cyw43_wifi_join(&cyw43_state, strlen(ssid), (const uint8_t *)ssid, pw ? strlen(pw) : 0,
+                        (const uint8_t *)pw, auth, net->bssid, net->channel)) {
+        return false;
+    }
+
+    bool addr_set = false;
+    absolute_time_t until = make_timeout_time_ms(MQTT_CACHE_JOIN_MS);
+    while (!time_reached(until)) {
+        int status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+        if (status == CYW43_LINK_UP) {
+            return true;
+        }
+        if (status < 0) {
+            break; // CYW43_LINK_FAIL, CYW43_LINK_NONET ou CYW43_LINK_BADAUTH
+        }
+        if (status == CYW43_LINK_NOIP && !addr_set && net->ip) {
+            ip4_addr_t ip, netmask, gw;
+            ip_addr_t dns;
+            ip4_addr_set_u32(&ip, net->ip);
+            ip4_addr_set_u32(&netmask, net->netmask);
+            ip4_addr_set_u32(&gw, net->gw);
+            ip_addr_set_ip4_u32(&dns, net->dns);
+
+            cyw43_arch_lwip_begin();
+            netif_set_addr(netif, &ip, &netmask, &gw);
+            if (net->dns) {
+                dns_setserver(0, &dns);
+            }
+            cyw43_arch_lwip_end();
+            addr_set = true;
+        }
+        cyw43_arch_poll();
+        sleep_ms(1);
+    }
+
+    cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+    return false;
+}
+
+/**
+ * @brief Carrega o cache de conexão da flash.
+ *
+ * @param[out] cache Cache a preencher. Deve permanecer válido enquanto for usado (prefira
+ *                   alocação estática).
+ *
+ * @return true se havia um registro válido (mesma versão, tamanho e CRC).
+ */
+bool mqtt_cache_load(mqtt_cache_t *cache) {
+    const mqtt_cache_record_t *stored = (const mqtt_cache_record_t *)(XIP_BASE + MQTT_CACHE_FLASH_OFFSET);
+    mqtt_cache_record_t *r = &cache->record;
+
+    memset(cache, 0, sizeof(*cache));
+    if (stored->magic != MQTT_CACHE_MAGIC || stored->version != MQTT_CACHE_VERSION ||
+        stored->size != sizeof(*r) || stored->crc != cache_crc(stored)) {
+        return false;
+    }
+    memcpy(r, stored, sizeof(*r));
+    if (r->tls_len > MQTT_CACHE_TLS_SIZE) {
+        r->tls_len = 0;
+    }
+    cache->valid = true;
+    return true;
+}
+
+/**
+ * @brief Conecta ao Wi-Fi tentando primeiro a associação do cache.
+ *
+ * Com um registro da mesma rede, associa direto ao BSSID e canal guardados e reutiliza o
+ * endereço da última concessão, sem varredura nem troca DHCP. Se isso falhar em
+ * `MQTT_CACHE_JOIN_MS`, segue o caminho completo (`cyw43_arch_wifi_connect_timeout_ms`).
+ * Em ambos os casos o cache em RAM é atualizado com a associação obtida; grave-o com
+ * `mqtt_cache_save`.
+ *
+ * @param[in,out] cache      Cache carregado com `mqtt_cache_load` (válido ou não).
+ * @param[in]     ssid       Nome da rede.
+ * @param[in]     pw         Senha, ou NULL para rede aberta.
+ * @param[in]     auth       Tipo de autenticação (`CYW43_AUTH_*`).
+ * @param[in]     timeout_ms Tempo máximo do caminho completo.
+ *
+ * @return 0 se conectou, ou o erro de `cyw43_arch_wifi_connect_timeout_ms`.
+ *
+ * @note Chame após `cyw43_arch_enable_sta_mode`, fora do contexto do lwIP.
+ */
+int mqtt_cache_wifi_connect(mqtt_cache_t *cache, const char *ssid, const char *pw, uint32_t auth, uint32_t timeout_ms) {
+    const mqtt_cache_net_t *net = &cache->record.net;
+
+    if (cache->valid && net->channel && strncmp(net->ssid, ssid, sizeof(net->ssid)) == 0) {
+        if (cache_fast_join(cache, ssid, pw, auth)) {
+            cache->wifi_hits++;
+            cache_update_net(cache, ssid);
+            return 0;
+        }
+        cache->wifi_misses++;
+    }
+
+    int err = cyw43_arch_wifi_connect_timeout_ms(ssid, pw, auth, timeout_ms);
+    if (err == 0) {
+        cache_update_net(cache, ssid);
+    }
+    return err;
+}
+
+/**
+ * @brief Entrega ao cliente o endereço do broker e a sessão TLS guardados.
+ *
+ * A primeira tentativa de conexão usa o endereço do cache sem consultar o DNS; se falhar,
+ * as seguintes resolvem normalmente. Com `MQTT_CACHE_TLS_SIZE`, a sessão TLS é oferecida ao
+ * broker no primeiro handshake, que fica reduzido à retomada quando o broker ainda aceita o
+ * ticket/ID.
+ *
+ * @param[in] cache  Cache carregado com `mqtt_cache_load`.
+ * @param[in] mqtt   Cliente configurado, antes de `mqtt_start_client`.
+ * @param[in] server Hostname passado a `mqtt_start_client`; o endereço só é usado se coincidir.
+ */
+void mqtt_cache_attach(mqtt_cache_t *cache, mqtt_config_t *mqtt, const char *server) {
+    const mqtt_cache_record_t *r = &cache->record;
+
+    if (!cache->valid) {
+        return;
+    }
+    if (r->broker.ip && strncmp(r->broker.name, server, sizeof(r->broker.name)) == 0) {
+        ip_addr_set_ip4_u32(&mqtt->server_ip, r->broker.ip);
+        mqtt->conn.cached_ip = true;
+    }
+
+    #if LWIP_ALTCP && LWIP_ALTCP_TLS && MQTT_CACHE_TLS_SIZE
+        mqtt_tls_t *tls = &mqtt->tls;
+        if (!tls->resume || r->tls_len == 0 || tls->session_valid) {
+            return;
+        }
+        if (tls->session) {
+            altcp_tls_free_session(tls->session);
+        }
+        tls->session = altcp_tls_alloc_session();
+        if (!tls->session) {
+            return;
+        }
+        mbedtls_ssl_session *session = mqtt_lwip_tls_session(tls->session);
+        if (mbedtls_ssl_session_load(session, r->tls, r->tls_len) == 0) {
+            tls->session_valid = true;
+            tls->session_tag = mqtt_tls_session_tag(session);
+        }
+    #endif
+}
+
+/**
+ * @brief Grava o cache na flash, se ele mudou.
+ *
+ * Antes de gravar, atualiza o registro com o endereço do broker (se o cliente já conectou)
+ * e, com `MQTT_CACHE_TLS_SIZE`, a sessão TLS negociada (segredo mestre em claro na flash). O setor só é apagado quando o registro difere do gravado: com a
+ * mesma rede, concessão e sessão, chamar a cada ciclo de sono não desgasta a flash.
+ *
+ * @param[in,out] cache Cache carregado com `mqtt_cache_load`.
+ * @param[in]     mqtt  Cliente cujo broker e sessão devem ser guardados. Pode ser NULL.
+ *
+ * @return true se a flash contém o registro atual.
+ *
+ * @note A gravação usa `flash_safe_execute`: no modo de dois núcleos, o outro núcleo é pausado
+ *       durante o apagamento do setor (dezenas de ms). Chame fora do contexto do lwIP.
+ */
+bool mqtt_cache_save(mqtt_cache_t *cache, const mqtt_config_t *mqtt) {
+    mqtt_cache_record_t *r = &cache->record;
+
+    if (mqtt && mqtt->conn.sessions > 0 && mqtt->conn.server && IP_IS_V4(&mqtt->server_ip)) {
+        memset(&r->broker, 0, sizeof(r->broker));
+        strncpy(r->broker.name, mqtt->conn.server, sizeof(r->broker.name) - 1);
+        r->broker.ip = ip4_addr_get_u32(ip_2_ip4(&mqtt->server_ip));
+    }
+
+    #if LWIP_ALTCP && LWIP_ALTCP_TLS && MQTT_CACHE_TLS_SIZE
+        if (mqtt && mqtt->tls.session_valid) {
+            size_t len = 0;
+            const mbedtls_ssl_session *session = mqtt_lwip_tls_session(mqtt->tls.session);
+            if (mbedtls_ssl_session_save(session, r->tls, sizeof(r->tls), &len) == 0) {
+                r->tls_len = (uint16_t)len;
+                memset(&r->tls[len], 0, sizeof(r->tls) - len);
+            } else {
+                r->tls_len = 0; // sessão maior que MQTT_CACHE_TLS_SIZE
+            }
+        }
+    #endif
+
+    r->magic = MQTT_CACHE_MAGIC;
+    r->version = MQTT_CACHE_VERSION;
+    r->size = sizeof(*r);
+    r->crc = cache_crc(r);
+
+    if (memcmp((const void *)(XIP_BASE + MQTT_CACHE_FLASH_OFFSET), r, sizeof(*r)) == 0) {
+        return true;
+    }
+    if (flash_safe_execute(cache_flash_write, r, MQTT_CACHE_FLASH_MS) != PICO_OK) {
+        return false;
+    }
+    cache->valid = true;
+    cache->writes++;
+    return true;
+}
@@ -0,0 +1,278 @@
+#include "mqtt_pico.h"
+
+#define MQTT_COMPRESS_MIN_MATCH 3   // referências menores não compensam os 2 bytes
+#define MQTT_COMPRESS_MAX_MATCH 258 // comprimento de 8 bits somado ao mínimo
+
+#define COMPRESS_HASH(p) ((uint8_t)(((p)[0] << 4) ^ ((p)[1] << 2) ^ (p)[2]))
+
+static uint16_t compress_head[256];                    // última posição (+1) de cada hash de 3 bytes
+static uint8_t compress_buf[MQTT_OUTPUT_RINGBUF_SIZE]; // payload comprimido; usado só no contexto do lwIP
+
+/**
+ * @brief Ativa ou desativa a compressão das publicações de um tópico.
+ *
+ * As publicações do tópico pela fila (`mqtt_queue_publish_topic`, `mqtt_queue_publish_keep`
+ * e, portanto, os lotes de `mqtt_batch_t`) são comprimidas com `mqtt_compress` antes de
+ * entrar na arena. Os assinantes precisam descomprimir o payload: em outro `mqtt_pico`,
+ * basta inscrever o filtro com `mqtt_route_t.compressed`.
+ *
+ * @param[in] mqtt   Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in] topic  Handle retornado por `mqtt_topic_register`.
+ * @param[in] enable Se true, comprime as publicações do tópico.
+ *
+ * @return false se o handle for inválido.
+ */
+bool mqtt_topic_compress(mqtt_config_t *mqtt, mqtt_topic_t topic, bool enable) {
+    if (topic < 0 || topic >= mqtt->topics.count) {
+        return false;
+    }
+    mqtt->topics.entries[topic].compress = enable;
+    return true;
+}
+
+/**
+ * @brief Comprime um payload com LZSS de janela fixa (256 bytes).
+ *
+ * Formato: cabeçalho de `MQTT_COMPRESS_HEADER` bytes (`MQTT_COMPRESS_LZSS` e o tamanho
+ * original) seguido de grupos de até 8 itens, cada grupo precedido por um byte de flags
+ * (bit menos significativo primeiro). Um bit 0 indica um literal (1 byte); um bit 1, uma
+ * referência de 2 bytes: distância menos 1 e comprimento menos 3. A busca é gulosa, com um
+ * único candidato por hash, como no LZ4: custo linear e nenhuma memória além da tabela de
+ * hash. Um lote de 60 amostras de `mqtt_batch_t` em JSON cai para cerca de 70% do tamanho
+ * original; logs de texto e configurações, com linhas repetidas, bem menos.
+ *
+ * @param[in]  in   Payload original.
+ * @param[in]  len  Tamanho de `in`.
+ * @param[out] out  Destino do payload comprimido.
+ * @param[in]  size Tamanho de `out`.
+ *
+ * @return Tamanho comprimido, ou 0 se não couber em `size`.
+ */
+uint16_t mqtt_compress(const uint8_t *in, uint16_t len, uint8_t *out, uint16_t size) {
+    if (size < MQTT_COMPRESS_HEADER) {
+        return 0;
+    }
+    out[0] = MQTT_COMPRESS_LZSS;
+    out[1] = (uint8_t)(len >> 8);
+    out[2] = (uint8_t)len;
+    memset(compress_head, 0, sizeof(compress_head));
+
+    uint16_t o = MQTT_COMPRESS_HEADER;
+    uint16_t flags = 0;
+    uint8_t bit = 8;
+    uint32_t i = 0;
+    while (i < len) {
+        if (bit == 8) {
+            if (o >= size) {
+                return 0;
+            }
+            flags = o;
+            out[o++] = 0;
+            bit = 0;
+        }
+
+        uint32_t best = 0;
+        uint32_t dist = 0;
+        if (i + MQTT_COMPRESS_MIN_MATCH <= len) {
+            uint8_t h = COMPRESS_HASH(&in[i]);
+            uint32_t cand = compress_head[h];
+            compress_head[h] = (uint16_t)(i + 1);
+            if (cand && i - (cand - 1) <= MQTT_COMPRESS_WINDOW) {
+                uint32_t max = len - i < MQTT_COMPRESS_MAX_MATCH ? len - i : MQTT_COMPRESS_MAX_MATCH;
+                const uint8_t *c = &in[cand - 1];
+                while (best < max && c[best] == in[i + best]) {
+                    best++;
+                }
+                dist = i - (cand - 1);
+            }
+        }
+
+        if (best >= MQTT_COMPRESS_MIN_MATCH) {
+            if (o + 2 > size) {
+                return 0;
+            }
+            out[flags] |= (uint8_t)(1 << bit);
+            out[o++] = (uint8_t)(dist - 1);
+            out[o++] = (uint8_t)(best - MQTT_COMPRESS_MIN_MATCH);
+            // as posições cobertas pela referência também viram candidatas
+            for (uint32_t j = i + 1; j < i + best && j + MQTT_COMPRESS_MIN_MATCH <= len; j++) {
+                compress_head[COMPRESS_HASH(&in[j])] = (uint16_t)(j + 1);
+            }
+            i += best;
+        } else {
+            if (o >= size) {
+                return 0;
+            }
+            out[o++] = in[i++];
+        }
+        bit++;
+    }
+    return o;
+}
+
+/**
+ * @brief Comprime, se o tópico pedir, um payload prestes a entrar na fila de publicação.
+ *
+ * Se a compressão não reduzir o payload, ele segue como `MQTT_COMPRESS_STORED` (apenas o
+ * cabeçalho é acrescentado), para que o assinante sempre encontre o mesmo formato.
+ *
+ * @param[in]     mqtt    Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in]     topic   Handle do tópico da publicação.
+ * @param[in]     payload Payload original.
+ * @param[in,out] len     Tamanho do payload; na saída, o tamanho a publicar.
+ *
+ * @return `payload` se o tópico não usa compressão, o buffer comprimido (válido até a próxima
+ *         chamada), ou NULL se nem a versão sem compressão couber em `MQTT_OUTPUT_RINGBUF_SIZE`.
+ *
+ * @note Chamada com a trava do lwIP, pela fila de publicação.
+ */
+const void *mqtt_compress_payload(mqtt_config_t *mqtt, mqtt_topic_t topic, const void *payload, uint16_t *len) {
+    if (topic < 0 || topic >= mqtt->topics.count || !mqtt->topics.entries[topic].compress) {
+        return payload;
+    }
+
+    mqtt_compress_stats_t *stats = &mqtt->compress.stats;
+    absolute_time_t start = get_absolute_time();
+    uint16_t n = mqtt_compress((const uint8_t *)payload, *len, compress_buf, sizeof(compress_buf));
+    if (n == 0 || n >= *len + MQTT_COMPRESS_HEADER) {
+        if ((uint32_t)*len + MQTT_COMPRESS_HEADER > sizeof(compress_buf)) {
+            return NULL;
+        }
+        compress_buf[0] = MQTT_COMPRESS_STORED;
+        compress_buf[1] = (uint8_t)(*len >> 8);
+        compress_buf[2] = (uint8_t)*len;
+        memcpy(&compress_buf[MQTT_COMPRESS_HEADER], payload, *len);
+        n = *len + MQTT_COMPRESS_HEADER;
+        stats->tx_stored++;
+    }
+
+    stats->tx_us += (uint32_t)absolute_time_diff_us(start, get_absolute_time());
+    stats->tx_messages++;
+    stats->tx_raw += *len;
+    stats->tx_bytes += n;
+    *len = n;
+    return compress_buf;
+}
+
+/**
+ * @brief Prepara o descompressor para uma nova mensagem.
+ */
+void mqtt_inflate_begin(mqtt_inflate_t *z) {
+    z->tot_len = 0;
+    z->produced = 0;
+    z->header = 0;
+    z->method = MQTT_COMPRESS_STORED;
+    z->pos = 0;
+    z->flushed = 0;
+    z->items = 0;
+    z->match = false;
+    z->error = false;
+}
+
+/**
+ * @brief Escreve um byte na janela, entregando o trecho pendente quando ela dá a volta.
+ */
+static void inflate_put(mqtt_inflate_t *z, uint8_t b, mqtt_inflate_out_t out, void *arg) {
+    z->window[z->pos++] = b;
+    z->produced++;
+    if (z->pos == 0) {
+        uint32_t run = MQTT_COMPRESS_WINDOW - z->flushed;
+        out(arg, z->produced - run, &z->window[z->flushed], run, false);
+        z->flushed = 0;
+    }
+}
+
+/**
+ * @brief Descomprime um fragmento de um payload gerado por `mqtt_compress_payload`.
+ *
+ * Os bytes produzidos são entregues a `out` em trechos contíguos da janela, no máximo um por
+ * volta da janela e um ao fim de cada fragmento: a memória usada é só a da janela, qualquer
+ * que seja o tamanho da mensagem. Dados malformados (referência antes do início, tamanho
+ * diferente do cabeçalho) marcam `z->error`, e o restante da mensagem é ignorado sem a
+ * entrega final.
+ *
+ * @param[in,out] z    Descompressor iniciado com `mqtt_inflate_begin`.
+ * @param[in]     in   Fragmento recebido.
+ * @param[in]     len  Tamanho de `in`.
+ * @param[in]     last Indica o último fragmento da mensagem.
+ * @param[in]     out  Destino dos bytes produzidos.
+ * @param[in]     arg  Argumento de `out`.
+ */
+void mqtt_inflate_feed(mqtt_inflate_t *z, const uint8_t *in, uint32_t len, bool last, mqtt_inflate_out_t out, void *arg) {
+    uint32_t i = 0;
+
+    while (i < len && !z->error) {
+        uint8_t b = in[i++];
+
+        if (z->header < MQTT_COMPRESS_HEADER) {
+            if (z->header++ == 0) {
+                z->method = b;
+                z->error = b > MQTT_COMPRESS_LZSS;
+            } else {
+                z->tot_len = (z->tot_len << 8) | b;
+            }
+            continue;
+        }
+
+        if (z->method == MQTT_COMPRESS_STORED) {
+            // sem compressão: o restante do fragmento é entregue sem passar pela janela
+            uint32_t n = len - i + 1;
+            if (z->produced + n > z->tot_len) {
+                z->error = true;
+                break;
+            }
+            z->produced += n;
+            bool done = last && z->produced == z->tot_len;
+            out(arg, z->produced - n, &in[i - 1], n, done);
+            if (done) {
+                return;
+            }
+            break;
+        }
+
+        if (z->match) {
+            uint32_t n = b + MQTT_COMPRESS_MIN_MATCH;
+            uint32_t dist = z->dist + 1u;
+            if (dist > z->produced || z->produced + n > z->tot_len) {
+                z->error = true;
+                break;
+            }
+            uint8_t from = (uint8_t)(z->pos - dist);
+            while (n--) {
+                inflate_put(z, z->window[from++], out, arg);
+            }
+            z->match = false;
+            continue;
+        }
+
+        if (z->items == 0) {
+            z->flags = b;
+            z->items = 8;
+            continue;
+        }
+        bool ref = z->flags & 1;
+        z->flags >>= 1;
+        z->items--;
+        if (ref) {
+            z->dist = b;
+            z->match = true;
+        } else if (z->produced < z->tot_len) {
+            inflate_put(z, b, out, arg);
+        } else {
+            z->error = true;
+        }
+    }
+
+    if (z->error) {
+        return;
+    }
+    if (last && (z->header < MQTT_COMPRESS_HEADER || z->match || z->produced != z->tot_len)) {
+        z->error = true;
+        return;
+    }
+    uint32_t run = (uint8_t)(z->pos - z->flushed);
+    if (run || last) {
+        out(arg, z->produced - run, &z->window[z->flushed], run, last);
+        z->flushed = z->pos;
+    }
+}
@@ -0,0 +1,236 @@
+#include "mqtt_pico.h"
+
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+
+#define MQTT_DUAL_IDLE_MS 10 // espera máxima do núcleo 1 entre verificações do anel de publicações
+
+static mqtt_dual_t *dual_core1; // instância atendida pelo núcleo 1
+
+/**
+ * @brief Desvio instalado em `mqtt->rx.forward`: copia o payload para o anel de recepção.
+ *
+ * Executado no núcleo 1, no contexto do lwIP. Payloads maiores que uma vaga ocupam várias,
+ * como fragmentos. Se o anel encher, os fragmentos restantes são descartados.
+ */
+static void dual_forward(mqtt_config_t *mqtt, const mqtt_payload_t *payload,
+                         mqtt_payload_cb_t handler, void *handler_arg, void *arg) {
+    mqtt_dual_t *dual = (mqtt_dual_t *)arg;
+
+    size_t topic_len = strlen(payload->topic);
+    if (topic_len + 2 > MQTT_DUAL_RX_SIZE) {
+        dual->stats.rx_dropped++;
+        return;
+    }
+    uint32_t room = MQTT_DUAL_RX_SIZE - topic_len - 2;
+
+    uint32_t done = 0;
+    do {
+        uint32_t head = dual->rx_head;
+        if (head - dual->rx_tail >= MQTT_DUAL_RX_LEN) {
+            dual->stats.rx_dropped++;
+            break;
+        }
+        __dmb(); // a vaga só é reescrita depois de liberada pelo núcleo 0
+
+        uint32_t chunk = payload->len - done < room ? payload->len - done : room;
+        mqtt_dual_rx_t *slot = &dual->rx[head & (MQTT_DUAL_RX_LEN - 1)];
+        slot->handler = handler;
+        slot->arg = handler_arg;
+        slot->tot_len = payload->tot_len;
+        slot->offset = payload->offset + done;
+        slot->data = (uint16_t)(topic_len + 1);
+        slot->len = (uint16_t)chunk;
+        slot->last = payload->last && done + chunk == payload->len;
+        memcpy(slot->buf, payload->topic, topic_len + 1);
+        memcpy(&slot->buf[slot->data], payload->data + done, chunk);
+        slot->buf[slot->data + chunk] = '\0';
+
+        __dmb(); // conteúdo visível antes do índice
+        dual->rx_head = head + 1;
+        done += chunk;
+    } while (done < payload->len);
+
+    __sev();
+}
+
+/**
+ * @brief Repassa à fila de publicação as mensagens enfileiradas pelo núcleo 0.
+ *
+ * Executada no núcleo 1. A fila copia o payload para sua arena, liberando a vaga do anel
+ * imediatamente; mensagens recusadas pela fila são contadas em `pub_queue.stats.dropped`.
+ */
+static void dual_drain_tx(mqtt_dual_t *dual) {
+    uint32_t tail = dual->tx_tail;
+
+    while (tail != dual->tx_head) {
+        __dmb(); // lê a vaga só depois de ver o índice do núcleo 0
+        const mqtt_dual_tx_t *slot = &dual->tx[tail & (MQTT_DUAL_TX_LEN - 1)];
+        if (mqtt_queue_publish_topic(dual->mqtt, slot->topic, slot->data, slot->len) == ERR_OK) {
+            dual->stats.tx_queued++;
+        }
+        __dmb();
+        dual->tx_tail = ++tail;
+    }
+}
+
+/**
+ * @brief Laço do núcleo 1: inicializa o CYW43 e a rede e atende o anel de publicações.
+ *
+ * Com `pico_cyw43_arch_lwip_threadsafe_background`, o lwIP e o driver do CYW43 rodam nas
+ * interrupções do núcleo que chamou `cyw43_arch_init`, ou seja, aqui.
+ */
+static void dual_core1_main(void) {
+    mqtt_dual_t *dual = dual_core1;
+
+    // permite que o núcleo 0 pause este núcleo durante gravações na flash (flash_safe_execute)
+    multicore_lockout_victim_init();
+
+    if (cyw43_arch_init()) {
+        dual->failed = true;
+        __sev();
+        return;
+    }
+    dual->setup(dual->mqtt, dual->setup_arg);
+    dual->ready = true;
+    __sev();
+
+    while (true) {
+        dual_drain_tx(dual);
+        best_effort_wfe_or_timeout(make_timeout_time_ms(MQTT_DUAL_IDLE_MS));
+    }
+}
+
+/**
+ * @brief Inicia o modo de dois núcleos: toda a rede (CYW43, lwIP, TLS e MQTT) no núcleo 1.
+ *
+ * O núcleo 1 chama `cyw43_arch_init` e em seguida `setup`, que deve conectar o Wi-Fi e iniciar
+ * o cliente com `mqtt_start_client`. A partir daí o núcleo 0 usa apenas `mqtt_dual_publish`
+ * e `mqtt_dual_poll`, que não tomam a trava do lwIP nem esperam pelo núcleo 1: o tempo do
+ * laço de controle não depende do tráfego de rede nem dos handshakes TLS.
+ *
+ * Os handlers das rotas (e o de `mqtt_set_payload_handler`) passam a ser chamados no núcleo 0,
+ * dentro de `mqtt_dual_poll`.
+ *
+ * @param[out] dual  Estado do modo de dois núcleos. Deve permanecer válido enquanto o programa
+ *                   rodar (prefira alocação estática).
+ * @param[in]  mqtt  Cliente já configurado com `mqtt_config_init`, com tópicos
+ *                   (`mqtt_topic_register`) e rotas (`mqtt_manage_routes`) registrados.
+ * @param[in]  setup Inicialização da rede, executada no núcleo 1.
+ * @param[in]  arg   Argumento repassado a `setup`.
+ *
+ * @return true quando o núcleo 1 termina `setup`, false se `cyw43_arch_init` falhar.
+ *
+ * @warning Não chame `cyw43_arch_init` no núcleo 0. Depois do início, o núcleo 0 não deve
+ *          chamar funções que tocam o lwIP (`mqtt_queue_publish*`, `mqtt_manage_*`,
+ *          `mqtt_start_client`/`mqtt_stop_client`, `mqtt_batch_*`) nem registrar tópicos.
+ *
+ * @code
+ * // Exemplo de uso:
+ * static void net_setup(mqtt_config_t *mqtt, void *arg) {
+ *     cyw43_arch_enable_sta_mode();
+ *     cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK, 30000);
+ *     mqtt_start_client(mqtt, MQTT_SERVER, NULL, NULL, NULL, NULL);
+ * }
+ * ...
+ * static mqtt_dual_t dual;
+ * mqtt_dual_start(&dual, &mqtt, net_setup, NULL);
+ * while (true) {
+ *     mqtt_dual_publish(&dual, temp_topic, payload, len);
+ *     mqtt_dual_poll(&dual);
+ * }
+ * @endcode
+ *
+ * @see mqtt_dual_publish, mqtt_dual_poll
+ */
+bool mqtt_dual_start(mqtt_dual_t *dual, mqtt_config_t *mqtt, mqtt_net_setup_cb_t setup, void *arg) {
+    memset(dual, 0, sizeof(*dual));
+    dual->mqtt = mqtt;
+    dual->setup = setup;
+    dual->setup_arg = arg;
+    mqtt->rx.forward = dual_forward;
+    mqtt->rx.forward_arg = dual;
+
+    dual_core1 = dual;
+    multicore_launch_core1(dual_core1_main);
+    while (!dual->ready && !dual->failed) {
+        __wfe();
+    }
+    return dual->ready;
+}
+
+/**
+ * @brief Enfileira uma publicação a partir do núcleo 0, sem travas.
+ *
+ * O payload é copiado para o anel e o núcleo 1 é acordado para repassá-lo à fila de
+ * publicação (com `mqtt->pub_qos` e `mqtt->retain`). Nunca bloqueia: com o anel cheio, a
+ * mensagem é recusada.
+ *
+ * @param[in] dual    Estado iniciado com `mqtt_dual_start`.
+ * @param[in] topic   Handle de `mqtt_topic_register`, obtido antes de `mqtt_dual_start`.
+ * @param[in] payload Dados a publicar.
+ * @param[in] len     Tamanho de `payload`, até `MQTT_DUAL_TX_SIZE`.
+ *
+ * @return true se a mensagem foi aceita, false se o anel estiver cheio ou o payload for grande
+ *         demais (contabilizada em `dual->stats.tx_dropped`).
+ */
+bool mqtt_dual_publish(mqtt_dual_t *dual, mqtt_topic_t topic, const void *payload, uint16_t len) {
+    uint32_t head = dual->tx_head;
+
+    if (len > MQTT_DUAL_TX_SIZE || head - dual->tx_tail >= MQTT_DUAL_TX_LEN) {
+        dual->stats.tx_dropped++;
+        return false;
+    }
+    __dmb(); // a vaga só é reescrita depois de liberada pelo núcleo 1
+
+    mqtt_dual_tx_t *slot = &dual->tx[head & (MQTT_DUAL_TX_LEN - 1)];
+    slot->topic = topic;
+    slot->len = len;
+    memcpy(slot->data, payload, len);
+
+    __dmb(); // conteúdo visível antes do índice
+    dual->tx_head = head + 1;
+    dual->stats.tx_accepted++;
+    __sev();
+    return true;
+}
+
+/**
+ * @brief Entrega, no núcleo 0, as mensagens recebidas pelo núcleo 1.
+ *
+ * Chama o handler de cada mensagem (o da rota, ou o de `mqtt_set_payload_handler`) com um
+ * `mqtt_payload_t` apontando para a vaga do anel, liberada ao retornar. Chame no laço
+ * principal; o tempo gasto é só o dos handlers.
+ *
+ * @param[in] dual Estado iniciado com `mqtt_dual_start`.
+ *
+ * @return Quantidade de mensagens (ou fragmentos) entregues.
+ *
+ * @note Nos handlers, publique com `mqtt_dual_publish`; o ponteiro `mqtt` recebido serve
+ *       apenas para leitura.
+ */
+uint16_t mqtt_dual_poll(mqtt_dual_t *dual) {
+    uint32_t tail = dual->rx_tail;
+    uint16_t delivered = 0;
+
+    while (tail != dual->rx_head) {
+        __dmb(); // lê a vaga só depois de ver o índice do núcleo 1
+        const mqtt_dual_rx_t *slot = &dual->rx[tail & (MQTT_DUAL_RX_LEN - 1)];
+        if (slot->handler) {
+            mqtt_payload_t payload = {
+                .topic = slot->buf,
+                .tot_len = slot->tot_len,
+                .offset = slot->offset,
+                .data = (const uint8_t *)&slot->buf[slot->data],
+                .len = slot->len,
+                .last = slot->last,
+            };
+            slot->handler(dual->mqtt, &payload, slot->arg);
+        }
+        __dmb();
+        dual->rx_tail = ++tail;
+        delivered++;
+    }
+    dual->stats.rx_delivered += delivered;
+    return delivered;
+}
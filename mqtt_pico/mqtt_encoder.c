@@ -0,0 +1,419 @@
+#include "mqtt_pico.h"
+
+// Potências de 10 usadas na conversão para ponto fixo
+static const int32_t enc_pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+#define ENC_MAX_DECIMALS 9
+
+/**
+ * @brief Copia bytes para o buffer, marcando overflow se não couberem.
+ */
+static void enc_write(mqtt_encoder_t *enc, const void *data, uint16_t len) {
+    if (enc->overflow || enc->size - enc->len < len) {
+        enc->overflow = true;
+        return;
+    }
+    memcpy(&enc->buf[enc->len], data, len);
+    enc->len += len;
+}
+
+static void enc_byte(mqtt_encoder_t *enc, uint8_t byte) {
+    enc_write(enc, &byte, 1);
+}
+
+/**
+ * @brief Cabeçalho CBOR: tipo maior nos 3 bits altos e argumento no menor tamanho possível.
+ */
+static void enc_cbor_head(mqtt_encoder_t *enc, uint8_t major, uint32_t arg) {
+    uint8_t head[5];
+    uint16_t len;
+
+    major <<= 5;
+    if (arg < 24) {
+        head[0] = major | arg;
+        len = 1;
+    } else if (arg <= 0xFF) {
+        head[0] = major | 24;
+        head[1] = arg;
+        len = 2;
+    } else if (arg <= 0xFFFF) {
+        head[0] = major | 25;
+        head[1] = arg >> 8;
+        head[2] = arg;
+        len = 3;
+    } else {
+        head[0] = major | 26;
+        head[1] = arg >> 24;
+        head[2] = arg >> 16;
+        head[3] = arg >> 8;
+        head[4] = arg;
+        len = 5;
+    }
+    enc_write(enc, head, len);
+}
+
+/**
+ * @brief Separador JSON antes de um novo item: ',' entre itens e nada após uma chave.
+ */
+static void enc_json_item(mqtt_encoder_t *enc) {
+    uint8_t bit = 1u << enc->depth;
+
+    if (enc->key) {
+        enc->key = false;
+        return;
+    }
+    if (enc->pending & bit) {
+        enc_byte(enc, ',');
+    }
+    enc->pending |= bit;
+}
+
+/**
+ * @brief Escreve um inteiro em decimal, com `decimals` casas após o ponto (JSON).
+ */
+static void enc_json_number(mqtt_encoder_t *enc, int32_t value, uint8_t decimals) {
+    char digits[12];
+    uint8_t n = 0;
+    uint32_t mag = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+
+    do {
+        digits[n++] = '0' + mag % 10;
+        mag /= 10;
+    } while (mag || n <= decimals);
+
+    char out[14];
+    uint8_t len = 0;
+    if (value < 0) {
+        out[len++] = '-';
+    }
+    while (n) {
+        if (n == decimals) {
+            out[len++] = '.';
+        }
+        out[len++] = digits[--n];
+    }
+    enc_write(enc, out, len);
+}
+
+/**
+ * @brief Remove zeros à direita da parte decimal (23.50 → 23.5, 23.00 → 23).
+ */
+static void enc_trim(int32_t *value, uint8_t *decimals) {
+    while (*decimals && *value % 10 == 0) {
+        *value /= 10;
+        (*decimals)--;
+    }
+}
+
+/**
+ * @brief Inicia a codificação de um payload em um buffer.
+ *
+ * @param[out] enc    Codificador. Não deve ser NULL.
+ * @param[in]  format Formato de saída (`MQTT_ENC_JSON` ou `MQTT_ENC_CBOR`).
+ * @param[out] buf    Buffer de saída, tipicamente o payload passado a `mqtt_queue_publish`.
+ * @param[in]  size   Tamanho de `buf`.
+ *
+ * @code
+ * // Exemplo de uso: {"t":23.45,"h":51.2} (JSON) ou o mapa equivalente em CBOR
+ * uint8_t payload[32];
+ * mqtt_encoder_t enc;
+ * mqtt_enc_init(&enc, MQTT_ENC_CBOR, payload, sizeof(payload));
+ * mqtt_enc_map_begin(&enc, 2);
+ * mqtt_enc_key(&enc, "t");
+ * mqtt_enc_fixed(&enc, 2345, 2);
+ * mqtt_enc_key(&enc, "h");
+ * mqtt_enc_fixed(&enc, 512, 1);
+ * mqtt_enc_map_end(&enc);
+ * uint16_t len = mqtt_enc_finish(&enc);
+ * if (len) {
+ *     mqtt_queue_publish_topic(&mqtt, topic, payload, len);
+ * }
+ * @endcode
+ */
+void mqtt_enc_init(mqtt_encoder_t *enc, mqtt_enc_format_t format, void *buf, uint16_t size) {
+    memset(enc, 0, sizeof(*enc));
+    enc->buf = (uint8_t *)buf;
+    enc->size = size;
+    enc->format = format;
+}
+
+/**
+ * @brief Abre um mapa (objeto JSON).
+ *
+ * @param[in] count Quantidade de pares chave/valor. Obrigatória no CBOR, que usa
+ *                  tamanhos definidos; ignorada no JSON.
+ */
+void mqtt_enc_map_begin(mqtt_encoder_t *enc, uint8_t count) {
+    if (enc->depth + 1 >= MQTT_ENC_MAX_DEPTH) {
+        enc->overflow = true;
+        return;
+    }
+    if (enc->format == MQTT_ENC_CBOR) {
+        enc_cbor_head(enc, 5, count);
+    } else {
+        enc_json_item(enc);
+        enc_byte(enc, '{');
+    }
+    enc->depth++;
+    enc->pending &= ~(1u << enc->depth);
+}
+
+/**
+ * @brief Fecha o mapa aberto por `mqtt_enc_map_begin`.
+ */
+void mqtt_enc_map_end(mqtt_encoder_t *enc) {
+    if (enc->depth == 0) {
+        enc->overflow = true;
+        return;
+    }
+    enc->depth--;
+    if (enc->format == MQTT_ENC_JSON) {
+        enc_byte(enc, '}');
+    }
+}
+
+/**
+ * @brief Abre um array.
+ *
+ * @param[in] count Quantidade de itens. Obrigatória no CBOR; ignorada no JSON.
+ */
+void mqtt_enc_array_begin(mqtt_encoder_t *enc, uint8_t count) {
+    if (enc->depth + 1 >= MQTT_ENC_MAX_DEPTH) {
+        enc->overflow = true;
+        return;
+    }
+    if (enc->format == MQTT_ENC_CBOR) {
+        enc_cbor_head(enc, 4, count);
+    } else {
+        enc_json_item(enc);
+        enc_byte(enc, '[');
+    }
+    enc->depth++;
+    enc->pending &= ~(1u << enc->depth);
+    enc->indefinite &= ~(1u << enc->depth);
+}
+
+/**
+ * @brief Abre um array cuja quantidade de itens ainda não é conhecida.
+ *
+ * No CBOR usa a codificação de tamanho indefinido (terminada por um byte de parada);
+ * no JSON equivale a `mqtt_enc_array_begin`. Útil quando os itens são acrescentados aos poucos.
+ */
+void mqtt_enc_array_begin_indefinite(mqtt_encoder_t *enc) {
+    if (enc->depth + 1 >= MQTT_ENC_MAX_DEPTH) {
+        enc->overflow = true;
+        return;
+    }
+    if (enc->format == MQTT_ENC_CBOR) {
+        enc_byte(enc, 0x9F);
+    } else {
+        enc_json_item(enc);
+        enc_byte(enc, '[');
+    }
+    enc->depth++;
+    enc->pending &= ~(1u << enc->depth);
+    enc->indefinite |= 1u << enc->depth;
+}
+
+/**
+ * @brief Fecha o array aberto por `mqtt_enc_array_begin` ou `mqtt_enc_array_begin_indefinite`.
+ */
+void mqtt_enc_array_end(mqtt_encoder_t *enc) {
+    if (enc->depth == 0) {
+        enc->overflow = true;
+        return;
+    }
+    uint8_t bit = 1u << enc->depth;
+    enc->depth--;
+    if (enc->format == MQTT_ENC_JSON) {
+        enc_byte(enc, ']');
+    } else if (enc->indefinite & bit) {
+        enc_byte(enc, 0xFF);
+    }
+    enc->indefinite &= ~bit;
+}
+
+/**
+ * @brief Escreve a chave do próximo valor de um mapa.
+ *
+ * A chave é escrita sem escape: use apenas nomes ASCII simples.
+ */
+void mqtt_enc_key(mqtt_encoder_t *enc, const char *key) {
+    uint16_t len = strlen(key);
+
+    if (enc->format == MQTT_ENC_CBOR) {
+        enc_cbor_head(enc, 3, len);
+        enc_write(enc, key, len);
+        return;
+    }
+    enc_json_item(enc);
+    enc_byte(enc, '"');
+    enc_write(enc, key, len);
+    enc_write(enc, "\":", 2);
+    enc->key = true;
+}
+
+/**
+ * @brief Escreve um inteiro.
+ */
+void mqtt_enc_int(mqtt_encoder_t *enc, int32_t value) {
+    mqtt_enc_fixed(enc, value, 0);
+}
+
+/**
+ * @brief Escreve um número em ponto fixo: `value / 10^decimals`.
+ *
+ * Zeros à direita da parte decimal são removidos. No JSON o número é escrito em decimal
+ * (`2345, 2` → `23.45`); no CBOR vira um inteiro ou, com casas decimais, uma fração
+ * decimal exata (tag 4: `[-2, 2345]`).
+ *
+ * @param[in] value    Valor escalado por 10^decimals.
+ * @param[in] decimals Quantidade de casas decimais (até 9).
+ */
+void mqtt_enc_fixed(mqtt_encoder_t *enc, int32_t value, uint8_t decimals) {
+    if (decimals > ENC_MAX_DECIMALS) {
+        enc->overflow = true;
+        return;
+    }
+    enc_trim(&value, &decimals);
+
+    if (enc->format == MQTT_ENC_JSON) {
+        enc_json_item(enc);
+        enc_json_number(enc, value, decimals);
+        return;
+    }
+
+    if (decimals) {
+        enc_cbor_head(enc, 6, 4);          // tag 4: fração decimal
+        enc_cbor_head(enc, 4, 2);          // [expoente, mantissa]
+        enc_cbor_head(enc, 1, decimals - 1); // expoente negativo: -decimals
+    }
+    if (value < 0) {
+        enc_cbor_head(enc, 1, (uint32_t)(-(value + 1)));
+    } else {
+        enc_cbor_head(enc, 0, (uint32_t)value);
+    }
+}
+
+/**
+ * @brief Escreve um float arredondado para `decimals` casas, sem printf.
+ *
+ * O valor é convertido uma única vez para ponto fixo e escrito com `mqtt_enc_fixed`.
+ * Valores fora da faixa de um int32 escalado marcam overflow.
+ */
+void mqtt_enc_float(mqtt_encoder_t *enc, float value, uint8_t decimals) {
+    if (decimals > ENC_MAX_DECIMALS) {
+        enc->overflow = true;
+        return;
+    }
+    float scaled = value * (float)enc_pow10[decimals];
+    if (!(scaled > -2147483520.0f && scaled < 2147483520.0f)) { // também rejeita NaN
+        enc->overflow = true;
+        return;
+    }
+    mqtt_enc_fixed(enc, (int32_t)(scaled + (scaled < 0 ? -0.5f : 0.5f)), decimals);
+}
+
+/**
+ * @brief Escreve um booleano.
+ */
+void mqtt_enc_bool(mqtt_encoder_t *enc, bool value) {
+    if (enc->format == MQTT_ENC_CBOR) {
+        enc_byte(enc, value ? 0xF5 : 0xF4);
+        return;
+    }
+    enc_json_item(enc);
+    if (value) {
+        enc_write(enc, "true", 4);
+    } else {
+        enc_write(enc, "false", 5);
+    }
+}
+
+/**
+ * @brief Escreve uma string. No JSON, aspas, barras e caracteres de controle são escapados.
+ */
+void mqtt_enc_str(mqtt_encoder_t *enc, const char *str) {
+    uint16_t len = strlen(str);
+
+    if (enc->format == MQTT_ENC_CBOR) {
+        enc_cbor_head(enc, 3, len);
+        enc_write(enc, str, len);
+        return;
+    }
+
+    static const char hex[] = "0123456789abcdef";
+    enc_json_item(enc);
+    enc_byte(enc, '"');
+    for (uint16_t i = 0; i < len; i++) {
+        uint8_t c = (uint8_t)str[i];
+        if (c == '"' || c == '\\') {
+            char esc[2] = {'\\', (char)c};
+            enc_write(enc, esc, 2);
+        } else if (c < 0x20) {
+            char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+            enc_write(enc, esc, 6);
+        } else {
+            enc_byte(enc, c);
+        }
+    }
+    enc_byte(enc, '"');
+}
+
+/**
+ * @brief Conclui a codificação.
+ *
+ * @return Tamanho do payload em `buf`, ou 0 se ele não coube no buffer ou se algum
+ *         mapa/array ficou aberto.
+ */
+uint16_t mqtt_enc_finish(mqtt_encoder_t *enc) {
+    if (enc->overflow || enc->depth != 0) {
+        return 0;
+    }
+    return enc->len;
+}
+
+#ifdef MQTT_PICO_AHT20
+/**
+ * @brief Adiciona ao mapa aberto as leituras de um AHT20: `"t"` (°C) e `"h"` (%UR), com 2 casas.
+ *
+ * Escreve 2 pares chave/valor; considere-os no `count` de `mqtt_enc_map_begin`.
+ */
+void mqtt_enc_aht20(mqtt_encoder_t *enc, const AHT20_Data *data) {
+    mqtt_enc_key(enc, "t");
+    mqtt_enc_float(enc, data->temperature, 2);
+    mqtt_enc_key(enc, "h");
+    mqtt_enc_float(enc, data->humidity, 2);
+}
+
+/**
+ * @brief Como `mqtt_enc_aht20`, a partir da leitura em ponto fixo (sem ponto flutuante).
+ */
+void mqtt_enc_aht20_fixed(mqtt_encoder_t *enc, const AHT20_Fixed *data) {
+    mqtt_enc_key(enc, "t");
+    mqtt_enc_fixed(enc, data->temperature, 2);
+    mqtt_enc_key(enc, "h");
+    mqtt_enc_fixed(enc, data->humidity, 2);
+}
+#endif
+
+#ifdef MQTT_PICO_MAX6675
+/**
+ * @brief Adiciona ao mapa aberto a leitura de um MAX6675: `"tc"` (°C), com 2 casas.
+ *
+ * O MAX6675 tem resolução de 0,25 °C, então 2 casas representam a leitura exatamente.
+ * Escreve 1 par chave/valor; a temperatura em °F pode ser derivada pelo consumidor.
+ */
+void mqtt_enc_max6675(mqtt_encoder_t *enc, const MAX6675_Data *data) {
+    mqtt_enc_key(enc, "tc");
+    mqtt_enc_float(enc, data->t_celsius, 2);
+}
+
+/**
+ * @brief Como `mqtt_enc_max6675`, a partir da leitura em ponto fixo (sem ponto flutuante).
+ */
+void mqtt_enc_max6675_fixed(mqtt_encoder_t *enc, const MAX6675_Fixed *data) {
+    mqtt_enc_key(enc, "tc");
+    mqtt_enc_fixed(enc, data->t_celsius, 2);
+}
+#endif
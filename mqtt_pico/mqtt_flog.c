@@ -0,0 +1,486 @@
+#include "mqtt_pico.h"
+
+#include "hardware/flash.h"
+#include "pico/flash.h"
+
+#define MQTT_FLOG_MAGIC    0x474F4C46 // "FLOG"
+#define MQTT_FLOG_FLASH_MS 100        // espera máxima pelo outro núcleo/tarefas antes de gravar
+
+/**
+ * Início da região do log: por padrão, os `MQTT_FLOG_SECTORS` setores abaixo do último,
+ * que guarda o cache de conexão (`mqtt_cache.c`).
+ */
+#ifndef MQTT_FLOG_FLASH_OFFSET
+#define MQTT_FLOG_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - (MQTT_FLOG_SECTORS + 1) * FLASH_SECTOR_SIZE)
+#endif
+
+#if MQTT_FLOG_PAGE_SIZE != FLASH_PAGE_SIZE
+#error "MQTT_FLOG_PAGE_SIZE deve ser igual a FLASH_PAGE_SIZE"
+#endif
+
+/**
+ * @brief Cabeçalho de cada setor do anel.
+ */
+typedef struct flog_sector_t {
+    uint32_t magic;     // MQTT_FLOG_MAGIC
+    uint32_t seq;       // ordem de escrita dos setores
+    uint32_t consumed;  // 0xFFFFFFFF até todos os registros serem reenviados, depois 0
+    uint32_t crc;       // CRC-32 de magic e seq
+} flog_sector_t;
+
+/**
+ * @brief Cabeçalho de cada registro, seguido do payload alinhado em 4 bytes.
+ */
+typedef struct flog_record_t {
+    uint16_t len;       // tamanho do payload (0xFFFF: fim dos registros do setor)
+    uint8_t topic;      // handle de `mqtt_topic_register`
+    uint8_t reserved;
+    uint32_t crc;       // CRC-32 de len, topic e payload
+} flog_record_t;
+
+#define FLOG_SECTOR_HDR sizeof(flog_sector_t)
+#define FLOG_RECORD_HDR sizeof(flog_record_t)
+
+typedef struct flog_op_t {
+    uint32_t offset;        // posição na flash
+    const uint8_t *data;    // página a gravar, ou NULL para apagar o setor
+} flog_op_t;
+
+static uint8_t flog_mark[FLASH_PAGE_SIZE]; // página que marca um setor como reenviado
+
+/**
+ * @brief CRC-32 (polinômio refletido 0xEDB88320), bit a bit: sem tabela na RAM.
+ */
+static uint32_t flog_crc32(uint32_t crc, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        for (uint8_t k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t flog_record_crc(const flog_record_t *rec, const void *payload) {
+    uint32_t crc = flog_crc32(0, rec, offsetof(flog_record_t, reserved));
+    return flog_crc32(crc, payload, rec->len);
+}
+
+static const uint8_t *flog_flash(uint16_t sector, uint32_t off) {
+    return (const uint8_t *)(XIP_BASE + MQTT_FLOG_FLASH_OFFSET + (uint32_t)sector * FLASH_SECTOR_SIZE + off);
+}
+
+static bool flog_sector_valid(const flog_sector_t *hdr) {
+    return hdr->magic == MQTT_FLOG_MAGIC && hdr->crc == flog_crc32(0, hdr, offsetof(flog_sector_t, consumed));
+}
+
+/**
+ * @brief Apaga um setor ou grava uma página. Executada por `flash_safe_execute`.
+ */
+static void flog_flash_op(void *param) {
+    const flog_op_t *op = (const flog_op_t *)param;
+
+    if (op->data) {
+        flash_range_program(op->offset, op->data, FLASH_PAGE_SIZE);
+    } else {
+        flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+    }
+}
+
+static bool flog_erase(mqtt_flog_t *flog, uint16_t sector) {
+    flog_op_t op = { MQTT_FLOG_FLASH_OFFSET + (uint32_t)sector * FLASH_SECTOR_SIZE, NULL };
+
+    if (flash_safe_execute(flog_flash_op, &op, MQTT_FLOG_FLASH_MS) != PICO_OK) {
+        return false;
+    }
+    flog->stats.erases++;
+    return true;
+}
+
+static bool flog_program(mqtt_flog_t *flog, uint16_t sector, uint32_t off, const uint8_t *page) {
+    flog_op_t op = { MQTT_FLOG_FLASH_OFFSET + (uint32_t)sector * FLASH_SECTOR_SIZE + off, page };
+
+    if (flash_safe_execute(flog_flash_op, &op, MQTT_FLOG_FLASH_MS) != PICO_OK) {
+        return false;
+    }
+    flog->stats.programs++;
+    return true;
+}
+
+/**
+ * @brief Grava a página em escrita se ela estiver cheia.
+ *
+ * Se a gravação falhar, a página continua na RAM e é gravada na próxima escrita ou
+ * `mqtt_flog_sync`.
+ *
+ * @return false se a página cheia não pôde ser gravada.
+ */
+static bool flog_flush(mqtt_flog_t *flog) {
+    if (flog->flash_off >= flog->head_off || flog->head_off % FLASH_PAGE_SIZE != 0) {
+        return true;
+    }
+    if (!flog_program(flog, flog->head_sector, flog->head_off - FLASH_PAGE_SIZE, flog->page)) {
+        return false;
+    }
+    flog->flash_off = flog->head_off;
+    memset(flog->page, 0xFF, sizeof(flog->page));
+    return true;
+}
+
+/**
+ * @brief Copia bytes para a página em escrita, gravando cada página que enche.
+ *
+ * @return false se uma página cheia não pôde ser gravada: ela é mantida, e parte de `data`
+ *         pode não ter sido copiada.
+ */
+static bool flog_write(mqtt_flog_t *flog, const void *data, uint32_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+
+    while (len) {
+        if (!flog_flush(flog)) {
+            return false;
+        }
+        uint32_t pos = flog->head_off % FLASH_PAGE_SIZE;
+        uint32_t n = FLASH_PAGE_SIZE - pos < len ? FLASH_PAGE_SIZE - pos : len;
+        if (p) {
+            memcpy(&flog->page[pos], p, n);
+            p += n;
+        } else {
+            memset(&flog->page[pos], 0, n); // alinhamento do payload
+        }
+        flog->head_off += n;
+        len -= n;
+    }
+    return flog_flush(flog);
+}
+
+/**
+ * @brief Desfaz um registro cuja escrita falhou.
+ *
+ * Se nada do registro chegou à flash, ele é retirado da página em escrita, que mantém os
+ * registros anteriores. Se parte dele já foi gravada, o registro fica truncado na flash
+ * (o reenvio o descarta pelo CRC) e o setor é encerrado: o próximo registro abre outro.
+ */
+static void flog_abort(mqtt_flog_t *flog, uint16_t start) {
+    if (flog->flash_off <= start) {
+        uint32_t pos = start % FLASH_PAGE_SIZE;
+        memset(&flog->page[pos], 0xFF, FLASH_PAGE_SIZE - pos);
+        flog->head_off = start;
+    } else {
+        flog->head_off = FLASH_SECTOR_SIZE;
+        flog->flash_off = FLASH_SECTOR_SIZE;
+        memset(flog->page, 0xFF, sizeof(flog->page));
+    }
+}
+
+/**
+ * @brief Passa a escrever no próximo setor do anel.
+ *
+ * Com o log cheio, o setor mais antigo ainda não reenviado é sobrescrito: o log guarda
+ * sempre os dados mais recentes. Com o cliente conectado, o próximo setor precisa ter sido
+ * apagado antes por `mqtt_flog_poll`: o apagamento pausa o outro núcleo por dezenas de ms
+ * e não é feito no caminho da publicação.
+ */
+static bool flog_next_sector(mqtt_flog_t *flog) {
+    mqtt_config_t *mqtt = flog->mqtt;
+    uint16_t next = (flog->head_sector + 1) % MQTT_FLOG_SECTORS;
+
+    mqtt_flog_sync(flog);
+    if (flog->flash_off != flog->head_off) {
+        return false; // página mantida na RAM: o setor atual ainda não pode ser deixado
+    }
+    if (flog->erased != next && mqtt->client && mqtt_client_is_connected(mqtt->client)) {
+        return false;
+    }
+    if (next == flog->tail_sector && mqtt_flog_pending(flog)) {
+        flog->stats.overwritten++;
+        flog->tail_sector = (next + 1) % MQTT_FLOG_SECTORS;
+        flog->tail_off = FLOG_SECTOR_HDR;
+    }
+    if (flog->erased != next && !flog_erase(flog, next)) {
+        return false;
+    }
+    flog->erased = MQTT_FLOG_SECTORS;
+
+    flog->seq++;
+    flog->head_sector = next;
+    flog->head_off = 0;
+    flog->flash_off = 0;
+    memset(flog->page, 0xFF, sizeof(flog->page));
+
+    flog_sector_t hdr = { MQTT_FLOG_MAGIC, flog->seq, 0xFFFFFFFF, 0 };
+    hdr.crc = flog_crc32(0, &hdr, offsetof(flog_sector_t, consumed));
+    memcpy(flog->page, &hdr, sizeof(hdr)); // gravado com a primeira página
+    flog->head_off = sizeof(hdr);
+    return true;
+}
+
+/**
+ * @brief Apaga com antecedência o próximo setor do anel, se ele não guardar registros a reenviar.
+ */
+static void flog_erase_ahead(mqtt_flog_t *flog) {
+    uint16_t next = (flog->head_sector + 1) % MQTT_FLOG_SECTORS;
+    bool busy = next == flog->tail_sector && mqtt_flog_pending(flog);
+
+    if (flog->erased != next && !busy && flog_erase(flog, next)) {
+        flog->erased = next;
+    }
+}
+
+/**
+ * @brief Marca um setor como reenviado, para que não volte a ser reenviado após um reset.
+ *
+ * Grava apenas o campo `consumed` (os demais bytes da página ficam em 0xFF, o que não altera
+ * a flash).
+ */
+static void flog_consume(mqtt_flog_t *flog, uint16_t sector) {
+    if (!flog_sector_valid((const flog_sector_t *)flog_flash(sector, 0))) {
+        return;
+    }
+    memset(flog_mark, 0xFF, sizeof(flog_mark));
+    memset(&flog_mark[offsetof(flog_sector_t, consumed)], 0, sizeof(uint32_t));
+    flog_program(flog, sector, 0, flog_mark);
+}
+
+/**
+ * @brief Inicia o log de telemetria, retomando o que ficou na flash antes do reset.
+ *
+ * Os setores são lidos para encontrar o de escrita (maior sequência) e o primeiro ainda não
+ * reenviado (menor sequência sem `consumed`). Setores reenviados só em parte voltam a ser
+ * reenviados do início: a entrega é ao menos uma vez.
+ *
+ * O log ocupa `MQTT_FLOG_SECTORS` setores abaixo do último setor da flash (cache de conexão);
+ * cada setor é apagado uma vez por volta do anel, o que distribui o desgaste por igual.
+ *
+ * @param[out] flog Estado do log. Deve permanecer válido enquanto o programa rodar (prefira
+ *                  alocação estática).
+ * @param[in]  mqtt Cliente usado no reenvio.
+ */
+void mqtt_flog_init(mqtt_flog_t *flog, mqtt_config_t *mqtt) {
+    int32_t head = -1;
+    int32_t tail = -1;
+    uint32_t tail_seq = 0;
+
+    memset(flog, 0, sizeof(*flog));
+    flog->mqtt = mqtt;
+    flog->erased = MQTT_FLOG_SECTORS;
+    flog->next_replay = get_absolute_time();
+    memset(flog->page, 0xFF, sizeof(flog->page));
+
+    for (uint16_t s = 0; s < MQTT_FLOG_SECTORS; s++) {
+        const flog_sector_t *hdr = (const flog_sector_t *)flog_flash(s, 0);
+        if (!flog_sector_valid(hdr)) {
+            continue;
+        }
+        if (head < 0 || hdr->seq > flog->seq) {
+            head = s;
+            flog->seq = hdr->seq;
+        }
+        if (hdr->consumed == 0xFFFFFFFF && (tail < 0 || hdr->seq < tail_seq)) {
+            tail = s;
+            tail_seq = hdr->seq;
+        }
+    }
+
+    if (head < 0) {
+        // Log vazio: o primeiro registro abre o setor 0
+        flog->head_sector = MQTT_FLOG_SECTORS - 1;
+        flog->head_off = FLASH_SECTOR_SIZE;
+        flog->flash_off = FLASH_SECTOR_SIZE;
+        flog->tail_sector = flog->head_sector;
+        flog->tail_off = flog->head_off;
+        return;
+    }
+
+    // Fim dos registros do setor de escrita. Um registro truncado (reset antes de gravar a
+    // página seguinte) não pode ser sobrescrito: a escrita continua no próximo setor.
+    uint32_t off = FLOG_SECTOR_HDR;
+    while (off + FLOG_RECORD_HDR <= FLASH_SECTOR_SIZE) {
+        const flog_record_t *rec = (const flog_record_t *)flog_flash(head, off);
+        uint32_t size = FLOG_RECORD_HDR + ((rec->len + 3u) & ~3u);
+        if (rec->len == 0xFFFF) {
+            break;
+        }
+        if (off + size > FLASH_SECTOR_SIZE || rec->crc != flog_record_crc(rec, rec + 1)) {
+            off = FLASH_SECTOR_SIZE;
+            break;
+        }
+        off += size;
+    }
+    flog->head_sector = head;
+    flog->head_off = off;
+    flog->flash_off = off;
+    if (off < FLASH_SECTOR_SIZE) {
+        uint32_t page = off & ~(FLASH_PAGE_SIZE - 1);
+        memcpy(flog->page, flog_flash(head, page), FLASH_PAGE_SIZE);
+    }
+
+    if (tail < 0) {
+        flog->tail_sector = flog->head_sector;
+        flog->tail_off = flog->head_off;
+    } else {
+        flog->tail_sector = tail;
+        flog->tail_off = FLOG_SECTOR_HDR;
+    }
+}
+
+/**
+ * @brief Acrescenta um registro ao log.
+ *
+ * O registro é copiado para a página em escrita, na RAM; a flash só é gravada quando a página
+ * enche (uma gravação de 256 bytes a cada poucas amostras) e apagada uma vez a cada setor.
+ *
+ * @param[in] flog    Log iniciado com `mqtt_flog_init`.
+ * @param[in] topic   Handle de `mqtt_topic_register`. A ordem dos registros de tópicos deve ser
+ *                    a mesma entre resets, pois o log guarda o handle.
+ * @param[in] payload Dados a guardar.
+ * @param[in] len     Tamanho de `payload` (até um setor, menos os cabeçalhos).
+ *
+ * @return false se o registro for grande demais ou a flash não puder ser apagada ou gravada;
+ *         o registro é descartado e os anteriores continuam na página em escrita. Conectado,
+ *         também se o próximo setor ainda não foi apagado por `mqtt_flog_poll`.
+ *
+ * @note Não chame no contexto do lwIP nem em interrupções: a gravação usa `flash_safe_execute`.
+ */
+bool mqtt_flog_append(mqtt_flog_t *flog, mqtt_topic_t topic, const void *payload, uint16_t len) {
+    uint32_t size = FLOG_RECORD_HDR + ((len + 3u) & ~3u);
+
+    if (topic < 0 || topic > 0xFF || size > FLASH_SECTOR_SIZE - FLOG_SECTOR_HDR) {
+        flog->stats.dropped++;
+        return false;
+    }
+    if (flog->head_off + size > FLASH_SECTOR_SIZE && !flog_next_sector(flog)) {
+        flog->stats.dropped++;
+        return false;
+    }
+
+    uint16_t start = flog->head_off;
+    flog_record_t rec = { len, (uint8_t)topic, 0, 0 };
+    rec.crc = flog_record_crc(&rec, payload);
+    if (!flog_write(flog, &rec, sizeof(rec)) || !flog_write(flog, payload, len) ||
+        !flog_write(flog, NULL, ((len + 3u) & ~3u) - len)) {
+        flog_abort(flog, start);
+        flog->stats.dropped++;
+        return false;
+    }
+    flog->stats.appended++;
+    return true;
+}
+
+/**
+ * @brief Publica pela fila de publicação ou, sem conexão, guarda no log.
+ *
+ * Enquanto houver registros a reenviar, as novas mensagens também vão para o log, para que
+ * o broker as receba na ordem em que foram geradas.
+ *
+ * @return ERR_OK se a mensagem foi publicada ou guardada, ERR_MEM se foi perdida.
+ */
+err_t mqtt_flog_publish(mqtt_flog_t *flog, mqtt_topic_t topic, const void *payload, uint16_t len) {
+    mqtt_config_t *mqtt = flog->mqtt;
+    bool connected = mqtt->client && mqtt_client_is_connected(mqtt->client);
+
+    if (connected && !mqtt_flog_pending(flog) && mqtt_queue_publish_topic(mqtt, topic, payload, len) == ERR_OK) {
+        return ERR_OK;
+    }
+    return mqtt_flog_append(flog, topic, payload, len) ? ERR_OK : ERR_MEM;
+}
+
+/**
+ * @brief Grava na flash a página em escrita, mesmo incompleta.
+ *
+ * Chame antes de um reset ou do sono profundo. O restante da página continua disponível:
+ * a flash aceita uma nova gravação dos bytes ainda em 0xFF.
+ */
+void mqtt_flog_sync(mqtt_flog_t *flog) {
+    if (!flog_flush(flog) || flog->head_off <= flog->flash_off || flog->head_off >= FLASH_SECTOR_SIZE) {
+        return;
+    }
+    uint32_t page = flog->head_off & ~(FLASH_PAGE_SIZE - 1);
+    if (flog_program(flog, flog->head_sector, page, flog->page)) {
+        flog->flash_off = flog->head_off;
+    }
+}
+
+/**
+ * @brief Indica se há registros no log aguardando reenvio.
+ */
+bool mqtt_flog_pending(const mqtt_flog_t *flog) {
+    return flog->tail_sector != flog->head_sector || flog->tail_off != flog->head_off;
+}
+
+/**
+ * @brief Reenvia o log após a reconexão, com limite de taxa, e mantém o próximo setor apagado.
+ *
+ * Com o cliente conectado, reenvia no máximo um registro a cada `1 / MQTT_FLOG_REPLAY_RATE` s
+ * pela fila de publicação (`mqtt_queue_publish_keep`), e só enquanto a fila estiver abaixo da
+ * metade: o reenvio não disputa espaço com as publicações ao vivo. O próximo setor do anel é
+ * apagado com antecedência, sem conexão ou com a fila de publicação vazia, para que o
+ * apagamento (dezenas de ms com o outro núcleo pausado) não aconteça com publicações em
+ * andamento nem no caminho de `mqtt_flog_append`.
+ *
+ * @param[in] flog Log iniciado com `mqtt_flog_init`.
+ *
+ * @return Quantidade de registros reenviados (0 ou 1).
+ *
+ * @note Chame no laço principal, fora do contexto do lwIP. No modo de dois núcleos, use o log
+ *       no núcleo da rede (em `setup` ou em um worker), pois o reenvio usa a fila de publicação.
+ */
+uint16_t mqtt_flog_poll(mqtt_flog_t *flog) {
+    mqtt_config_t *mqtt = flog->mqtt;
+    bool connected = mqtt->client && mqtt_client_is_connected(mqtt->client);
+
+    if (!connected || mqtt->pub_queue.count == 0) {
+        flog_erase_ahead(flog);
+    }
+    if (!connected) {
+        return 0;
+    }
+    if (!mqtt_flog_pending(flog) || !time_reached(flog->next_replay) ||
+        mqtt->pub_queue.count >= MQTT_PUB_QUEUE_LEN / 2) {
+        return 0;
+    }
+
+    // O reenvio lê da flash: registros ainda na página em escrita são gravados antes
+    if (flog->tail_sector == flog->head_sector && flog->flash_off < flog->head_off) {
+        mqtt_flog_sync(flog);
+        if (flog->flash_off < flog->head_off) {
+            return 0; // página ainda na RAM: nova tentativa no próximo poll
+        }
+    }
+
+    uint16_t end = flog->tail_sector == flog->head_sector ? flog->head_off : FLASH_SECTOR_SIZE;
+    const flog_record_t *rec = (const flog_record_t *)flog_flash(flog->tail_sector, flog->tail_off);
+    uint32_t size = FLOG_RECORD_HDR + ((rec->len + 3u) & ~3u);
+    if (flog->tail_off + FLOG_RECORD_HDR > end || rec->len == 0xFFFF || flog->tail_off + size > end) {
+        if (flog->tail_sector != flog->head_sector) {
+            flog_consume(flog, flog->tail_sector);
+            flog->tail_sector = (flog->tail_sector + 1) % MQTT_FLOG_SECTORS;
+            flog->tail_off = FLOG_SECTOR_HDR;
+        } else {
+            flog->tail_off = flog->head_off;
+        }
+        return 0;
+    }
+
+    const uint8_t *payload = (const uint8_t *)(rec + 1);
+    if (rec->crc != flog_record_crc(rec, payload)) {
+        // O tamanho também pode estar corrompido: o restante do setor é descartado
+        flog->stats.corrupt++;
+        flog->tail_off = end;
+        return 0;
+    }
+    err_t err = mqtt_queue_publish_keep(mqtt, rec->topic, payload, rec->len);
+    if (err == ERR_MEM) {
+        return 0;
+    }
+    if (err != ERR_OK) {
+        flog->stats.corrupt++;
+    }
+    flog->tail_off += size;
+    flog->next_replay = make_timeout_time_ms(1000 / MQTT_FLOG_REPLAY_RATE);
+    flog->stats.replayed++;
+    return 1;
+}
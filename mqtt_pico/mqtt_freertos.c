@@ -0,0 +1,293 @@
+#include "mqtt_pico.h"
+
+/**
+ * @brief Handler das rotas inscritas por `mqtt_rtos_subscribe`: copia a mensagem para a fila
+ *      da inscrição e notifica a tarefa inscrita.
+ *
+ * Executado no contexto do lwIP, por isso nunca bloqueia: com a fila cheia, a mensagem é
+ * descartada. Payloads entregues em fragmentos são truncados no primeiro.
+ */
+static void rtos_route_cb(mqtt_config_t *mqtt, const mqtt_payload_t *payload, void *arg) {
+    mqtt_rtos_sub_t *sub = (mqtt_rtos_sub_t *)arg;
+    mqtt_rtos_msg_t *msg = &sub->rtos->rx;
+
+    if (payload->offset != 0) {
+        return;
+    }
+
+    size_t topic_len = strlen(payload->topic);
+    if (topic_len >= MQTT_RTOS_TOPIC_SIZE) {
+        topic_len = MQTT_RTOS_TOPIC_SIZE - 1;
+    }
+    memcpy(msg->topic, payload->topic, topic_len);
+    msg->topic[topic_len] = '\0';
+
+    msg->tot_len = payload->tot_len;
+    msg->len = payload->len < MQTT_RTOS_MSG_SIZE ? (uint16_t)payload->len : MQTT_RTOS_MSG_SIZE;
+    memcpy(msg->data, payload->data, msg->len);
+    msg->data[msg->len] = '\0';
+
+    if (xQueueSend(sub->queue, msg, 0) == pdTRUE) {
+        sub->received++;
+        xTaskNotify(sub->task, MQTT_RTOS_NOTIFY_RX, eSetBits);
+    } else {
+        sub->dropped++;
+    }
+}
+
+/**
+ * @brief Callback de SUBACK de `mqtt_rtos_subscribe`: acorda a tarefa que pediu a inscrição.
+ */
+static void rtos_suback_cb(void *arg, err_t err) {
+    mqtt_rtos_sub_t *sub = (mqtt_rtos_sub_t *)arg;
+
+    sub->result = err;
+    xTaskNotify(sub->task, MQTT_RTOS_NOTIFY_SUBACK, eSetBits);
+}
+
+/**
+ * @brief Executa um comando na tarefa de rede.
+ */
+static void rtos_run(mqtt_rtos_t *rtos, mqtt_rtos_cmd_t *cmd) {
+    mqtt_config_t *mqtt = rtos->mqtt;
+    const char *filter = (const char *)cmd->data;
+
+    switch (cmd->type) {
+        case MQTT_RTOS_CMD_PUBLISH:
+            mqtt_queue_publish_topic(mqtt, cmd->topic, cmd->data, cmd->len);
+            break;
+
+        case MQTT_RTOS_CMD_SUBSCRIBE: {
+            cyw43_arch_lwip_begin();
+            if (!mqtt_router_add(&mqtt->router, filter, rtos_route_cb, cmd->sub)) {
+                rtos_suback_cb(cmd->sub, ERR_MEM);
+            } else if (!mqtt->client || !mqtt_client_is_connected(mqtt->client)) {
+                // Registrada: a máquina de estados inscreve o filtro na próxima conexão
+                rtos_suback_cb(cmd->sub, ERR_CONN);
+            } else {
+                err_t err = mqtt_sub_unsub(mqtt->client, filter, mqtt->sub_qos, rtos_suback_cb, cmd->sub, 1);
+                if (err != ERR_OK) {
+                    rtos_suback_cb(cmd->sub, err);
+                }
+            }
+            cyw43_arch_lwip_end();
+            break;
+        }
+
+        case MQTT_RTOS_CMD_UNSUBSCRIBE: {
+            mqtt_route_t route = { .filter = filter, .handler = NULL, .arg = NULL };
+            cyw43_arch_lwip_begin();
+            mqtt_manage_routes(mqtt, &route, 1, MQTT_UNSUBSCRIBE, NULL);
+            cyw43_arch_lwip_end();
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Tarefa de rede: inicializa o CYW43 e a rede e executa os comandos das demais tarefas.
+ */
+static void rtos_task(void *arg) {
+    mqtt_rtos_t *rtos = (mqtt_rtos_t *)arg;
+    static mqtt_rtos_cmd_t cmd; // grande demais para a pilha da tarefa; só esta tarefa o usa
+
+    if (cyw43_arch_init() == 0) {
+        rtos->setup(rtos->mqtt, rtos->setup_arg);
+        rtos->ready = true;
+    }
+    xTaskNotifyGive(rtos->starter);
+    if (!rtos->ready) {
+        vTaskDelete(NULL);
+        return;
+    }
+
+    TickType_t wait = MQTT_RTOS_POLL_MS ? pdMS_TO_TICKS(MQTT_RTOS_POLL_MS) : portMAX_DELAY;
+    for (;;) {
+        if (xQueueReceive(rtos->cmds, &cmd, wait) == pdTRUE) {
+            rtos_run(rtos, &cmd);
+        }
+        #if MQTT_RTOS_POLL_MS
+            cyw43_arch_poll();
+        #endif
+    }
+}
+
+/**
+ * @brief Envia um comando à tarefa de rede, esperando até `timeout` por espaço na fila.
+ */
+static err_t rtos_send(mqtt_rtos_t *rtos, mqtt_rtos_cmd_t *cmd, TickType_t timeout) {
+    if (!rtos->ready) {
+        return ERR_CONN;
+    }
+    return xQueueSend(rtos->cmds, cmd, timeout) == pdTRUE ? ERR_OK : ERR_TIMEOUT;
+}
+
+/**
+ * @brief Inicia a variante FreeRTOS: uma tarefa de rede dona do CYW43, do lwIP e do cliente.
+ *
+ * A tarefa de rede chama `cyw43_arch_init` e em seguida `setup`, que deve conectar o Wi-Fi e
+ * chamar `mqtt_start_client`. As demais tarefas publicam e se inscrevem por filas
+ * (`mqtt_rtos_publish`, `mqtt_rtos_subscribe`) e recebem mensagens por filas e notificações
+ * de tarefa: a latência de publicação passa a ser a de acordar a tarefa de rede, e não a de
+ * um superloop com `sleep_ms`.
+ *
+ * Deve ser chamada de uma tarefa, com o escalonador em execução; retorna após `setup`.
+ *
+ * @param[out] rtos     Estado da variante. Deve permanecer válido enquanto o programa rodar.
+ * @param[in]  mqtt     Cliente configurado com `mqtt_config_init`, com os tópicos de publicação
+ *                      já registrados (`mqtt_topic_register`).
+ * @param[in]  setup    Inicialização da rede, executada na tarefa de rede.
+ * @param[in]  arg      Argumento repassado a `setup`.
+ * @param[in]  priority Prioridade da tarefa de rede.
+ *
+ * @return true se a rede foi iniciada, false se não foi possível criar a fila ou a tarefa, ou
+ *         se `cyw43_arch_init` falhar.
+ *
+ * @see mqtt_rtos_publish, mqtt_rtos_subscribe, mqtt_rtos_receive
+ */
+bool mqtt_rtos_start(mqtt_rtos_t *rtos, mqtt_config_t *mqtt, mqtt_net_setup_cb_t setup, void *arg, UBaseType_t priority) {
+    memset(rtos, 0, sizeof(*rtos));
+    rtos->mqtt = mqtt;
+    rtos->setup = setup;
+    rtos->setup_arg = arg;
+    rtos->starter = xTaskGetCurrentTaskHandle();
+
+    rtos->cmds = xQueueCreate(MQTT_RTOS_CMD_LEN, sizeof(mqtt_rtos_cmd_t));
+    if (!rtos->cmds) {
+        return false;
+    }
+    if (xTaskCreate(rtos_task, "mqtt", MQTT_RTOS_TASK_STACK, rtos, priority, &rtos->task) != pdPASS) {
+        vQueueDelete(rtos->cmds);
+        return false;
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return rtos->ready;
+}
+
+/**
+ * @brief Publica uma mensagem a partir de qualquer tarefa.
+ *
+ * O payload é copiado para a fila da tarefa de rede, que o entrega à fila de publicação
+ * (com `mqtt->pub_qos` e `mqtt->retain`).
+ *
+ * @param[in] rtos    Estado iniciado com `mqtt_rtos_start`.
+ * @param[in] topic   Handle de `mqtt_topic_register`.
+ * @param[in] payload Dados a publicar.
+ * @param[in] len     Tamanho de `payload`, até `MQTT_RTOS_MSG_SIZE`.
+ * @param[in] timeout Espera máxima por espaço na fila de comandos (0 = não espera).
+ *
+ * @return ERR_OK se a mensagem foi entregue à tarefa de rede, ERR_VAL se o payload for grande
+ *         demais, ERR_TIMEOUT se a fila continuar cheia e ERR_CONN se a rede não foi iniciada.
+ */
+err_t mqtt_rtos_publish(mqtt_rtos_t *rtos, mqtt_topic_t topic, const void *payload, uint16_t len, TickType_t timeout) {
+    mqtt_rtos_cmd_t cmd;
+
+    if (len > MQTT_RTOS_MSG_SIZE) {
+        return ERR_VAL;
+    }
+    cmd.type = MQTT_RTOS_CMD_PUBLISH;
+    cmd.topic = topic;
+    cmd.len = len;
+    cmd.sub = NULL;
+    memcpy(cmd.data, payload, len);
+    return rtos_send(rtos, &cmd, timeout);
+}
+
+/**
+ * @brief Inscreve um filtro e entrega suas mensagens na fila de `sub`, notificando a tarefa atual.
+ *
+ * A cada mensagem recebida, uma cópia (`mqtt_rtos_msg_t`) entra na fila da inscrição e a tarefa
+ * que chamou esta função recebe o bit `MQTT_RTOS_NOTIFY_RX` (`xTaskNotifyWait`). A função espera
+ * o SUBACK por até `timeout`.
+ *
+ * @param[in]  rtos      Estado iniciado com `mqtt_rtos_start`.
+ * @param[out] sub       Inscrição. Deve permanecer válida enquanto o filtro estiver inscrito.
+ * @param[in]  filter    Filtro de tópico, até `MQTT_RTOS_MSG_SIZE` caracteres (copiado).
+ * @param[in]  queue_len Mensagens que a fila da inscrição comporta.
+ * @param[in]  timeout   Espera máxima pelo envio do comando e pelo SUBACK.
+ *
+ * @return ERR_OK se o broker confirmou a inscrição; ERR_CONN se o cliente estiver desconectado
+ *         (o filtro fica registrado e é inscrito na próxima conexão); ERR_TIMEOUT se o SUBACK
+ *         não chegar a tempo (o filtro também fica registrado); ERR_MEM se o roteador estiver
+ *         cheio ou a fila não puder ser criada; ERR_VAL se o filtro for longo demais.
+ */
+err_t mqtt_rtos_subscribe(mqtt_rtos_t *rtos, mqtt_rtos_sub_t *sub, const char *filter, UBaseType_t queue_len, TickType_t timeout) {
+    mqtt_rtos_cmd_t cmd;
+    size_t len = strlen(filter);
+
+    if (len > MQTT_RTOS_MSG_SIZE) {
+        return ERR_VAL;
+    }
+    memset(sub, 0, sizeof(*sub));
+    sub->rtos = rtos;
+    sub->task = xTaskGetCurrentTaskHandle();
+    sub->result = ERR_INPROGRESS;
+    sub->queue = xQueueCreate(queue_len, sizeof(mqtt_rtos_msg_t));
+    if (!sub->queue) {
+        return ERR_MEM;
+    }
+
+    cmd.type = MQTT_RTOS_CMD_SUBSCRIBE;
+    cmd.topic = MQTT_TOPIC_INVALID;
+    cmd.len = (uint16_t)len;
+    cmd.sub = sub;
+    memcpy(cmd.data, filter, len + 1);
+
+    TickType_t start = xTaskGetTickCount();
+    err_t err = rtos_send(rtos, &cmd, timeout);
+    if (err != ERR_OK) {
+        vQueueDelete(sub->queue);
+        sub->queue = NULL;
+        return err;
+    }
+
+    // Outros bits (mensagens já recebidas) são preservados para o chamador
+    while (sub->result == ERR_INPROGRESS) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout) {
+            return ERR_TIMEOUT;
+        }
+        xTaskNotifyWait(0, MQTT_RTOS_NOTIFY_SUBACK, NULL, timeout - elapsed);
+    }
+    return sub->result;
+}
+
+/**
+ * @brief Remove a inscrição de um filtro inscrito com `mqtt_rtos_subscribe`.
+ *
+ * A fila da inscrição não é destruída: mensagens já entregues continuam disponíveis.
+ *
+ * @param[in] rtos    Estado iniciado com `mqtt_rtos_start`.
+ * @param[in] filter  Filtro usado na inscrição (copiado).
+ * @param[in] timeout Espera máxima por espaço na fila de comandos.
+ *
+ * @return ERR_OK se o comando foi entregue à tarefa de rede, ERR_VAL se o filtro for longo
+ *         demais, ERR_TIMEOUT se a fila continuar cheia.
+ */
+err_t mqtt_rtos_unsubscribe(mqtt_rtos_t *rtos, const char *filter, TickType_t timeout) {
+    mqtt_rtos_cmd_t cmd;
+    size_t len = strlen(filter);
+
+    if (len > MQTT_RTOS_MSG_SIZE) {
+        return ERR_VAL;
+    }
+    cmd.type = MQTT_RTOS_CMD_UNSUBSCRIBE;
+    cmd.topic = MQTT_TOPIC_INVALID;
+    cmd.len = (uint16_t)len;
+    cmd.sub = NULL;
+    memcpy(cmd.data, filter, len + 1);
+    return rtos_send(rtos, &cmd, timeout);
+}
+
+/**
+ * @brief Retira a próxima mensagem da fila de uma inscrição.
+ *
+ * @param[in]  sub     Inscrição de `mqtt_rtos_subscribe`.
+ * @param[out] msg     Mensagem recebida.
+ * @param[in]  timeout Espera máxima por uma mensagem (0 = não espera).
+ *
+ * @return true se uma mensagem foi retirada.
+ */
+bool mqtt_rtos_receive(mqtt_rtos_sub_t *sub, mqtt_rtos_msg_t *msg, TickType_t timeout) {
+    return sub->queue && xQueueReceive(sub->queue, msg, timeout) == pdTRUE;
+}
@@ -0,0 +1,353 @@
+#include "mqtt_pico.h"
+
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+
+#define MQTT_METRICS_SNAPSHOT_LEN (59 + 3 * MQTT_METRICS_HIST_LEN * 2) // ver mqtt_metrics_snapshot
+
+#define MQTT_MSG_PINGRESP 13 // tipo do pacote PINGRESP no cabeçalho fixo
+
+static void metrics_put16(uint8_t *p, uint32_t value) {
+    if (value > 0xFFFF) {
+        value = 0xFFFF;
+    }
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void metrics_put32(uint8_t *p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+/**
+ * @brief Faixa do histograma para uma latência: potências de 2 em ms.
+ */
+static uint8_t metrics_bucket(uint32_t latency_us) {
+    uint32_t ms = latency_us / 1000;
+    uint8_t bucket = 0;
+    while (ms) {
+        bucket++;
+        ms >>= 1;
+    }
+    return bucket < MQTT_METRICS_HIST_LEN ? bucket : MQTT_METRICS_HIST_LEN - 1;
+}
+
+/**
+ * @brief Registra a chegada de um PINGRESP.
+ */
+static void metrics_pingresp(mqtt_metrics_t *m) {
+    if (!m->ping_pending) {
+        return; // resposta a um PINGREQ de keep alive do próprio lwIP
+    }
+    m->ping_pending = false;
+    m->pongs++;
+
+    uint32_t rtt_us = (uint32_t)to_us_since_boot(get_absolute_time()) - m->ping_sent_us;
+    uint16_t rtt_ms = rtt_us / 1000 > 0xFFFF ? 0xFFFF : (uint16_t)(rtt_us / 1000);
+    m->rtt_last_ms = rtt_ms;
+    if (m->pongs == 1 || rtt_ms < m->rtt_min_ms) {
+        m->rtt_min_ms = rtt_ms;
+    }
+    if (rtt_ms > m->rtt_max_ms) {
+        m->rtt_max_ms = rtt_ms;
+    }
+}
+
+/**
+ * @brief Acompanha os limites dos pacotes MQTT recebidos, sem copiá-los.
+ *
+ * Lê apenas o cabeçalho fixo (tipo e tamanho restante) de cada pacote e pula o restante.
+ */
+static void metrics_scan(mqtt_metrics_t *m, const uint8_t *data, uint16_t len) {
+    while (len) {
+        if (m->rx_skip) {
+            uint32_t n = m->rx_skip < len ? m->rx_skip : len;
+            data += n;
+            len -= n;
+            m->rx_skip -= n;
+            continue;
+        }
+
+        uint8_t b = *data++;
+        len--;
+        if (!m->rx_in_len) {
+            m->rx_type = b >> 4;
+            m->rx_in_len = true;
+            m->rx_len = 0;
+            m->rx_shift = 0;
+            continue;
+        }
+
+        m->rx_len |= (uint32_t)(b & 0x7F) << m->rx_shift;
+        m->rx_shift += 7;
+        if ((b & 0x80) == 0 || m->rx_shift >= 28) {
+            m->rx_in_len = false;
+            m->rx_skip = m->rx_len;
+            if (m->rx_type == MQTT_MSG_PINGRESP) {
+                metrics_pingresp(m);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Callback de recepção instalado na conexão: inspeciona os pacotes e repassa ao lwIP.
+ *
+ * Na conexão recém-aceita, a inspeção só começa quando o lwIP está no início de um pacote
+ * (`mqtt_lwip_rx_at_packet_start`), para que os dois acompanhem os mesmos limites.
+ */
+static err_t metrics_recv(void *arg, struct altcp_pcb *conn, struct pbuf *p, err_t err) {
+    mqtt_client_t *client = (mqtt_client_t *)arg;
+    mqtt_config_t *mqtt = (mqtt_config_t *)client->connect_arg;
+    mqtt_metrics_t *m = &mqtt->metrics;
+
+    if (p && err == ERR_OK) {
+        if (m->rx_skip == UINT32_MAX && mqtt_lwip_rx_at_packet_start(client)) {
+            m->rx_skip = 0;
+            m->rx_in_len = false;
+        }
+        if (m->rx_skip != UINT32_MAX) {
+            for (struct pbuf *q = p; q; q = q->next) {
+                metrics_scan(m, (const uint8_t *)q->payload, q->len);
+            }
+        }
+    }
+    return m->recv(arg, conn, p, err);
+}
+
+/**
+ * @brief Envia um PINGREQ próprio para medir o tempo de ida e volta até o broker.
+ */
+static void metrics_ping(mqtt_config_t *mqtt) {
+    mqtt_metrics_t *m = &mqtt->metrics;
+
+    m->ping_pending = false; // sem resposta em um período inteiro: considerado perdido
+    if (m->recv == NULL || !mqtt_lwip_send_pingreq(mqtt->client)) {
+        return;
+    }
+    m->ping_sent_us = (uint32_t)to_us_since_boot(get_absolute_time());
+    m->ping_pending = true;
+    m->pings++;
+}
+
+/**
+ * @brief Zera as medições que cobrem apenas o intervalo entre snapshots.
+ */
+static void metrics_reset_interval(mqtt_metrics_t *m) {
+    memset(m->pub_hist, 0, sizeof(m->pub_hist));
+    m->pings = 0;
+    m->pongs = 0;
+    m->rtt_min_ms = 0;
+    m->rtt_max_ms = 0;
+}
+
+/**
+ * @brief Worker dos snapshots: publica as métricas, reinicia o intervalo e mede o PINGREQ.
+ */
+static void metrics_timer(async_context_t *context, async_at_time_worker_t *worker) {
+    mqtt_config_t *mqtt = (mqtt_config_t *)worker->user_data;
+    mqtt_metrics_t *m = &mqtt->metrics;
+
+    if (mqtt->conn.state == MQTT_STATE_RUNNING) {
+        uint8_t buf[MQTT_METRICS_SNAPSHOT_LEN];
+        uint16_t len = mqtt_metrics_snapshot(mqtt, buf, sizeof(buf));
+        if (len && mqtt_queue_publish_keep(mqtt, m->topic, buf, len) == ERR_OK) {
+            m->snapshots++;
+            metrics_reset_interval(m);
+        }
+        metrics_ping(mqtt);
+    }
+
+    if (m->period_ms) {
+        async_context_add_at_time_worker_in_ms(context, worker, m->period_ms);
+    }
+}
+
+/**
+ * @brief Inicia a publicação periódica das métricas do cliente e da rede.
+ *
+ * A cada `period_ms`, com o cliente conectado, publica um snapshot binário (ver
+ * `mqtt_metrics_snapshot`) no tópico `name` pela fila de publicação, e em seguida envia um
+ * PINGREQ para medir o tempo de ida e volta até o broker. Use um período longo (dezenas de
+ * segundos ou mais): as métricas servem ao diagnóstico e não devem competir com a telemetria.
+ *
+ * @param[in] mqtt      Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in] name      Nome do tópico, registrado com `mqtt_topic_register`. NULL usa
+ *                      `MQTT_METRICS_TOPIC`. Com `unique_topic` desativado, use um nome por dispositivo.
+ * @param[in] period_ms Intervalo entre snapshots. Deve ser maior que zero.
+ *
+ * @return true se as métricas foram iniciadas, false se o tópico não pôde ser registrado.
+ *
+ * @note Os contadores de memória do lwIP exigem `MEM_STATS` e `MEMP_STATS`; sem eles, os campos
+ *       correspondentes do snapshot são zero.
+ *
+ * @see mqtt_metrics_stop, mqtt_metrics_snapshot
+ */
+bool mqtt_metrics_start(mqtt_config_t *mqtt, const char *name, uint32_t period_ms) {
+    mqtt_metrics_t *m = &mqtt->metrics;
+
+    if (period_ms == 0) {
+        return false;
+    }
+    mqtt_topic_t topic = mqtt_topic_register(mqtt, name ? name : MQTT_METRICS_TOPIC);
+    if (topic == MQTT_TOPIC_INVALID) {
+        return false;
+    }
+
+    cyw43_arch_lwip_begin();
+    async_context_remove_at_time_worker(cyw43_arch_async_context(), &m->timer);
+    m->topic = topic;
+    m->period_ms = period_ms;
+    m->timer.do_work = metrics_timer;
+    m->timer.user_data = mqtt;
+    metrics_reset_interval(m);
+    async_context_add_at_time_worker_in_ms(cyw43_arch_async_context(), &m->timer, period_ms);
+    if (mqtt->client && mqtt_client_is_connected(mqtt->client)) {
+        mqtt_metrics_attach(mqtt);
+    }
+    cyw43_arch_lwip_end();
+    return true;
+}
+
+/**
+ * @brief Interrompe a publicação periódica das métricas.
+ *
+ * Os contadores continuam sendo atualizados e podem ser lidos com `mqtt_metrics_snapshot`.
+ *
+ * @param[in] mqtt Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ */
+void mqtt_metrics_stop(mqtt_config_t *mqtt) {
+    cyw43_arch_lwip_begin();
+    mqtt->metrics.period_ms = 0;
+    async_context_remove_at_time_worker(cyw43_arch_async_context(), &mqtt->metrics.timer);
+    cyw43_arch_lwip_end();
+}
+
+/**
+ * @brief Serializa as métricas atuais no formato binário publicado.
+ *
+ * Todos os campos são little-endian; contadores de 16 bits saturam em 0xFFFF.
+ *
+ * | Offset | Bytes | Campo                                                        |
+ * |-------:|------:|--------------------------------------------------------------|
+ * |      0 |     1 | Versão do formato (`MQTT_METRICS_VERSION`)                   |
+ * |      1 |     1 | Faixas por histograma (`MQTT_METRICS_HIST_LEN`)              |
+ * |      2 |     4 | Tempo desde o boot (ms)                                      |
+ * |      6 |     4 | Snapshots publicados antes deste                             |
+ * |     10 |     4 | Conexões aceitas                                             |
+ * |     14 |     4 | Reconexões                                                   |
+ * |     18 |     4 | Publicações concluídas                                       |
+ * |     22 |     4 | Publicações com erro                                         |
+ * |     26 |     4 | Publicações descartadas pela fila                            |
+ * |     30 |     1 | Maior quantidade de publicações em andamento                 |
+ * |     31 |     1 | Maior quantidade de mensagens na fila                        |
+ * |     32 |     2 | PINGREQs enviados no intervalo                               |
+ * |     34 |     2 | PINGRESPs recebidos no intervalo                             |
+ * |     36 |     6 | Ida e volta do PINGREQ: último, mínimo e máximo (ms)         |
+ * |     42 |     6 | Heap do lwIP: em uso, pico e falhas                          |
+ * |     48 |     6 | Pool de pbufs: em uso, pico e falhas                         |
+ * |     54 |     4 | Segmentos TCP: em uso e pico                                 |
+ * |     58 |     1 | RSSI do Wi-Fi (dBm, com sinal; 0 se indisponível)            |
+ * |     59 |     … | Histogramas de latência das publicações no intervalo, QoS 0, |
+ * |        |       | 1 e 2, com `MQTT_METRICS_HIST_LEN` contadores de 2 bytes cada |
+ *
+ * @param[in]  mqtt Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[out] buf  Buffer de saída.
+ * @param[in]  size Tamanho de `buf`.
+ *
+ * @return Bytes escritos, ou 0 se `buf` for menor que o snapshot.
+ */
+uint16_t mqtt_metrics_snapshot(mqtt_config_t *mqtt, uint8_t *buf, uint16_t size) {
+    const mqtt_metrics_t *m = &mqtt->metrics;
+    const mqtt_pub_stats_t *q = &mqtt->pub_queue.stats;
+
+    if (size < MQTT_METRICS_SNAPSHOT_LEN) {
+        return 0;
+    }
+    memset(buf, 0, MQTT_METRICS_SNAPSHOT_LEN);
+
+    buf[0] = MQTT_METRICS_VERSION;
+    buf[1] = MQTT_METRICS_HIST_LEN;
+    metrics_put32(&buf[2], to_ms_since_boot(get_absolute_time()));
+    metrics_put32(&buf[6], m->snapshots);
+    metrics_put32(&buf[10], mqtt->conn.sessions);
+    metrics_put32(&buf[14], mqtt->conn.reconnects);
+    metrics_put32(&buf[18], q->completed);
+    metrics_put32(&buf[22], q->failed);
+    metrics_put32(&buf[26], q->dropped);
+    buf[30] = q->in_flight_high_water;
+    buf[31] = q->high_water;
+    metrics_put16(&buf[32], m->pings);
+    metrics_put16(&buf[34], m->pongs);
+    metrics_put16(&buf[36], m->rtt_last_ms);
+    metrics_put16(&buf[38], m->rtt_min_ms);
+    metrics_put16(&buf[40], m->rtt_max_ms);
+    #if LWIP_STATS && MEM_STATS
+        metrics_put16(&buf[42], lwip_stats.mem.used);
+        metrics_put16(&buf[44], lwip_stats.mem.max);
+        metrics_put16(&buf[46], lwip_stats.mem.err);
+    #endif
+    #if LWIP_STATS && MEMP_STATS
+        metrics_put16(&buf[48], lwip_stats.memp[MEMP_PBUF_POOL]->used);
+        metrics_put16(&buf[50], lwip_stats.memp[MEMP_PBUF_POOL]->max);
+        metrics_put16(&buf[52], lwip_stats.memp[MEMP_PBUF_POOL]->err);
+        metrics_put16(&buf[54], lwip_stats.memp[MEMP_TCP_SEG]->used);
+        metrics_put16(&buf[56], lwip_stats.memp[MEMP_TCP_SEG]->max);
+    #endif
+
+    int32_t rssi = 0;
+    if (cyw43_wifi_get_rssi(&cyw43_state, &rssi) == 0 && rssi >= INT8_MIN && rssi <= INT8_MAX) {
+        buf[58] = (uint8_t)(int8_t)rssi;
+    }
+
+    uint8_t *hist = &buf[59];
+    for (uint8_t qos = 0; qos < 3; qos++) {
+        for (uint8_t i = 0; i < MQTT_METRICS_HIST_LEN; i++) {
+            metrics_put16(hist, m->pub_hist[qos][i]);
+            hist += 2;
+        }
+    }
+    return MQTT_METRICS_SNAPSHOT_LEN;
+}
+
+/**
+ * @brief Instala a inspeção dos pacotes recebidos na conexão recém-aceita.
+ *
+ * Chamada pela máquina de estados a cada CONNACK aceito, no contexto do lwIP, pois o
+ * lwIP redefine o callback de recepção a cada nova conexão TCP. Sem métricas ativas
+ * (`mqtt_metrics_start`), não faz nada.
+ *
+ * @param[in] mqtt Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ */
+void mqtt_metrics_attach(mqtt_config_t *mqtt) {
+    mqtt_metrics_t *m = &mqtt->metrics;
+
+    if (m->period_ms == 0 || !mqtt_lwip_hook_recv(mqtt->client, metrics_recv, &m->recv)) {
+        return;
+    }
+    m->rx_skip = UINT32_MAX; // aguardando o início de um pacote
+    m->ping_pending = false;
+}
+
+/**
+ * @brief Registra a latência de uma publicação concluída com sucesso.
+ *
+ * Chamada pela fila de publicação: a latência vai da entrega ao lwIP até o callback de
+ * conclusão (ACK do TCP no QoS 0, PUBACK no QoS 1 e PUBCOMP no QoS 2).
+ *
+ * @param[in] mqtt       Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in] qos        QoS da publicação.
+ * @param[in] latency_us Latência em microssegundos.
+ */
+void mqtt_metrics_pub_done(mqtt_config_t *mqtt, uint8_t qos, uint32_t latency_us) {
+    if (qos > 2) {
+        return;
+    }
+    uint16_t *count = &mqtt->metrics.pub_hist[qos][metrics_bucket(latency_us)];
+    if (*count < 0xFFFF) {
+        (*count)++;
+    }
+}
@@ -1,103 +1,899 @@
 #include "mqtt_pico.h"
 
+#include "lwip/init.h"
+
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+#include "mbedtls/ssl.h"
+#endif
+
+#if LWIP_ALTCP && LWIP_ALTCP_TLS && defined(MQTT_CERT_INC)
+// Certificados em flash: declarados const no escopo do arquivo, não são copiados para a pilha
+static const uint8_t mqtt_ca_cert[] = TLS_ROOT_CERT;
+static const uint8_t mqtt_client_key[] = TLS_CLIENT_KEY;
+static const uint8_t mqtt_client_cert[] = TLS_CLIENT_CERT;
+#endif
+
+/**
+ * @brief Inicializa a estrutura de configuração MQTT com valores padrão.
+ *
+ * Zera todos os campos (contadores, flags e estados de recepção). Deve ser chamada
+ * antes de preencher `client_info` e demais opções.
+ *
+ * @param[out] mqtt Ponteiro para a estrutura de configuração MQTT. Não deve ser NULL.
+ *
+ * @note A estrutura contém a arena de recepção (`MQTT_PAYLOAD_ARENA_SIZE` bytes); prefira
+ *       alocá-la estaticamente em vez de na pilha.
+ */
+void mqtt_config_init(mqtt_config_t *mqtt) {
+    memset(mqtt, 0, sizeof(*mqtt));
+    mqtt->rx.mode = MQTT_PAYLOAD_ASSEMBLE;
+    mqtt_router_init(&mqtt->router);
+    mqtt->tls.resume = true;
+    mqtt->session.clean = true;
+}
+
+/*
+ * Acesso aos campos internos do cliente MQTT do lwIP (mqtt_priv.h).
+ *
+ * A API pública do lwIP não expõe o PINGRESP, o buffer de saída, as requisições pendentes, a
+ * sequência de IDs de pacote nem o contador do keep alive. As métricas, o agendador de energia
+ * e a sessão persistente precisam deles; o acesso fica restrito às funções
+ * mqtt_lwip_*, escritas para o layout de `struct mqtt_client_s` e das estruturas privadas de
+ * altcp_tls_mbedtls.c das versões 2.1 e 2.2 (a do Pico SDK). Ao atualizar o lwIP, revise estas
+ * funções e amplie a verificação abaixo.
+ */
+#if LWIP_VERSION_MAJOR != 2 || LWIP_VERSION_MINOR < 1 || LWIP_VERSION_MINOR > 2
+#error "mqtt_pico: campos internos do cliente MQTT verificados apenas no lwIP 2.1 e 2.2; revise mqtt_lwip_*"
+#endif
+
+#define MQTT_LWIP_PKT_PUBLISH    0x30 // PUBLISH no cabeçalho fixo
+#define MQTT_LWIP_PKT_PUBREL     0x62 // PUBREL, com os flags reservados 0010
+#define MQTT_LWIP_PKT_SUBSCRIBE  0x82 // SUBSCRIBE, com os flags reservados 0010
+#define MQTT_LWIP_PKT_UNSUBSCRIBE 0xA2 // UNSUBSCRIBE, com os flags reservados 0010
+#define MQTT_LWIP_FIXED_DUP      0x08 // bit DUP no cabeçalho fixo do PUBLISH
+#define MQTT_LWIP_CONNECT_CLEAN  0x02 // bit clean session nos flags do CONNECT
+
+/**
+ * @brief Indica se o buffer de saída do cliente está vazio (todo pacote já foi entregue ao TCP).
+ */
+bool mqtt_lwip_output_empty(const mqtt_client_t *client) {
+    return client->output.put == client->output.get;
+}
+
+/**
+ * @brief Indica se o lwIP está no início de um pacote recebido (nenhum pacote pela metade).
+ */
+bool mqtt_lwip_rx_at_packet_start(const mqtt_client_t *client) {
+    return client->msg_idx == 0;
+}
+
+/**
+ * @brief Tempo até o lwIP enviar o próprio PINGREQ de keep alive.
+ *
+ * @return Milissegundos restantes, ou UINT32_MAX se o keep alive estiver desativado.
+ */
+uint32_t mqtt_lwip_keepalive_left_ms(const mqtt_client_t *client) {
+    if (client->keep_alive == 0) {
+        return UINT32_MAX;
+    }
+    // `cyclic_tick` conta períodos de MQTT_CYCLIC_TIMER_INTERVAL s desde o último envio
+    uint32_t idle_ms = (uint32_t)client->cyclic_tick * MQTT_CYCLIC_TIMER_INTERVAL * 1000u;
+    uint32_t keep_alive_ms = (uint32_t)client->keep_alive * 1000u;
+    return idle_ms < keep_alive_ms ? keep_alive_ms - idle_ms : 0;
+}
+
+/**
+ * @brief Envia um PINGREQ fora do buffer de saída do lwIP.
+ *
+ * O lwIP não permite enfileirar um PINGREQ pela API pública. Os 2 bytes são escritos direto
+ * na conexão, e só com o buffer de saída vazio, para não se intercalarem com um pacote ainda
+ * não enviado. Como faz o envio do lwIP, zera o contador do keep alive.
+ *
+ * @return true se o PINGREQ foi entregue ao TCP.
+ */
+bool mqtt_lwip_send_pingreq(mqtt_client_t *client) {
+    static const uint8_t pingreq[2] = {0xC0, 0x00};
+
+    if (!client->conn || !mqtt_lwip_output_empty(client) || altcp_sndbuf(client->conn) < sizeof(pingreq)) {
+        return false;
+    }
+    if (altcp_write(client->conn, pingreq, sizeof(pingreq), TCP_WRITE_FLAG_COPY) != ERR_OK) {
+        return false;
+    }
+    altcp_output(client->conn);
+    client->cyclic_tick = 0;
+    return true;
+}
+
+/**
+ * @brief Instala `hook` como callback de recepção da conexão, antes do callback do lwIP.
+ *
+ * O lwIP redefine o callback a cada nova conexão TCP; chame após cada CONNACK. O hook deve
+ * repassar todos os pbufs para `*next`.
+ *
+ * @param[out] next Callback original do lwIP.
+ *
+ * @return false se não houver conexão ou se o hook já estiver instalado.
+ */
+bool mqtt_lwip_hook_recv(mqtt_client_t *client, altcp_recv_fn hook, altcp_recv_fn *next) {
+    struct altcp_pcb *conn = client->conn;
+
+    if (!conn || conn->recv == hook) {
+        return false;
+    }
+    *next = conn->recv;
+    altcp_recv(conn, hook);
+    return true;
+}
+
+/**
+ * @brief Último ID de pacote gerado pelo lwIP (o da publicação QoS 1/2 mais recente).
+ */
+uint16_t mqtt_lwip_pkt_id_seq(const mqtt_client_t *client) {
+    return client->pkt_id_seq;
+}
+
+/**
+ * @brief Restaura a sequência de IDs de pacote, que `mqtt_client_connect` zera.
+ */
+void mqtt_lwip_set_pkt_id_seq(mqtt_client_t *client, uint16_t pkt_id_seq) {
+    client->pkt_id_seq = pkt_id_seq;
+}
+
+/**
+ * @brief ID de pacote da publicação recebida em andamento (0 no QoS 0).
+ */
+uint16_t mqtt_lwip_inpub_pkt_id(const mqtt_client_t *client) {
+    return client->inpub_pkt_id;
+}
+
+/**
+ * @brief Indica se a publicação recebida em andamento tem o flag DUP.
+ *
+ * O lwIP mantém o cabeçalho fixo do pacote no início de `rx_buffer` até o fim da publicação.
+ */
+bool mqtt_lwip_inpub_dup(const mqtt_client_t *client) {
+    return (client->rx_buffer[0] & MQTT_LWIP_FIXED_DUP) != 0;
+}
+
+/**
+ * @brief Byte `offset` do buffer de saída, contado a partir do primeiro ainda não enviado.
+ */
+static uint8_t *mqtt_lwip_output_at(mqtt_client_t *client, uint16_t offset) {
+    return &client->output.buf[(client->output.get + offset) % MQTT_OUTPUT_RINGBUF_SIZE];
+}
+
+/**
+ * @brief Bytes ocupados no buffer de saída, como `mqtt_ringbuf_len` do lwIP.
+ */
+static uint16_t mqtt_lwip_output_len(const mqtt_client_t *client) {
+    const struct mqtt_ringbuf_t *rb = &client->output;
+    return rb->put >= rb->get ? rb->put - rb->get : MQTT_OUTPUT_RINGBUF_SIZE - rb->get + rb->put;
+}
+
+/**
+ * @brief Bytes livres no buffer de saída: o maior pacote que pode ser enfileirado agora.
+ */
+uint16_t mqtt_lwip_output_free(const mqtt_client_t *client) {
+    return MQTT_OUTPUT_RINGBUF_SIZE - mqtt_lwip_output_len(client);
+}
+
+/**
+ * @brief Desliga o flag clean session do CONNECT que `mqtt_client_connect` deixou no buffer de saída.
+ *
+ * O lwIP sempre envia clean session; o CONNECT só é transmitido quando o TCP conecta, então
+ * ainda pode ser corrigido logo após `mqtt_client_connect`.
+ *
+ * @return false se o início do buffer de saída não for um CONNECT do MQTT 3.1.1.
+ */
+bool mqtt_lwip_connect_keep_session(mqtt_client_t *client) {
+    static const uint8_t protocol[6] = {0x00, 0x04, 'M', 'Q', 'T', 'T'};
+
+    // CONNECT: tipo, tamanho restante (1 a 4 bytes), "\0\4MQTT", nível do protocolo, flags
+    uint16_t i = 1;
+    while (i < 4 && (*mqtt_lwip_output_at(client, i) & 0x80)) {
+        i++;
+    }
+    i++;
+    if ((*mqtt_lwip_output_at(client, 0) & 0xF0) != 0x10 || mqtt_lwip_output_len(client) < i + 8) {
+        return false;
+    }
+    for (uint8_t k = 0; k < sizeof(protocol); k++) {
+        if (*mqtt_lwip_output_at(client, i + k) != protocol[k]) {
+            return false;
+        }
+    }
+    *mqtt_lwip_output_at(client, i + 7) &= (uint8_t)~MQTT_LWIP_CONNECT_CLEAN;
+    return true;
+}
+
+/**
+ * @brief Copia `len` bytes para o buffer de saída, como `mqtt_output_append_buf` do lwIP.
+ */
+static void mqtt_lwip_output_put(mqtt_client_t *client, const void *data, uint16_t len) {
+    struct mqtt_ringbuf_t *rb = &client->output;
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    for (uint16_t i = 0; i < len; i++) {
+        rb->buf[rb->put] = bytes[i];
+        if (++rb->put >= MQTT_OUTPUT_RINGBUF_SIZE) {
+            rb->put = 0;
+        }
+    }
+}
+
+/**
+ * @brief Entrega ao TCP o que couber do buffer de saída, como `mqtt_output_send` do lwIP.
+ *
+ * O restante segue pelo callback de envio do lwIP, a cada ACK do TCP.
+ */
+static void mqtt_lwip_output_send(mqtt_client_t *client) {
+    struct mqtt_ringbuf_t *rb = &client->output;
+    uint16_t linear = rb->put >= rb->get ? rb->put - rb->get : MQTT_OUTPUT_RINGBUF_SIZE - rb->get;
+    uint16_t send_len = altcp_sndbuf(client->conn);
+    bool wrap = false;
+
+    if (send_len == 0 || linear == 0) {
+        return;
+    }
+    if (send_len > linear) {
+        send_len = linear;
+        wrap = mqtt_lwip_output_len(client) > linear;
+    }
+    err_t err = altcp_write(client->conn, &rb->buf[rb->get], send_len,
+                            TCP_WRITE_FLAG_COPY | (wrap ? TCP_WRITE_FLAG_MORE : 0));
+    if (err == ERR_OK && wrap) {
+        rb->get = (rb->get + send_len) % MQTT_OUTPUT_RINGBUF_SIZE;
+        send_len = altcp_sndbuf(client->conn);
+        if (send_len > rb->put - rb->get) {
+            send_len = rb->put - rb->get;
+        }
+        err = altcp_write(client->conn, &rb->buf[rb->get], send_len, TCP_WRITE_FLAG_COPY);
+    }
+    if (err == ERR_OK) {
+        rb->get = (rb->get + send_len) % MQTT_OUTPUT_RINGBUF_SIZE;
+        altcp_output(client->conn);
+    }
+}
+
+/**
+ * @brief Enfileira um pacote com ID e registra a requisição que aguarda sua confirmação.
+ *
+ * Faz o que `mqtt_publish`/`mqtt_sub_unsub` fazem com as funções estáticas de mqtt.c: ocupa
+ * uma vaga de `req_list` (uma vaga livre aponta para si mesma), escreve o pacote no buffer de
+ * saída e acrescenta a requisição a `pend_req_queue`, cujo timeout é relativo à anterior.
+ * Assim o lwIP casa a confirmação pelo ID e aplica `MQTT_REQ_TIMEOUT`. Como no envio do lwIP,
+ * zera o contador do keep alive.
+ *
+ * @param[in] header  Primeiro byte do cabeçalho fixo (tipo e flags).
+ * @param[in] topic   Tópico do PUBLISH, escrito antes do ID, ou NULL.
+ * @param[in] payload Restante do pacote, após o ID.
+ *
+ * @return ERR_OK, ERR_CONN sem conexão, ERR_MEM sem vaga de requisição ou espaço de saída.
+ */
+static err_t mqtt_lwip_request(mqtt_client_t *client, uint8_t header, const char *topic, uint16_t pkt_id,
+                               const void *payload, uint16_t len, mqtt_request_cb_t cb, void *arg) {
+    if (!mqtt_client_is_connected(client)) {
+        return ERR_CONN;
+    }
+
+    size_t topic_len = topic ? strlen(topic) : 0;
+    uint32_t remaining = (topic ? 2 + topic_len : 0) + 2 + len;
+    uint8_t fixed[5] = {header};
+    uint8_t fixed_len = 1;
+    do {
+        uint8_t b = remaining & 0x7F;
+        remaining >>= 7;
+        fixed[fixed_len++] = remaining ? b | 0x80 : b;
+    } while (remaining && fixed_len < sizeof(fixed));
+    uint32_t total = fixed_len + (topic ? 2 + topic_len : 0) + 2 + len;
+    if (remaining || total > (uint32_t)(MQTT_OUTPUT_RINGBUF_SIZE - mqtt_lwip_output_len(client))) {
+        return ERR_MEM;
+    }
+
+    struct mqtt_request_t *r = NULL;
+    for (uint8_t i = 0; i < MQTT_REQ_MAX_IN_FLIGHT; i++) {
+        if (client->req_list[i].next == &client->req_list[i]) {
+            r = &client->req_list[i];
+            break;
+        }
+    }
+    if (!r) {
+        return ERR_MEM;
+    }
+
+    uint8_t id[2] = {(uint8_t)(pkt_id >> 8), (uint8_t)pkt_id};
+    mqtt_lwip_output_put(client, fixed, fixed_len);
+    if (topic) {
+        uint8_t topic_size[2] = {(uint8_t)(topic_len >> 8), (uint8_t)topic_len};
+        mqtt_lwip_output_put(client, topic_size, sizeof(topic_size));
+        mqtt_lwip_output_put(client, topic, (uint16_t)topic_len);
+    }
+    mqtt_lwip_output_put(client, id, sizeof(id));
+    mqtt_lwip_output_put(client, payload, len);
+
+    struct mqtt_request_t *tail = NULL;
+    int16_t time_before = 0;
+    for (struct mqtt_request_t *iter = client->pend_req_queue; iter; iter = iter->next) {
+        time_before += iter->timeout_diff;
+        tail = iter;
+    }
+    r->next = NULL;
+    r->cb = cb;
+    r->arg = arg;
+    r->pkt_id = pkt_id;
+    r->timeout_diff = MQTT_REQ_TIMEOUT - time_before;
+    if (tail) {
+        tail->next = r;
+    } else {
+        client->pend_req_queue = r;
+    }
+
+    mqtt_lwip_output_send(client);
+    client->cyclic_tick = 0;
+    return ERR_OK;
+}
+
+/**
+ * @brief Reenvia uma publicação QoS 1/2 com o ID original e o flag DUP (MQTT-3.3.1-1).
+ *
+ * `mqtt_publish` sempre gera um ID novo e não marca DUP. `cb` é chamado no PUBACK/PUBCOMP ou
+ * no timeout, como em `mqtt_publish`.
+ */
+err_t mqtt_lwip_publish_dup(mqtt_client_t *client, const char *topic, const void *payload, uint16_t len,
+                            uint8_t qos, bool retain, uint16_t pkt_id, mqtt_request_cb_t cb, void *arg) {
+    uint8_t header = MQTT_LWIP_PKT_PUBLISH | MQTT_LWIP_FIXED_DUP | (uint8_t)((qos & 3) << 1) | (retain ? 1 : 0);
+    return mqtt_lwip_request(client, header, topic, pkt_id, payload, len, cb, arg);
+}
+
+/**
+ * @brief Reenvia o PUBREL de uma publicação QoS 2 cujo PUBREC já chegou (MQTT-4.4.0-1).
+ *
+ * O lwIP só envia PUBREL em resposta a um PUBREC. `cb` é chamado no PUBCOMP ou no timeout.
+ */
+err_t mqtt_lwip_pubrel(mqtt_client_t *client, uint16_t pkt_id, mqtt_request_cb_t cb, void *arg) {
+    return mqtt_lwip_request(client, MQTT_LWIP_PKT_PUBREL, NULL, pkt_id, NULL, 0, cb, arg);
+}
+
+/**
+ * @brief Enfileira um SUBSCRIBE/UNSUBSCRIBE com vários filtros e um ID de pacote novo.
+ *
+ * `mqtt_sub_unsub` envia um filtro por pacote. `cb` é chamado no SUBACK/UNSUBACK (com o
+ * resultado do primeiro filtro, como no lwIP) ou no timeout.
+ *
+ * @param[in]  filters Filtros já codificados (tamanho, texto e, no SUBSCRIBE, QoS).
+ * @param[out] pkt_id  ID de pacote usado, para casar o SUBACK.
+ */
+err_t mqtt_lwip_sub_unsub(mqtt_client_t *client, bool subscribe, const void *filters, uint16_t len,
+                          mqtt_request_cb_t cb, void *arg, uint16_t *pkt_id) {
+    // Como msg_generate_packet_id do lwIP: a sequência pula o 0
+    uint16_t id = client->pkt_id_seq + 1;
+    if (id == 0) {
+        id = 1;
+    }
+    err_t err = mqtt_lwip_request(client, subscribe ? MQTT_LWIP_PKT_SUBSCRIBE : MQTT_LWIP_PKT_UNSUBSCRIBE,
+                                  NULL, id, filters, len, cb, arg);
+    if (err == ERR_OK) {
+        client->pkt_id_seq = id;
+        *pkt_id = id;
+    }
+    return err;
+}
+
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+/**
+ * @brief Configuração do mbedTLS de uma configuração TLS do lwIP.
+ *
+ * `struct altcp_tls_config` é privada de altcp_tls_mbedtls.c; nas versões 2.1 e 2.2 a
+ * configuração do mbedTLS é o seu primeiro campo.
+ */
+static mbedtls_ssl_config *mqtt_lwip_tls_ssl_config(struct altcp_tls_config *config) {
+    return (mbedtls_ssl_config *)config;
+}
+
+/**
+ * @brief Sessão do mbedTLS de uma sessão TLS do lwIP.
+ *
+ * `struct altcp_tls_session` é privada de altcp_tls_mbedtls.c e tem um único membro, a
+ * mbedtls_ssl_session.
+ */
+mbedtls_ssl_session *mqtt_lwip_tls_session(struct altcp_tls_session *session) {
+    return (mbedtls_ssl_session *)session;
+}
+#endif
+
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+#if defined(MBEDTLS_PLATFORM_MEMORY) && !(defined(MBEDTLS_PLATFORM_CALLOC_MACRO) && defined(MBEDTLS_PLATFORM_FREE_MACRO))
+// Sem as duas macros, altcp_tls_create_config passa as alocações do mbedTLS para o heap do
+// lwIP (MEM_SIZE), onde o buffer de recepção de 16 KB não cabe e todo handshake falha
+#error "mqtt_pico: com MBEDTLS_PLATFORM_MEMORY, defina MBEDTLS_PLATFORM_CALLOC_MACRO mqtt_tls_calloc e MBEDTLS_PLATFORM_FREE_MACRO mqtt_tls_free"
+#endif
+#endif
+
+// Cabeçalho de cada bloco do mbedTLS: guarda o tamanho pedido, mantendo o alinhamento do calloc
+#define MQTT_TLS_HEAP_HEADER _Alignof(max_align_t)
+
+static size_t mqtt_tls_heap_now;  // bytes alocados pelo mbedTLS neste momento
+static size_t mqtt_tls_heap_peak; // maior `mqtt_tls_heap_now` desde o início da conexão em andamento
+static size_t mqtt_tls_heap_high; // maior `mqtt_tls_heap_now` desde o boot
+
+/**
+ * @brief calloc do mbedTLS (MBEDTLS_PLATFORM_CALLOC_MACRO): aloca no heap do C e contabiliza.
+ *
+ * Cada bloco leva um cabeçalho com o tamanho pedido, descontado em `mqtt_tls_free`. A conta
+ * cobre só o mbedTLS: certificados, contextos, buffers de registro e temporários do handshake.
+ */
+void *mqtt_tls_calloc(size_t n, size_t size) {
+    if (size && n > (SIZE_MAX - MQTT_TLS_HEAP_HEADER) / size) {
+        return NULL;
+    }
+    size_t bytes = n * size;
+    uint8_t *block = calloc(1, MQTT_TLS_HEAP_HEADER + bytes);
+    if (!block) {
+        return NULL;
+    }
+    memcpy(block, &bytes, sizeof(bytes));
+
+    mqtt_tls_heap_now += bytes;
+    if (mqtt_tls_heap_now > mqtt_tls_heap_peak) {
+        mqtt_tls_heap_peak = mqtt_tls_heap_now;
+    }
+    if (mqtt_tls_heap_now > mqtt_tls_heap_high) {
+        mqtt_tls_heap_high = mqtt_tls_heap_now;
+    }
+    return block + MQTT_TLS_HEAP_HEADER;
+}
+
+/**
+ * @brief free do mbedTLS (MBEDTLS_PLATFORM_FREE_MACRO), par de `mqtt_tls_calloc`.
+ */
+void mqtt_tls_free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    uint8_t *block = (uint8_t *)ptr - MQTT_TLS_HEAP_HEADER;
+    size_t bytes;
+    memcpy(&bytes, block, sizeof(bytes));
+    mqtt_tls_heap_now -= bytes;
+    free(block);
+}
+
+/**
+ * @brief Informa o heap do C alocado pelo mbedTLS agora e o maior valor desde o boot.
+ *
+ * O pico inclui as alocações temporárias dos handshakes (cadeia de certificados, ECDH).
+ * Depende de o mbedTLS alocar por `mqtt_tls_calloc`/`mqtt_tls_free`
+ * (mbedtls_config_examples_common.h); sem isso, ambos são zero.
+ *
+ * @param[out] used Bytes alocados pelo mbedTLS neste momento.
+ * @param[out] high Maior valor de `used` desde o boot.
+ */
+void mqtt_tls_heap_usage(size_t *used, size_t *high) {
+    *used = mqtt_tls_heap_now;
+    *high = mqtt_tls_heap_high;
+}
+
 /**
  * @brief Inicializa as configurações TLS de um cliente, se disponíveis
  *
+ * A configuração é criada uma única vez e reaproveitada em todas as reconexões.
+ * Os certificados ficam em flash (`static const`), sem cópias na pilha. O mbedTLS aloca
+ * no heap do C por `mqtt_tls_calloc`; o pico de cada handshake é medido em `mqtt->tls.stats`.
+ *
  * @param[out] mqtt        Ponteiro para a estrutura de configuração MQTT
  *
  * @see mqtt_start_client, mqtt_manage_topics
  */
 void mqtt_tls(mqtt_config_t * mqtt) {
     #if LWIP_ALTCP && LWIP_ALTCP_TLS // TLS enable
+        if (mqtt->client_info.tls_config) {
+            return;
+        }
         #ifdef MQTT_CERT_INC
-            const uint8_t ca_cert[] = TLS_ROOT_CERT;
-            const uint8_t client_key[] = TLS_CLIENT_KEY;
-            const uint8_t client_cert[] = TLS_CLIENT_CERT;
             mqtt->client_info.tls_config = altcp_tls_create_config_client_2wayauth(
-                                            ca_cert,
-                                            sizeof(ca_cert),
-                                            client_key,
-                                            sizeof(client_key),
+                                            mqtt_ca_cert,
+                                            sizeof(mqtt_ca_cert),
+                                            mqtt_client_key,
+                                            sizeof(mqtt_client_key),
                                             NULL,
                                             0,
-                                            client_cert,
-                                            sizeof(client_cert));
+                                            mqtt_client_cert,
+                                            sizeof(mqtt_client_cert));
             #if ALTCP_MBEDTLS_AUTHMODE != MBEDTLS_SSL_VERIFY_REQUIRED 
             //    tls without verification is insecure
             #endif
         #else
             mqtt->client_info.tls_config = altcp_tls_create_config_client(NULL, 0);
         #endif
+        #if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH) && MBEDTLS_SSL_IN_CONTENT_LEN <= 4096
+            // Buffer de entrada reduzido (perfil MQTT_RAM_PROFILE_MIN): pede ao broker registros
+            // que caibam nele
+            if (mqtt->client_info.tls_config) {
+                mbedtls_ssl_conf_max_frag_len(mqtt_lwip_tls_ssl_config(mqtt->client_info.tls_config),
+                                              MBEDTLS_SSL_IN_CONTENT_LEN <= 512  ? MBEDTLS_SSL_MAX_FRAG_LEN_512 :
+                                              MBEDTLS_SSL_IN_CONTENT_LEN <= 1024 ? MBEDTLS_SSL_MAX_FRAG_LEN_1024 :
+                                              MBEDTLS_SSL_IN_CONTENT_LEN <= 2048 ? MBEDTLS_SSL_MAX_FRAG_LEN_2048 :
+                                                                                   MBEDTLS_SSL_MAX_FRAG_LEN_4096);
+            }
+        #endif
     #endif
 }
 
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+/**
+ * @brief Prepara o handshake da conexão recém-aberta: oferece a sessão guardada ao broker.
+ *
+ * Deve ser chamada logo após `mqtt_client_connect`, antes de o TCP conectar e o
+ * handshake começar.
+ */
+static void mqtt_tls_begin(mqtt_config_t *mqtt) {
+    mqtt_tls_t *tls = &mqtt->tls;
+
+    tls->start = get_absolute_time();
+    tls->offered = false;
+    mqtt_tls_heap_peak = mqtt_tls_heap_now;
+
+    mbedtls_ssl_set_hostname(altcp_tls_context(mqtt->client->conn), mqtt->conn.server);
+    if (tls->resume && tls->session_valid) {
+        tls->offered = altcp_tls_set_session(mqtt->client->conn, tls->session) == ERR_OK;
+    }
+}
+
 /**
- * @brief Inicializa o cliente MQTT, conecta ao broker e define callbacks para eventos.
+ * @brief Impressão do segredo mestre de uma sessão TLS 1.2 (FNV-1a de 32 bits).
  *
- * Esta função configura o cliente MQTT com os parâmetros fornecidos, tenta
- * estabelecer a conexão com o broker e registra funções de callback para lidar
- * com eventos de conexão e mensagens recebidas.
+ * Uma sessão retomada, por ID ou por ticket, reaproveita o segredo mestre da sessão oferecida;
+ * um handshake completo gera outro. Guardar só a impressão evita manter uma cópia do segredo.
+ */
+uint32_t mqtt_tls_session_tag(const struct mbedtls_ssl_session *session) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(session->master); i++) {
+        hash = (hash ^ session->master[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Registra o resultado do handshake e guarda a sessão negociada para a próxima conexão.
  *
- * @param[in] mqtt            Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
- * @param[in] server          Endereço ou hostname do broker MQTT.
- * @param[in] conn_cb         Callback chamado quando a conexão com o broker é estabelecida ou perdida.
- * @param[in] pub_cb Callback chamado quando uma nova publicação chega em um tópico inscrito.
+ * A retomada é detectada pelo segredo mestre, e não pelo ID da sessão: com tickets
+ * (RFC 5077) o ID muda a cada handshake, inclusive nos retomados.
+ */
+static void mqtt_tls_done(mqtt_config_t *mqtt, mqtt_connection_status_t status) {
+    mqtt_tls_t *tls = &mqtt->tls;
+
+    if (status != MQTT_CONNECT_ACCEPTED) {
+        // Uma sessão oferecida e seguida de falha pode ter sido rejeitada: a próxima tentativa faz o handshake completo
+        if (tls->offered) {
+            tls->session_valid = false;
+        }
+        return;
+    }
+
+    mqtt_tls_stats_t *stats = &tls->stats;
+    stats->last_ms = (uint32_t)(absolute_time_diff_us(tls->start, get_absolute_time()) / 1000);
+    stats->heap_used = mqtt_tls_heap_now;
+    stats->heap_peak = mqtt_tls_heap_peak;
+
+    const mbedtls_ssl_context *ssl = altcp_tls_context(mqtt->client->conn);
+    const mbedtls_ssl_session *current = ssl->session;
+    if (!current) {
+        return;
+    }
+    bool resumed = tls->offered && mqtt_tls_session_tag(current) == tls->session_tag;
+    if (resumed) {
+        stats->resumed++;
+        stats->resumed_ms = stats->last_ms;
+        stats->resumed_heap_peak = stats->heap_peak;
+        return;
+    }
+
+    stats->full++;
+    stats->full_ms = stats->last_ms;
+    stats->full_heap_peak = stats->heap_peak;
+    if (!tls->resume) {
+        return;
+    }
+
+    // mbedtls_ssl_get_session exige uma sessão vazia: a anterior é descartada
+    if (tls->session) {
+        altcp_tls_free_session(tls->session);
+    }
+    tls->session = altcp_tls_alloc_session();
+    tls->session_valid = tls->session && altcp_tls_get_session(mqtt->client->conn, tls->session) == ERR_OK;
+    tls->session_tag = tls->session_valid ? mqtt_tls_session_tag(current) : 0;
+}
+#endif
+
+static void mqtt_sm_resolve(mqtt_config_t *mqtt);
+
+/**
+ * @brief Agenda uma nova tentativa de conexão com backoff exponencial e jitter.
+ *
+ * O atraso dobra a cada falha consecutiva, de `MQTT_BACKOFF_MIN_MS` até `MQTT_BACKOFF_MAX_MS`,
+ * e é sorteado entre metade e o total desse valor para que vários dispositivos não
+ * reconectem ao mesmo tempo após uma queda da rede ou do broker.
+ */
+static void mqtt_sm_backoff(mqtt_config_t *mqtt) {
+    mqtt_conn_t *conn = &mqtt->conn;
+
+    if (mqtt->stop_client) {
+        conn->state = MQTT_STATE_IDLE;
+        return;
+    }
+
+    uint32_t delay = MQTT_BACKOFF_MAX_MS;
+    if (conn->attempts < 16 && ((uint32_t)MQTT_BACKOFF_MIN_MS << conn->attempts) < MQTT_BACKOFF_MAX_MS) {
+        delay = (uint32_t)MQTT_BACKOFF_MIN_MS << conn->attempts;
+    }
+    delay = delay / 2 + get_rand_32() % (delay / 2 + 1);
+
+    conn->attempts++;
+    conn->backoff_ms = delay;
+    conn->state = MQTT_STATE_BACKOFF;
+    async_context_add_at_time_worker_in_ms(cyw43_arch_async_context(), &conn->timer, delay);
+}
+
+/**
+ * @brief Worker do temporizador de backoff: recomeça pela resolução DNS.
+ */
+static void mqtt_sm_timer(async_context_t *context, async_at_time_worker_t *worker) {
+    mqtt_sm_resolve((mqtt_config_t *)worker->user_data);
+}
+
+/**
+ * @brief Callback de SUBACK das reinscrições feitas pela máquina de estados.
+ */
+static void mqtt_sm_sub_cb(void *arg, err_t err) {
+    mqtt_config_t *mqtt = (mqtt_config_t *)arg;
+    mqtt_conn_t *conn = &mqtt->conn;
+
+    if (conn->pending_subs) {
+        conn->pending_subs--;
+    }
+    if (conn->pending_subs == 0 && conn->state == MQTT_STATE_SUBSCRIBING) {
+        conn->state = MQTT_STATE_RUNNING;
+    }
+}
+
+/**
+ * @brief Reinscreve todos os filtros ativos do roteador na sessão recém-aceita.
+ *
+ * Os filtros são agrupados em poucos pacotes SUBSCRIBE (`mqtt_sub_batch`), então a
+ * reconexão espera cerca de um ida e volta, e não um por filtro.
+ */
+static void mqtt_sm_subscribe(mqtt_config_t *mqtt) {
+    mqtt_conn_t *conn = &mqtt->conn;
+    mqtt_router_t *router = &mqtt->router;
+    const char *batch[MQTT_SUB_BATCH_LEN];
+    uint8_t count = 0;
+    uint16_t packets;
+
+    conn->state = MQTT_STATE_SUBSCRIBING;
+    conn->pending_subs = 0;
+    for (uint8_t i = 0; i < router->route_count; i++) {
+        if (!router->routes[i].active) {
+            continue;
+        }
+        batch[count++] = &router->pool[router->routes[i].filter];
+        if (count == MQTT_SUB_BATCH_LEN) {
+            mqtt_sub_batch(mqtt, batch, count, MQTT_SUBSCRIBE, mqtt_sm_sub_cb, mqtt, &packets);
+            conn->pending_subs += packets;
+            count = 0;
+        }
+    }
+    if (count) {
+        mqtt_sub_batch(mqtt, batch, count, MQTT_SUBSCRIBE, mqtt_sm_sub_cb, mqtt, &packets);
+        conn->pending_subs += packets;
+    }
+    if (conn->pending_subs == 0) {
+        conn->state = MQTT_STATE_RUNNING;
+    }
+}
+
+/**
+ * @brief Callback de conexão da máquina de estados.
+ *
+ * Na aceitação, zera o backoff, reinscreve os filtros registrados e retoma a fila de
+ * publicação. Em qualquer outro status (recusa, timeout ou queda), agenda a reconexão.
+ * Em ambos os casos o callback de conexão da aplicação é chamado em seguida.
+ */
+static void mqtt_sm_conn_cb(mqtt_client_t *client, void *arg, mqtt_connection_status_t status) {
+    mqtt_config_t *mqtt = (mqtt_config_t *)arg;
+    mqtt_conn_t *conn = &mqtt->conn;
+
+    #if LWIP_ALTCP && LWIP_ALTCP_TLS
+        if (conn->state == MQTT_STATE_CONNECTING) {
+            mqtt_tls_done(mqtt, status);
+        }
+    #endif
+
+    if (status == MQTT_CONNECT_ACCEPTED) {
+        mqtt->connect_done = true;
+        conn->attempts = 0;
+        if (conn->sessions++ > 0) {
+            conn->reconnects++;
+        }
+        mqtt_acks_attach(mqtt);
+        mqtt_metrics_attach(mqtt);
+        mqtt_sm_subscribe(mqtt);
+        mqtt_queue_poll(mqtt);
+    } else {
+        mqtt->connect_done = false;
+        mqtt_queue_release_in_flight(mqtt);
+        mqtt_sub_release(mqtt);
+        if (conn->state != MQTT_STATE_IDLE) {
+            mqtt_sm_backoff(mqtt);
+        }
+    }
+
+    if (conn->conn_cb) {
+        conn->conn_cb(client, arg, status);
+    }
+}
+
+/**
+ * @brief Abre a conexão com o broker no endereço já resolvido.
+ */
+static void mqtt_sm_connect(mqtt_config_t *mqtt) {
+    mqtt_conn_t *conn = &mqtt->conn;
+
+    #if LWIP_ALTCP && LWIP_ALTCP_TLS
+        uint port = MQTT_TLS_PORT;
+    #else
+        uint port = MQTT_PORT;
+    #endif
+
+    conn->state = MQTT_STATE_CONNECTING;
+    uint16_t pkt_id_seq = mqtt_lwip_pkt_id_seq(mqtt->client); // zerado por mqtt_client_connect
+    err_t err = mqtt_client_connect(mqtt->client, &mqtt->server_ip, port, mqtt_sm_conn_cb, mqtt, &mqtt->client_info);
+    if (err != ERR_OK) {
+        mqtt_sm_backoff(mqtt);
+        return;
+    }
+    mqtt_session_begin(mqtt, pkt_id_seq);
+
+    #if LWIP_ALTCP && LWIP_ALTCP_TLS
+        mqtt_tls_begin(mqtt);
+    #endif
+    // mqtt_client_connect reinicia a estrutura do cliente, então os callbacks são definidos a cada conexão
+    mqtt_set_inpub_callback(
+        mqtt->client,
+        conn->pub_cb ? conn->pub_cb : mqtt_incoming_publish,
+        conn->data_cb ? conn->data_cb : mqtt_incoming_data,
+        mqtt
+    );
+}
+
+/**
+ * @brief Callback de DNS da máquina de estados: conecta ou agenda nova tentativa.
+ */
+static void mqtt_sm_dns_cb(const char *hostname, const ip_addr_t *ipaddr, void *arg) {
+    mqtt_config_t *mqtt = (mqtt_config_t *)arg;
+    mqtt_conn_t *conn = &mqtt->conn;
+
+    if (conn->dns_cb) {
+        conn->dns_cb(hostname, ipaddr, arg);
+    }
+    if (conn->state != MQTT_STATE_RESOLVING) {
+        return;
+    }
+    if (ipaddr) {
+        mqtt->server_ip = *ipaddr;
+        mqtt_sm_connect(mqtt);
+    } else {
+        mqtt_sm_backoff(mqtt);
+    }
+}
+
+/**
+ * @brief Primeiro estado de cada tentativa: resolve o endereço do broker.
+ *
+ * O endereço é resolvido a cada tentativa, pois o IP do broker pode mudar entre quedas.
+ * A conexão só é aberta quando a resolução termina (imediatamente se o endereço estiver
+ * no cache do lwIP, ou no callback quando `dns_gethostbyname` retorna `ERR_INPROGRESS`).
+ * A exceção é a primeira tentativa após o boot com o endereço do cache de conexão
+ * (`mqtt_cache_attach`): se ela falhar, as seguintes voltam a resolver.
+ */
+static void mqtt_sm_resolve(mqtt_config_t *mqtt) {
+    mqtt_conn_t *conn = &mqtt->conn;
+
+    conn->state = MQTT_STATE_RESOLVING;
+    if (conn->cached_ip && conn->sessions == 0 && conn->attempts == 0) {
+        mqtt_sm_connect(mqtt);
+        return;
+    }
+    err_t err = dns_gethostbyname(conn->server, &mqtt->server_ip, mqtt_sm_dns_cb, mqtt);
+    if (err == ERR_OK) {
+        mqtt_sm_connect(mqtt);
+    } else if (err != ERR_INPROGRESS) {
+        mqtt_sm_backoff(mqtt);
+    }
+}
+
+/**
+ * @brief Inicializa o cliente MQTT e inicia a máquina de estados de conexão com o broker.
+ *
+ * A conexão segue os estados resolver (DNS) → conectar → reinscrever → em execução.
+ * Qualquer falha (DNS, recusa, timeout ou queda da conexão) leva ao estado de backoff,
+ * com atraso exponencial e jitter, após o qual o ciclo recomeça. Após cada reconexão os
+ * filtros registrados com `mqtt_manage_topics`/`mqtt_manage_routes` são reinscritos e a
+ * fila de publicação é retomada automaticamente.
+ *
+ * @param[in] mqtt    Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in] server  Endereço ou hostname do broker MQTT. Deve permanecer válido enquanto o cliente existir.
+ * @param[in] conn_cb Callback chamado a cada conexão aceita ou perdida. Pode ser NULL.
+ * @param[in] pub_cb  Callback chamado quando uma nova publicação chega em um tópico inscrito.
+ *      Se NULL, é usado `mqtt_incoming_publish`, que entrega os payloads pelo handler de
+ *      `mqtt_set_payload_handler`.
  * @param[in] data_cb Callback chamado quando os dados de uma publicação estão disponíveis.
- * @param[in] dns_cb Callback chamado no pedido de DNS ao servidor. Esse callback só é chamado em casos onde o status
- *      retornado `dns_gethostbyname` é `ERR_INPROGRESS`.
+ *      Se NULL, é usado `mqtt_incoming_data`.
+ * @param[in] dns_cb  Callback opcional chamado quando a resolução DNS assíncrona termina. Pode ser NULL.
  *
- * @return bool em caso de sucesso na configuração e conexão do cliente MQTT. Retorna false caso contrário.
+ * @return true se a máquina de estados foi iniciada, false se não foi possível criar o cliente.
  *
- * @note Esta função deve ser chamada antes de tentar publicar ou assinar tópicos. É necessário que a arquitetura
- *      CYW43 esteja em operação, e a mesma esteja conectada a uma rede WiFi, em modo Station.
+ * @note É necessário que a arquitetura CYW43 esteja em operação e conectada a uma rede WiFi,
+ *      em modo Station. A conexão é assíncrona: use `conn_cb` ou `mqtt->conn.state` para saber
+ *      quando ela está pronta.
  * @warning Certifique-se de que os callbacks fornecidos permanecem válidos
  *          durante todo o ciclo de vida do cliente MQTT.
  *
- * @see mqtt_sub_unsub, mqtt_manage_topics
+ * @see mqtt_stop_client, mqtt_manage_routes
  */
 bool mqtt_start_client(
     mqtt_config_t *mqtt,
-    char *server,
+    const char *server,
     mqtt_connection_cb_t conn_cb,
     mqtt_incoming_publish_cb_t pub_cb,
     mqtt_incoming_data_cb_t data_cb,
     dns_found_callback dns_cb
 ) {
-    // Faz um pedido de DNS para o endereço IP do servidor MQTT
-    cyw43_arch_lwip_begin();
-    int err1 = dns_gethostbyname(server, &mqtt->server_ip, dns_cb, mqtt);
-    cyw43_arch_lwip_end();
-
-    if (err1 != ERR_OK && err1 != ERR_INPROGRESS) {
-        return false;
-    }
-
-    #if LWIP_ALTCP && LWIP_ALTCP_TLS
-        uint port = MQTT_TLS_PORT;
-    #else
-        uint port = MQTT_PORT;
-    #endif
+    mqtt_conn_t *conn = &mqtt->conn;
 
-    mqtt->client = mqtt_client_new();
     if (!mqtt->client) {
-        return false;
+        mqtt->client = mqtt_client_new();
+        if (!mqtt->client) {
+            return false;
+        }
     }
 
-    cyw43_arch_lwip_begin();
-    int err2 = mqtt_client_connect(mqtt->client, &mqtt->server_ip, port, conn_cb, mqtt, &mqtt->client_info);
-    if (err2 != ERR_OK) {
-        return false;
-    }
+    conn->server = server;
+    conn->conn_cb = conn_cb;
+    conn->pub_cb = pub_cb;
+    conn->data_cb = data_cb;
+    conn->dns_cb = dns_cb;
+    conn->timer.do_work = mqtt_sm_timer;
+    conn->timer.user_data = mqtt;
+    conn->attempts = 0;
+    mqtt->stop_client = false;
 
-    #if LWIP_ALTCP && LWIP_ALTCP_TLS
-        mbedtls_ssl_set_hostname(altcp_tls_context(mqtt->client->conn), server);
-    #endif
-    mqtt_set_inpub_callback(mqtt->client, pub_cb, data_cb, mqtt);
+    cyw43_arch_lwip_begin();
+    mqtt_sm_resolve(mqtt);
     cyw43_arch_lwip_end();
 
     return true;
 }
 
+/**
+ * @brief Para a máquina de estados e desconecta do broker, sem novas tentativas.
+ *
+ * @param[in] mqtt Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ */
+void mqtt_stop_client(mqtt_config_t *mqtt) {
+    cyw43_arch_lwip_begin();
+    mqtt->stop_client = true;
+    mqtt->conn.state = MQTT_STATE_IDLE;
+    async_context_remove_at_time_worker(cyw43_arch_async_context(), &mqtt->conn.timer);
+    if (mqtt->client) {
+        mqtt_disconnect(mqtt->client);
+    }
+    // mqtt_disconnect não chama o callback de conexão
+    mqtt_queue_release_in_flight(mqtt);
+    mqtt_sub_release(mqtt);
+    mqtt->connect_done = false;
+    cyw43_arch_lwip_end();
+}
+
 /**
  * @brief Gera um ID de cliente MQTT único baseado no nome do dispositivo e no ID único do hardware.
  *
@@ -142,20 +938,29 @@ char *mqtt_generate_client_id(char *device_name) {
  * Esta função combina o nome do cliente MQTT com o nome do tópico base fornecido,
  * criando uma string de tópico completa que pode ser usada para publicar ou
  * assinar mensagens.
- * Exemplo: se o cliente tiver ID `smartmeter` e `name` for `/led`, o resultado
- * pode ser `/smartmeter/led`.
+ * Exemplo: se o cliente tiver ID `smartmeter` e `name` for `led`, o resultado
+ * é `smartmeter/led`.
+ *
+ * O tópico completo é registrado na tabela de tópicos (`mqtt_topic_register`) na
+ * primeira chamada; as seguintes apenas o localizam, sem formatar a string novamente.
  *
  * @param[in] mqtt Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
  * @param[in] name Nome do tópico base. Não deve ser NULL.
  *
- * @return char* Ponteiro para uma string alocada dinamicamente contendo o tópico completo.
- *               O conteúdo **não deve ser liberado** pelo chamador e
+ * @return char* Ponteiro para o tópico completo, estável enquanto `mqtt` existir.
+ *               O conteúdo **não deve ser liberado** nem alterado pelo chamador.
+ *               Se a tabela estiver cheia, retorna um buffer estático que
  *               **pode ser sobrescrito em chamadas subsequentes**.
  *
- * @note O formato exato do tópico depende de como o cliente MQTT foi configurado.
+ * @note Em caminhos frequentes, prefira guardar o handle de `mqtt_topic_register` e publicar
+ *       com `mqtt_queue_publish_topic`.
  */
 char *mqtt_full_topic(mqtt_config_t *mqtt, char *name) {
     if (mqtt->unique_topic) {
+        mqtt_topic_t topic = mqtt_topic_register(mqtt, name);
+        if (topic != MQTT_TOPIC_INVALID) {
+            return (char *)mqtt_topic_str(mqtt, topic);
+        }
         static char full_topic[MQTT_TOPIC_LEN];
         snprintf(full_topic, MQTT_TOPIC_LEN, "%s/%s", mqtt->client_info.client_id, name);
         return full_topic;
@@ -164,24 +969,367 @@ char *mqtt_full_topic(mqtt_config_t *mqtt, char *name) {
     }
 }
 
+/**
+ * @brief Registra um tópico na tabela de tópicos pré-montados e retorna seu handle.
+ *
+ * O tópico completo (`<client_id>/<name>` se `unique_topic` estiver ativo, ou apenas `name`)
+ * é montado uma única vez no buffer da tabela. Registrar novamente o mesmo nome retorna o
+ * mesmo handle. Chame após definir `client_info.client_id` e `unique_topic`, tipicamente
+ * durante a inicialização.
+ *
+ * @param[in] mqtt Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in] name Nome do tópico base. Não deve ser NULL.
+ *
+ * @return Handle do tópico, ou `MQTT_TOPIC_INVALID` se a tabela (`MQTT_TOPIC_TABLE_LEN`) ou o
+ *         buffer (`MQTT_TOPIC_POOL_SIZE`) estiverem cheios.
+ *
+ * @code
+ * // Exemplo de uso:
+ * mqtt_topic_t temp = mqtt_topic_register(&mqtt, "temperature");
+ * ...
+ * mqtt_queue_publish_topic(&mqtt, temp, payload, len);
+ * @endcode
+ *
+ * @see mqtt_topic_str, mqtt_queue_publish_topic
+ */
+mqtt_topic_t mqtt_topic_register(mqtt_config_t *mqtt, const char *name) {
+    mqtt_topics_t *topics = &mqtt->topics;
+    const char *prefix = mqtt->unique_topic ? mqtt->client_info.client_id : NULL;
+    size_t prefix_len = prefix ? strlen(prefix) + 1 : 0; // inclui a '/'
+    size_t name_len = strlen(name);
+
+    for (uint8_t i = 0; i < topics->count; i++) {
+        const mqtt_topic_entry_t *e = &topics->entries[i];
+        const char *full = &topics->pool[e->offset];
+        if (e->len == prefix_len + name_len && e->name == prefix_len &&
+            strcmp(&full[e->name], name) == 0 && (!prefix || strncmp(full, prefix, prefix_len - 1) == 0)) {
+            return i;
+        }
+    }
+
+    size_t len = prefix_len + name_len;
+    if (topics->count >= MQTT_TOPIC_TABLE_LEN || len >= MQTT_TOPIC_LEN ||
+        topics->pool_used + len + 1 > MQTT_TOPIC_POOL_SIZE) {
+        return MQTT_TOPIC_INVALID;
+    }
+
+    char *full = &topics->pool[topics->pool_used];
+    if (prefix) {
+        memcpy(full, prefix, prefix_len - 1);
+        full[prefix_len - 1] = '/';
+    }
+    memcpy(&full[prefix_len], name, name_len + 1);
+
+    mqtt_topic_entry_t *e = &topics->entries[topics->count];
+    e->offset = topics->pool_used;
+    e->name = prefix_len;
+    e->len = len;
+    e->compress = false;
+    topics->pool_used += len + 1;
+    return topics->count++;
+}
+
+/**
+ * @brief Retorna a string do tópico completo de um handle.
+ *
+ * @param[in] mqtt  Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in] topic Handle retornado por `mqtt_topic_register`.
+ *
+ * @return Tópico completo (estável enquanto `mqtt` existir), ou NULL se o handle for inválido.
+ */
+const char *mqtt_topic_str(const mqtt_config_t *mqtt, mqtt_topic_t topic) {
+    if (topic < 0 || topic >= mqtt->topics.count) {
+        return NULL;
+    }
+    return &mqtt->topics.pool[mqtt->topics.entries[topic].offset];
+}
+
+/**
+ * @brief Define como os payloads recebidos são entregues à aplicação.
+ *
+ * No modo `MQTT_PAYLOAD_STREAM`, cada fragmento entregue pelo lwIP é repassado ao
+ * callback diretamente, sem cópia, com `offset` e `last` indicando sua posição.
+ * No modo `MQTT_PAYLOAD_ASSEMBLE`, os fragmentos são copiados uma única vez para a
+ * arena de recepção (`mqtt->rx.arena`), reservada a partir de `tot_len`, e o callback
+ * é chamado uma vez com o payload completo. Mensagens que não cabem na arena são
+ * entregues em fragmentos e contabilizadas em `mqtt->rx.overflows`.
+ *
+ * @param[in] mqtt Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in] mode Modo de entrega: MQTT_PAYLOAD_STREAM ou MQTT_PAYLOAD_ASSEMBLE.
+ * @param[in] cb   Callback chamado com cada payload (ou fragmento).
+ * @param[in] arg  Argumento repassado ao callback.
+ *
+ * @note Só tem efeito se `mqtt_start_client` for chamado com `pub_cb` e `data_cb` NULL.
+ *
+ * @see mqtt_incoming_publish, mqtt_incoming_data
+ */
+void mqtt_set_payload_handler(mqtt_config_t *mqtt, mqtt_payload_mode_t mode, mqtt_payload_cb_t cb, void *arg) {
+    mqtt->rx.mode = mode;
+    mqtt->rx.cb = cb;
+    mqtt->rx.arg = arg;
+}
+
+/**
+ * @brief No modo `MQTT_PAYLOAD_ASSEMBLE`, reserva `payload.tot_len` bytes da arena logo após o tópico.
+ */
+static void mqtt_rx_reserve(mqtt_rx_t *rx, size_t topic_len) {
+    uint32_t tot_len = rx->payload.tot_len;
+
+    if (rx->mode != MQTT_PAYLOAD_ASSEMBLE) {
+        return;
+    }
+    size_t head = (topic_len + 4) & ~3u; // tópico + '\0', alinhado em 4 bytes
+    if (head + tot_len + 1 <= MQTT_PAYLOAD_ARENA_SIZE) {
+        rx->buf = rx->arena + head;
+        if (head + tot_len + 1 > rx->arena_hwm) {
+            rx->arena_hwm = head + tot_len + 1;
+        }
+    } else {
+        rx->overflows++;
+    }
+}
+
+/**
+ * @brief Entrega um fragmento do payload ao handler da mensagem, ou o monta na arena.
+ */
+static void mqtt_rx_deliver(mqtt_config_t *mqtt, const uint8_t *data, uint32_t len, bool last) {
+    mqtt_rx_t *rx = &mqtt->rx;
+
+    if (rx->buf) {
+        uint32_t room = rx->payload.tot_len - rx->received;
+        if (len > room) {
+            len = room;
+        }
+        if (len) {
+            memcpy(rx->buf + rx->received, data, len);
+            rx->received += len;
+        }
+        if (!last) {
+            return;
+        }
+        rx->buf[rx->received] = '\0';
+        rx->payload.offset = 0;
+        rx->payload.data = rx->buf;
+        rx->payload.len = rx->received;
+    } else {
+        rx->payload.offset = rx->received;
+        rx->payload.data = data;
+        rx->payload.len = len;
+        rx->received += len;
+    }
+
+    rx->payload.last = last;
+    if (rx->forward) {
+        rx->forward(mqtt, &rx->payload, rx->handler, rx->handler_arg, rx->forward_arg);
+    } else if (rx->handler) {
+        rx->handler(mqtt, &rx->payload, rx->handler_arg);
+    }
+}
+
+static uint32_t mqtt_rx_handler_us; // tempo dos handlers durante a descompressão, fora de `rx_us`
+
+/**
+ * @brief Destino do descompressor (`mqtt_inflate_out_t`): entrega os bytes já descomprimidos.
+ *
+ * Na primeira chamada o tamanho original já é conhecido: `tot_len` passa a ser ele e a arena
+ * é reservada como em uma mensagem sem compressão.
+ */
+static void mqtt_rx_inflate_out(void *arg, uint32_t offset, const uint8_t *data, uint32_t len, bool last) {
+    mqtt_config_t *mqtt = (mqtt_config_t *)arg;
+    mqtt_rx_t *rx = &mqtt->rx;
+
+    if (offset == 0) {
+        rx->payload.tot_len = mqtt->compress.inflate.tot_len;
+        mqtt_rx_reserve(rx, strlen(rx->payload.topic));
+    }
+    absolute_time_t start = get_absolute_time();
+    mqtt_rx_deliver(mqtt, data, len, last);
+    mqtt_rx_handler_us += (uint32_t)absolute_time_diff_us(start, get_absolute_time());
+}
+
+/**
+ * @brief Callback de publicação recebida (`mqtt_incoming_publish_cb_t`) da biblioteca.
+ *
+ * Casa o tópico com o roteador uma única vez, associando o handler da rota à mensagem,
+ * copia o tópico para o início da arena e, no modo `MQTT_PAYLOAD_ASSEMBLE`, reserva
+ * `tot_len` bytes logo após ele para montar o payload. Com a sessão persistente ativa,
+ * retransmissões já entregues são descartadas (`mqtt_session_duplicate`). Em rotas com
+ * `compressed`, a reserva espera o tamanho original, no cabeçalho do payload.
+ *
+ * @param[in] arg     Ponteiro para `mqtt_config_t`.
+ * @param[in] topic   Tópico da publicação (válido apenas durante esta chamada).
+ * @param[in] tot_len Tamanho total do payload.
+ */
+void mqtt_incoming_publish(void *arg, const char *topic, u32_t tot_len) {
+    mqtt_config_t *mqtt = (mqtt_config_t *)arg;
+    mqtt_rx_t *rx = &mqtt->rx;
+
+    rx->duplicate = mqtt_session_duplicate(mqtt);
+    if (rx->duplicate) {
+        return;
+    }
+
+    const mqtt_router_route_t *route = mqtt_router_match(&mqtt->router, topic);
+    if (route && route->handler) {
+        rx->handler = route->handler;
+        rx->handler_arg = route->arg;
+    } else {
+        rx->handler = rx->cb;
+        rx->handler_arg = rx->arg;
+    }
+    rx->compressed = route && route->compressed;
+    if (rx->compressed) {
+        mqtt_inflate_begin(&mqtt->compress.inflate);
+        mqtt->compress.stats.rx_messages++;
+    }
+
+    size_t topic_len = strlen(topic);
+    if (topic_len >= MQTT_TOPIC_LEN) {
+        topic_len = MQTT_TOPIC_LEN - 1;
+    }
+    memcpy(rx->arena, topic, topic_len);
+    rx->arena[topic_len] = '\0';
+
+    rx->payload.topic = (const char *)rx->arena;
+    rx->payload.tot_len = tot_len;
+    rx->payload.offset = 0;
+    rx->payload.data = NULL;
+    rx->payload.len = 0;
+    rx->payload.last = false;
+    rx->received = 0;
+    rx->buf = NULL;
+
+    // Mensagens comprimidas reservam a arena pelo tamanho original, lido do cabeçalho
+    if (!rx->compressed) {
+        mqtt_rx_reserve(rx, topic_len);
+    }
+}
+
+/**
+ * @brief Callback de dados recebidos (`mqtt_incoming_data_cb_t`) da biblioteca.
+ *
+ * Entrega o fragmento diretamente ao handler da mensagem (modo STREAM ou mensagem maior que a arena),
+ * ou o copia para a região reservada e entrega o payload completo em `MQTT_DATA_FLAG_LAST`.
+ * Payloads de rotas com `compressed` passam antes pelo descompressor, e o handler recebe os
+ * bytes originais, com `offset` e `tot_len` do payload descomprimido.
+ *
+ * @param[in] arg   Ponteiro para `mqtt_config_t`.
+ * @param[in] data  Fragmento do payload.
+ * @param[in] len   Tamanho do fragmento.
+ * @param[in] flags `MQTT_DATA_FLAG_LAST` no último fragmento.
+ */
+void mqtt_incoming_data(void *arg, const u8_t *data, u16_t len, u8_t flags) {
+    mqtt_config_t *mqtt = (mqtt_config_t *)arg;
+    mqtt_rx_t *rx = &mqtt->rx;
+    bool last = (flags & MQTT_DATA_FLAG_LAST) != 0;
+
+    if (rx->duplicate) {
+        return;
+    }
+    if (!rx->compressed) {
+        mqtt_rx_deliver(mqtt, data, len, last);
+        return;
+    }
+
+    mqtt_compress_stats_t *stats = &mqtt->compress.stats;
+    mqtt_inflate_t *z = &mqtt->compress.inflate;
+    absolute_time_t start = get_absolute_time();
+    mqtt_rx_handler_us = 0;
+    mqtt_inflate_feed(z, data, len, last, mqtt_rx_inflate_out, mqtt);
+    stats->rx_us += (uint32_t)absolute_time_diff_us(start, get_absolute_time()) - mqtt_rx_handler_us;
+    stats->rx_bytes += len;
+    if (last) {
+        if (z->error) {
+            stats->rx_errors++;
+        } else {
+            stats->rx_raw += z->produced;
+        }
+    }
+}
+
+/**
+ * @brief Registra (ou remove) os filtros no roteador e os envia em lote ao broker.
+ *
+ * Recebe `topics` (sem handler próprio) ou `routes`. Os filtros são agrupados de
+ * `MQTT_SUB_BATCH_LEN` em `MQTT_SUB_BATCH_LEN` em `mqtt_sub_batch`, e todos os pacotes
+ * concluem uma única pendência agregada, que chama `cb` uma vez.
+ */
+static void mqtt_manage(mqtt_config_t *mqtt, const char *const *topics, const mqtt_route_t *routes, size_t num,
+                        mqtt_action_t action, mqtt_request_cb_t cb) {
+    bool connected = mqtt->client && mqtt_client_is_connected(mqtt->client);
+    mqtt_sub_op_t *op = connected ? mqtt_sub_op_begin(mqtt, cb, mqtt) : NULL;
+    mqtt_request_cb_t packet_cb = op ? mqtt_sub_op_done : cb;
+    void *packet_arg = op ? (void *)op : (void *)mqtt;
+    const char *batch[MQTT_SUB_BATCH_LEN];
+    uint8_t count = 0;
+    uint16_t packets;
+    err_t err = ERR_OK;
+
+    for (size_t i = 0; i < num; i++) {
+        const char *filter = routes ? routes[i].filter : topics[i];
+        if (action == MQTT_SUBSCRIBE) {
+            mqtt_payload_cb_t handler = routes ? routes[i].handler : NULL;
+            void *arg = routes ? routes[i].arg : NULL;
+            mqtt_router_route_t *route = mqtt_router_add(&mqtt->router, filter, handler, arg);
+            if (!route) {
+                err = ERR_MEM;
+                continue;
+            }
+            route->compressed = routes && routes[i].compressed;
+        } else {
+            mqtt_router_remove(&mqtt->router, filter);
+        }
+        if (!connected) {
+            continue;
+        }
+
+        batch[count++] = filter;
+        if (count == MQTT_SUB_BATCH_LEN) {
+            if (mqtt_sub_batch(mqtt, batch, count, action, packet_cb, packet_arg, &packets) != ERR_OK) {
+                err = ERR_MEM;
+            }
+            if (op) {
+                op->pending += packets;
+            }
+            count = 0;
+        }
+    }
+    if (count) {
+        if (mqtt_sub_batch(mqtt, batch, count, action, packet_cb, packet_arg, &packets) != ERR_OK) {
+            err = ERR_MEM;
+        }
+        if (op) {
+            op->pending += packets;
+        }
+    }
+
+    if (op) {
+        mqtt_sub_op_done(op, err);
+    } else if (cb && err != ERR_OK) {
+        cb(mqtt, err);
+    }
+}
+
 /**
  * @brief Gerencia inscrições ou remoções em múltiplos tópicos MQTT.
  *
  * Esta função percorre uma lista de tópicos e realiza a ação especificada
- * (inscrição ou remoção) em cada um deles, chamando o callback fornecido
- * após cada operação, se aplicável.
+ * (inscrição ou remoção) em todos eles, agrupados em poucos pacotes, chamando o
+ * callback fornecido uma única vez ao final, se aplicável. Os tópicos inscritos são
+ * registrados no roteador sem handler próprio, ou seja, suas mensagens vão para o
+ * handler definido em `mqtt_set_payload_handler`.
  *
  * @param[in] mqtt       Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
  * @param[in] topics     Array de strings contendo os nomes dos tópicos.
  * @param[in] num_topics Número de tópicos presentes no array `topics`.
  * @param[in] action     Ação a ser realizada em cada tópico: MQTT_SUBSCRIBE ou MQTT_UNSUBSCRIBE.
- * @param[in] cb         Callback opcional para notificação do resultado de cada subscribe/unsubscribe.
+ * @param[in] cb         Callback opcional para o resultado agregado (vide `mqtt_manage_routes`).
  *                       Pode ser NULL se não houver necessidade de callback.
  *
  * @note O array `topics` **não deve ser NULL** e deve conter pelo menos `num_topics` elementos válidos.
- * @note Esta função **não copia** os tópicos, apenas referencia os ponteiros fornecidos.
+ * @note Os tópicos são copiados para o roteador; os ponteiros fornecidos podem ser descartados após a chamada.
  *
- * @see mqtt_sub_unsub, mqtt_config_t, mqtt_action_t
+ * @see mqtt_manage_routes, mqtt_config_t, mqtt_action_t
  *
  * @code
  * // Exemplo de uso:
@@ -196,7 +1344,45 @@ char *mqtt_full_topic(mqtt_config_t *mqtt, char *name) {
  * @endcode
  */
 void mqtt_manage_topics(mqtt_config_t *mqtt, char **topics, size_t num_topics, mqtt_action_t action, mqtt_request_cb_t cb) {
-    for (int i = 0; i < num_topics; i++) {
-        mqtt_sub_unsub(mqtt->client, topics[i], mqtt->sub_qos, cb, mqtt, action);
-    }
-}
\ No newline at end of file
+    mqtt_manage(mqtt, (const char *const *)topics, NULL, num_topics, action, cb);
+}
+
+/**
+ * @brief Inscreve (ou remove inscrições) em filtros de tópico, registrando seus handlers no roteador.
+ *
+ * Na inscrição, cada filtro é adicionado à árvore do roteador junto com seu handler antes
+ * do SUBSCRIBE; na remoção, a rota é desfeita antes do UNSUBSCRIBE. As publicações
+ * recebidas são então casadas uma única vez em `mqtt_incoming_publish` e entregues
+ * diretamente ao handler da rota mais específica (exato, depois `+`, depois `#`).
+ *
+ * @param[in] mqtt       Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in] routes     Array de rotas (filtro, handler, argumento e, opcionalmente, `compressed`).
+ * @param[in] num_routes Número de rotas presentes em `routes`.
+ * @param[in] action     MQTT_SUBSCRIBE ou MQTT_UNSUBSCRIBE.
+ * @param[in] cb         Callback opcional, chamado uma única vez com o resultado agregado: ERR_OK
+ *                       se todos os pacotes foram confirmados, ou o primeiro erro. Pode ser NULL.
+ *
+ * @note Os filtros são agrupados em poucos pacotes SUBSCRIBE/UNSUBSCRIBE (`mqtt_sub_batch`):
+ *       o tempo de inscrição é de cerca de um ida e volta, independente da quantidade de filtros.
+ *       Se houver mais de `MQTT_SUB_OPS` chamadas aguardando confirmação, `cb` passa a ser
+ *       chamado uma vez por pacote.
+ * @note Sem conexão ativa os filtros são apenas registrados: a máquina de estados de
+ *       `mqtt_start_client` os inscreve a cada conexão aceita. Por isso, basta registrar as
+ *       rotas uma vez, antes ou depois de iniciar o cliente.
+ * @note Filtros que não cabem no roteador (vide `MQTT_ROUTER_MAX_NODES`, `MQTT_ROUTER_MAX_ROUTES`
+ *       e `MQTT_ROUTER_POOL_SIZE`) ou inválidos não são inscritos e o resultado agregado é `ERR_MEM`;
+ *       sem conexão, `cb` só é chamado nesse caso.
+ *
+ * @code
+ * // Exemplo de uso:
+ * mqtt_route_t routes[] = {
+ *     { "cmd/led",    on_led,    NULL },
+ *     { "cmd/+/set",  on_set,    NULL },
+ *     { "config/#",   on_config, NULL, true }, // payloads comprimidos (`mqtt_topic_compress`)
+ * };
+ * mqtt_manage_routes(&mqtt, routes, 3, MQTT_SUBSCRIBE, sub_cb);
+ * @endcode
+ */
+void mqtt_manage_routes(mqtt_config_t *mqtt, const mqtt_route_t *routes, size_t num_routes, mqtt_action_t action, mqtt_request_cb_t cb) {
+    mqtt_manage(mqtt, NULL, routes, num_routes, action, cb);
+}
@@ -4,21 +4,53 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <ctype.h>
 
 #include "pico/stdlib.h"     // Biblioteca da Raspberry Pi Pico para funções padrão (GPIO, temporização, etc.)
 #include "pico/cyw43_arch.h" // Biblioteca para arquitetura Wi-Fi da Pico com CYW43
 #include "pico/unique_id.h" // Biblioteca com recursos para trabalhar com os pinos GPIO do Raspberry Pi Pico
+#include "pico/rand.h"      // Gerador de números aleatórios (jitter do backoff de reconexão)
 
 #include "lwip/apps/mqtt.h"      // Biblioteca LWIP MQTT -  fornece funções e recursos para conexão MQTT
 #include "lwip/apps/mqtt_priv.h" // Biblioteca que fornece funções e recursos para Geração de Conexões
 #include "lwip/dns.h"            // Biblioteca que fornece funções e recursos suporte DNS
 #include "lwip/altcp_tls.h"      // Biblioteca que fornece funções e recursos para conexões seguras usando TLS
 
+// Variante FreeRTOS (alvo mqtt_pico_freertos)
+#ifdef MQTT_PICO_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#endif
+
+// Sensores com helpers de codificação (habilitados pelo CMake quando as bibliotecas estão no projeto)
+#ifdef MQTT_PICO_AHT20
+#include "aht20.h"
+#endif
+#ifdef MQTT_PICO_MAX6675
+#include "max6675.h"
+#endif
+
 // Este arquivo inclui seu certificado de cliente para autenticação do servidor cliente
 #ifdef MQTT_CERT_INC
 #include MQTT_CERT_INC
 #endif
 
+/**
+ * Escala das arenas e buffers de texto do cliente: 4 no perfil padrão, 2 em
+ * `MQTT_RAM_PROFILE_LOW` e 1 em `MQTT_RAM_PROFILE_MIN` (perfis de RAM reduzida, ver lwipopts.h).
+ * No MIN, as arenas comportam uma mensagem de `MQTT_OUTPUT_RINGBUF_SIZE` bytes por vez.
+ */
+#ifndef MQTT_RAM_SCALE
+#if defined(MQTT_RAM_PROFILE_MIN)
+#define MQTT_RAM_SCALE 1
+#elif defined(MQTT_RAM_PROFILE_LOW)
+#define MQTT_RAM_SCALE 2
+#else
+#define MQTT_RAM_SCALE 4
+#endif
+#endif
+
 /**
  * Tamanho máximo do tópico MQTT.
  */
@@ -32,13 +64,582 @@
 typedef struct mqtt_connect_client_info_t mqtt_client_info_t;
 
 /**
- * @brief Estrutura que armazena dados de mensagens MQTT.
+ * Tamanho da arena usada para montar mensagens recebidas (tópico + payload).
+ * Mensagens maiores que a arena são entregues em fragmentos.
+ */
+#ifndef MQTT_PAYLOAD_ARENA_SIZE
+#define MQTT_PAYLOAD_ARENA_SIZE (MQTT_RAM_SCALE * MQTT_OUTPUT_RINGBUF_SIZE)
+#endif
+
+#if MQTT_PAYLOAD_ARENA_SIZE < MQTT_TOPIC_LEN
+#error "MQTT_PAYLOAD_ARENA_SIZE deve comportar ao menos um tópico (MQTT_TOPIC_LEN)"
+#endif
+
+struct mqtt_config_t;
+
+/**
+ * @brief Modos de entrega do payload de mensagens recebidas.
+ */
+typedef enum {
+    MQTT_PAYLOAD_STREAM   = 0, /**< Cada fragmento é entregue assim que chega, sem cópia */
+    MQTT_PAYLOAD_ASSEMBLE = 1  /**< Fragmentos são montados na arena e entregues uma única vez */
+} mqtt_payload_mode_t;
+
+/**
+ * @brief Visão de um payload recebido (ou de um fragmento dele).
+ *
+ * Os ponteiros são válidos apenas durante o callback que recebe a estrutura.
+ */
+typedef struct mqtt_payload_t {
+    const char *topic;    /**< Tópico da mensagem, terminado em '\0' */
+    uint32_t tot_len;     /**< Tamanho total do payload informado na publicação */
+    uint32_t offset;      /**< Posição de `data` dentro do payload */
+    const uint8_t *data;  /**< Fragmento (STREAM) ou payload completo terminado em '\0' (ASSEMBLE) */
+    uint32_t len;         /**< Tamanho de `data` */
+    bool last;            /**< Indica o último fragmento da mensagem */
+} mqtt_payload_t;
+
+/**
+ * @brief Callback que recebe payloads de mensagens MQTT.
+ */
+typedef void (*mqtt_payload_cb_t)(struct mqtt_config_t *mqtt, const mqtt_payload_t *payload, void *arg);
+
+/**
+ * @brief Desvio da entrega de payloads: recebe o payload e o handler que o receberia.
+ *
+ * Usado pelo modo de dois núcleos para levar as mensagens ao núcleo 0 em vez de chamar o
+ * handler no núcleo da rede.
+ */
+typedef void (*mqtt_forward_cb_t)(struct mqtt_config_t *mqtt, const mqtt_payload_t *payload,
+                                  mqtt_payload_cb_t handler, void *handler_arg, void *arg);
+
+/**
+ * @brief Estado de recepção de mensagens MQTT.
+ */
+typedef struct mqtt_rx_t {
+    mqtt_payload_mode_t mode;              /**< Modo de entrega configurado */
+    mqtt_payload_cb_t cb;                  /**< Callback de entrega do payload */
+    void *arg;                             /**< Argumento repassado ao callback */
+    mqtt_payload_t payload;                /**< Mensagem em recepção */
+    mqtt_payload_cb_t handler;             /**< Handler associado à mensagem atual (rota ou `cb`) */
+    void *handler_arg;                     /**< Argumento do handler da mensagem atual */
+    mqtt_forward_cb_t forward;             /**< Se definido, recebe os payloads no lugar do handler */
+    void *forward_arg;                     /**< Argumento de `forward` */
+    bool duplicate;                        /**< Mensagem atual descartada como retransmissão já entregue */
+    bool compressed;                       /**< Mensagem atual comprimida: entregue pelo descompressor */
+    uint8_t *buf;                          /**< Região da arena reservada para a mensagem atual (NULL se em fragmentos) */
+    uint32_t received;                     /**< Bytes recebidos da mensagem atual */
+    uint32_t overflows;                    /**< Mensagens maiores que a arena, entregues em fragmentos */
+    uint32_t arena_hwm;                    /**< Maior ocupação da arena em bytes */
+    uint8_t arena[MQTT_PAYLOAD_ARENA_SIZE]; /**< Arena de recepção: tópico seguido do payload */
+} mqtt_rx_t;
+
+/**
+ * Quantidade máxima de nós na árvore de tópicos do roteador (um por nível distinto).
+ */
+#ifndef MQTT_ROUTER_MAX_NODES
+#define MQTT_ROUTER_MAX_NODES 64
+#endif
+
+/**
+ * Quantidade máxima de filtros de tópico registrados no roteador.
+ */
+#ifndef MQTT_ROUTER_MAX_ROUTES
+#define MQTT_ROUTER_MAX_ROUTES 32
+#endif
+
+/**
+ * Tamanho do buffer que guarda os textos dos filtros registrados.
+ */
+#ifndef MQTT_ROUTER_POOL_SIZE
+#define MQTT_ROUTER_POOL_SIZE (MQTT_RAM_SCALE * 256)
+#endif
+
+#if MQTT_ROUTER_MAX_NODES > 255 || MQTT_ROUTER_MAX_ROUTES > 255
+#error "O roteador usa índices de 8 bits: MQTT_ROUTER_MAX_NODES e MQTT_ROUTER_MAX_ROUTES devem ser <= 255"
+#endif
+
+#define MQTT_ROUTER_NONE 0xFF /**< Índice nulo de nó ou rota */
+
+/**
+ * @brief Associação entre um filtro de tópico e o handler de suas mensagens.
+ */
+typedef struct mqtt_route_t {
+    const char *filter;        /**< Filtro de tópico, podendo conter os curingas `+` e `#` */
+    mqtt_payload_cb_t handler; /**< Handler das mensagens (NULL usa o handler padrão de `mqtt_set_payload_handler`) */
+    void *arg;                 /**< Argumento repassado ao handler */
+    bool compressed;           /**< Payloads comprimidos pelo publicador (`mqtt_compress`) */
+} mqtt_route_t;
+
+/**
+ * @brief Nó da árvore de tópicos: um nível de um ou mais filtros.
+ */
+typedef struct mqtt_router_node_t {
+    uint16_t seg;     /**< Posição do texto do nível em `pool` */
+    uint8_t seg_len;  /**< Tamanho do texto do nível */
+    uint8_t child;    /**< Primeiro filho */
+    uint8_t sibling;  /**< Próximo irmão */
+    uint8_t route;    /**< Rota cujo filtro termina neste nó */
+} mqtt_router_node_t;
+
+/**
+ * @brief Rota registrada no roteador.
+ */
+typedef struct mqtt_router_route_t {
+    mqtt_payload_cb_t handler; /**< Handler das mensagens */
+    void *arg;                 /**< Argumento do handler */
+    uint16_t filter;           /**< Posição do filtro completo em `pool` ('\0' ao final) */
+    bool active;               /**< Falso após a remoção da inscrição */
+    bool compressed;           /**< Payloads descomprimidos antes da entrega */
+} mqtt_router_route_t;
+
+/**
+ * @brief Roteador de tópicos: árvore compacta (trie por nível) construída na inscrição.
+ *
+ * Cada publicação recebida é comparada uma única vez, em tempo proporcional ao
+ * tamanho do tópico, e o handler encontrado é associado à mensagem.
+ */
+typedef struct mqtt_router_t {
+    mqtt_router_node_t nodes[MQTT_ROUTER_MAX_NODES];    /**< Nós da árvore (o nó 0 é a raiz) */
+    mqtt_router_route_t routes[MQTT_ROUTER_MAX_ROUTES]; /**< Rotas registradas */
+    char pool[MQTT_ROUTER_POOL_SIZE];                   /**< Textos dos filtros */
+    uint16_t pool_used;                                 /**< Bytes ocupados em `pool` */
+    uint8_t node_count;                                 /**< Nós em uso */
+    uint8_t route_count;                                /**< Rotas em uso */
+} mqtt_router_t;
+
+/**
+ * Quantidade máxima de filtros agrupados por chamada a `mqtt_sub_batch` (tamanho do array
+ * montado na pilha por `mqtt_manage_routes` e pela reinscrição após cada conexão).
+ */
+#ifndef MQTT_SUB_BATCH_LEN
+#define MQTT_SUB_BATCH_LEN 16
+#endif
+
+/**
+ * Quantidade de chamadas a `mqtt_manage_routes`/`mqtt_manage_topics` que podem aguardar
+ * confirmação ao mesmo tempo com callback agregado.
+ */
+#ifndef MQTT_SUB_OPS
+#define MQTT_SUB_OPS 4
+#endif
+
+/**
+ * @brief Inscrição (ou remoção) em lote aguardando SUBACK/UNSUBACK de todos os seus pacotes.
+ */
+typedef struct mqtt_sub_op_t {
+    mqtt_request_cb_t cb;   /**< Callback agregado (NULL se a vaga estiver livre) */
+    void *arg;              /**< Argumento de `cb` */
+    uint16_t pending;       /**< Pacotes aguardando confirmação */
+    err_t err;              /**< Primeiro erro entre os pacotes */
+} mqtt_sub_op_t;
+
+/**
+ * @brief Pacote SUBSCRIBE/UNSUBSCRIBE de `mqtt_sub_batch` aguardando confirmação.
+ *
+ * O lwIP só repassa o código de retorno do primeiro filtro do SUBACK; os demais são lidos pela
+ * inspeção dos pacotes recebidos (`mqtt_sub_suback`).
+ */
+typedef struct mqtt_sub_pkt_t {
+    mqtt_request_cb_t cb;   /**< Callback do pacote */
+    void *arg;              /**< Argumento de `cb` */
+    uint16_t pkt_id;        /**< ID do pacote */
+    bool refused;           /**< Algum filtro recusado no SUBACK (0x80) */
+    bool busy;              /**< Vaga em uso */
+} mqtt_sub_pkt_t;
+
+/**
+ * Quantidade máxima de mensagens aguardando envio na fila de publicação.
+ */
+#ifndef MQTT_PUB_QUEUE_LEN
+#define MQTT_PUB_QUEUE_LEN 16
+#endif
+
+/**
+ * Tamanho da arena estática que guarda tópico e payload das mensagens enfileiradas.
+ */
+#ifndef MQTT_PUB_ARENA_SIZE
+#define MQTT_PUB_ARENA_SIZE (MQTT_RAM_SCALE * MQTT_OUTPUT_RINGBUF_SIZE)
+#endif
+
+#if MQTT_PUB_QUEUE_LEN > 255 || MQTT_PUB_ARENA_SIZE > 65535
+#error "MQTT_PUB_QUEUE_LEN deve ser <= 255 e MQTT_PUB_ARENA_SIZE <= 65535"
+#endif
+
+/**
+ * @brief Mensagem aguardando envio na fila de publicação.
+ */
+typedef struct mqtt_pub_entry_t {
+    const char *topic;  /**< Tópico (cópia na arena ou string estável da tabela de tópicos) */
+    uint16_t offset;    /**< Início da alocação na arena */
+    uint16_t size;      /**< Bytes ocupados na arena (tópico copiado + payload) */
+    uint16_t data;      /**< Posição do payload na arena */
+    uint16_t len;       /**< Tamanho do payload */
+    uint8_t qos;        /**< QoS da publicação */
+    bool retain;        /**< Flag de retenção */
+    bool dead;          /**< Substituída por uma mensagem mais nova do mesmo tópico */
+    bool keep;          /**< Nunca substituída nem usada na coalescência */
+    bool sent;          /**< Entregue ao lwIP e retida até a confirmação (sessão persistente) */
+    bool pubrec;        /**< PUBREC recebido: a retransmissão é só o PUBREL (QoS 2) */
+    uint16_t pkt_id;    /**< ID do pacote atribuído no primeiro envio (0 se ainda não enviada) */
+} mqtt_pub_entry_t;
+
+/**
+ * @brief Contadores da fila de publicação.
+ */
+typedef struct mqtt_pub_stats_t {
+    uint32_t enqueued;      /**< Mensagens aceitas na fila */
+    uint32_t sent;          /**< Mensagens entregues ao lwIP */
+    uint32_t completed;     /**< Publicações concluídas (enviadas ou confirmadas pelo broker) */
+    uint32_t failed;        /**< Publicações concluídas com erro (ex.: timeout de PUBACK) */
+    uint32_t dropped;       /**< Mensagens descartadas por falta de espaço na fila ou na arena */
+    uint32_t coalesced;     /**< Mensagens substituídas por uma mais nova do mesmo tópico */
+    uint32_t retries;       /**< Tentativas de envio adiadas por ERR_MEM (fila de saída ou requisições cheias) */
+    uint16_t arena_high_water; /**< Maior ocupação da arena em bytes */
+    uint8_t high_water;     /**< Maior quantidade de mensagens enfileiradas */
+    uint8_t in_flight_high_water; /**< Maior quantidade de publicações em andamento no lwIP */
+} mqtt_pub_stats_t;
+
+/**
+ * @brief Publicação entregue ao lwIP e ainda não concluída.
+ *
+ * Cada publicação em andamento ocupa uma vaga, passada como argumento do callback de
+ * conclusão, o que permite medir a latência de cada uma mesmo quando os PUBACKs chegam
+ * fora de ordem.
+ */
+typedef struct mqtt_pub_slot_t {
+    struct mqtt_config_t *mqtt; /**< Cliente dono da vaga */
+    mqtt_pub_entry_t *entry;    /**< Mensagem retida pela sessão aguardando confirmação, ou NULL */
+    uint32_t sent_us;           /**< Instante da entrega ao lwIP (us desde o boot) */
+    uint8_t qos;                /**< QoS da publicação */
+    bool busy;                  /**< Vaga em uso */
+} mqtt_pub_slot_t;
+
+/**
+ * @brief Fila de publicação com arena estática.
+ *
+ * As mensagens são copiadas para a arena e entregues ao lwIP à medida que há
+ * espaço no buffer de saída e requisições livres (`MQTT_REQ_MAX_IN_FLIGHT`),
+ * voltando a drenar a cada publicação concluída.
+ */
+typedef struct mqtt_pub_queue_t {
+    mqtt_pub_entry_t entries[MQTT_PUB_QUEUE_LEN]; /**< Mensagens, em ordem de chegada */
+    uint8_t head;                                 /**< Mensagem mais antiga */
+    uint8_t count;                                /**< Mensagens na fila */
+    uint16_t rd;                                  /**< Início da alocação mais antiga na arena */
+    uint16_t wr;                                  /**< Próxima posição livre na arena */
+    uint8_t in_flight;                            /**< Publicações entregues ao lwIP e ainda não concluídas */
+    mqtt_pub_slot_t slots[MQTT_REQ_MAX_IN_FLIGHT]; /**< Vagas das publicações em andamento */
+    bool coalesce;                                /**< Se true, uma mensagem nova substitui a pendente do mesmo tópico */
+    bool held;                                    /**< Se true, as mensagens aguardam a próxima janela de `mqtt_power_t` */
+    mqtt_request_cb_t cb;                         /**< Callback opcional chamado a cada publicação concluída */
+    void *cb_arg;                                 /**< Argumento de `cb` */
+    mqtt_pub_stats_t stats;                       /**< Contadores da fila */
+    uint8_t arena[MQTT_PUB_ARENA_SIZE];           /**< Arena de tópicos e payloads */
+} mqtt_pub_queue_t;
+
+/**
+ * Quantidade máxima de tópicos na tabela de tópicos pré-montados.
+ */
+#ifndef MQTT_TOPIC_TABLE_LEN
+#define MQTT_TOPIC_TABLE_LEN 16
+#endif
+
+/**
+ * Tamanho do buffer que guarda os tópicos completos da tabela.
+ */
+#ifndef MQTT_TOPIC_POOL_SIZE
+#define MQTT_TOPIC_POOL_SIZE (MQTT_RAM_SCALE * 128)
+#endif
+
+/**
+ * @brief Handle de um tópico registrado com `mqtt_topic_register`.
+ */
+typedef int16_t mqtt_topic_t;
+
+#define MQTT_TOPIC_INVALID ((mqtt_topic_t)-1) /**< Handle retornado quando o registro falha */
+
+/**
+ * @brief Tópico pré-montado na tabela.
+ */
+typedef struct mqtt_topic_entry_t {
+    uint16_t offset;   /**< Posição do tópico completo em `pool` */
+    uint16_t name;     /**< Posição do nome base dentro do tópico completo */
+    uint16_t len;      /**< Tamanho do tópico completo */
+    bool compress;     /**< Publicações comprimidas (`mqtt_topic_compress`) */
+} mqtt_topic_entry_t;
+
+/**
+ * @brief Tabela de tópicos `<client_id>/<nome>` montados uma única vez.
+ *
+ * As strings são estáveis enquanto a estrutura existir, podendo ser usadas por
+ * várias publicações simultâneas sem cópia nem formatação.
+ */
+typedef struct mqtt_topics_t {
+    mqtt_topic_entry_t entries[MQTT_TOPIC_TABLE_LEN]; /**< Tópicos registrados */
+    char pool[MQTT_TOPIC_POOL_SIZE];                  /**< Textos dos tópicos completos */
+    uint16_t pool_used;                               /**< Bytes ocupados em `pool` */
+    uint8_t count;                                    /**< Tópicos registrados */
+} mqtt_topics_t;
+
+/**
+ * Atraso inicial e máximo (ms) entre tentativas de reconexão ao broker.
  */
-typedef struct mqtt_data_t {
-    char data[MQTT_OUTPUT_RINGBUF_SIZE]; /**< Buffer de dados para envio/recebimento MQTT */
-    char topic[MQTT_TOPIC_LEN];          /**< Tópico MQTT para publicação/assinatura */
-    uint32_t len;                        /**< Tamanho da string de dado recebida */
-} mqtt_data_t;
+#ifndef MQTT_BACKOFF_MIN_MS
+#define MQTT_BACKOFF_MIN_MS 1000
+#endif
+
+#ifndef MQTT_BACKOFF_MAX_MS
+#define MQTT_BACKOFF_MAX_MS 60000
+#endif
+
+/**
+ * @brief Estados da máquina de conexão do cliente MQTT.
+ */
+typedef enum {
+    MQTT_STATE_IDLE = 0,    /**< Cliente parado */
+    MQTT_STATE_RESOLVING,   /**< Aguardando a resolução DNS do broker */
+    MQTT_STATE_CONNECTING,  /**< Aguardando o CONNACK */
+    MQTT_STATE_SUBSCRIBING, /**< Reinscrevendo os filtros registrados */
+    MQTT_STATE_RUNNING,     /**< Conectado e inscrito */
+    MQTT_STATE_BACKOFF      /**< Aguardando para tentar novamente após uma falha */
+} mqtt_state_t;
+
+/**
+ * @brief Estado da conexão com o broker.
+ */
+typedef struct mqtt_conn_t {
+    mqtt_state_t state;                 /**< Estado atual */
+    const char *server;                 /**< Endereço ou hostname do broker */
+    mqtt_connection_cb_t conn_cb;       /**< Callback de conexão da aplicação */
+    mqtt_incoming_publish_cb_t pub_cb;  /**< Callback de publicação recebida */
+    mqtt_incoming_data_cb_t data_cb;    /**< Callback de dados recebidos */
+    dns_found_callback dns_cb;          /**< Callback de DNS da aplicação */
+    async_at_time_worker_t timer;       /**< Temporizador do backoff */
+    uint32_t attempts;                  /**< Falhas consecutivas desde a última conexão */
+    uint32_t reconnects;                /**< Conexões aceitas após a primeira */
+    uint32_t sessions;                  /**< Conexões aceitas no total */
+    uint32_t backoff_ms;                /**< Último atraso de backoff aplicado */
+    uint16_t pending_subs;              /**< Inscrições aguardando SUBACK */
+    bool cached_ip;                     /**< `server_ip` veio do cache de conexão: a primeira tentativa pula o DNS */
+} mqtt_conn_t;
+
+/**
+ * @brief Medições dos handshakes TLS, para comparar conexões com e sem retomada de sessão.
+ *
+ * Os tempos cobrem de `mqtt_client_connect` até o CONNACK (TCP + TLS + CONNECT). O heap é o
+ * do C alocado pelo mbedTLS, contado por `mqtt_tls_calloc`/`mqtt_tls_free`: o pico vai da
+ * abertura da conexão ao CONNACK e inclui os temporários do handshake (certificados, ECDH),
+ * além da configuração TLS, que permanece entre conexões.
+ */
+typedef struct mqtt_tls_stats_t {
+    uint32_t full;                  /**< Handshakes completos */
+    uint32_t resumed;               /**< Handshakes com sessão retomada */
+    uint32_t last_ms;               /**< Duração da última conexão */
+    uint32_t full_ms;               /**< Duração do último handshake completo */
+    uint32_t resumed_ms;            /**< Duração do último handshake retomado */
+    size_t heap_used;               /**< Heap do mbedTLS no CONNACK da última conexão */
+    size_t heap_peak;               /**< Pico de heap do mbedTLS na última conexão */
+    size_t full_heap_peak;          /**< Pico de heap do último handshake completo */
+    size_t resumed_heap_peak;       /**< Pico de heap do último handshake retomado */
+} mqtt_tls_stats_t;
+
+/**
+ * @brief Sessão TLS mantida entre reconexões.
+ */
+typedef struct mqtt_tls_t {
+    struct altcp_tls_session *session; /**< Última sessão negociada (ticket ou ID de sessão) */
+    bool session_valid;                /**< Se `session` pode ser oferecida ao broker */
+    bool resume;                       /**< Habilita a retomada de sessão (padrão: true) */
+    bool offered;                      /**< Se a sessão foi oferecida na conexão em andamento */
+    uint32_t session_tag;              /**< Impressão do segredo mestre da sessão guardada, para detectar a retomada */
+    absolute_time_t start;             /**< Início da conexão em andamento */
+    mqtt_tls_stats_t stats;            /**< Medições dos handshakes */
+} mqtt_tls_t;
+
+/**
+ * Quantidade de IDs de pacote recebidos lembrados para descartar retransmissões de QoS 1/2.
+ */
+#ifndef MQTT_SESSION_IN_WINDOW
+#define MQTT_SESSION_IN_WINDOW 16
+#endif
+
+/**
+ * @brief Sessão MQTT persistente entre reconexões.
+ *
+ * Publicações QoS 1/2 ficam retidas na fila de publicação até a confirmação do broker e são
+ * reenviadas com o mesmo ID de pacote após uma queda. Publicações recebidas com o flag DUP
+ * cujo ID já foi entregue são descartadas.
+ */
+typedef struct mqtt_session_t {
+    bool enabled;                            /**< Se a sessão persistente está ativa */
+    bool clean;                              /**< Flag clean session enviado no CONNECT */
+    uint16_t in_ids[MQTT_SESSION_IN_WINDOW]; /**< IDs das últimas publicações QoS 1/2 recebidas */
+    uint8_t in_pos;                          /**< Próxima posição de `in_ids` a sobrescrever */
+    uint32_t retransmits;                    /**< Publicações reenviadas com o ID original */
+    uint32_t duplicates;                     /**< Publicações recebidas descartadas como duplicatas */
+} mqtt_session_t;
+
+/**
+ * @brief Inspeção das confirmações recebidas (PUBACK, PUBREC, PUBCOMP e SUBACK), que o lwIP
+ *        trata sem avisar a aplicação.
+ */
+typedef struct mqtt_acks_t {
+    altcp_recv_fn recv;         /**< Callback de recepção do lwIP, chamado após a inspeção dos pacotes */
+    uint32_t rx_skip;           /**< Bytes restantes do pacote recebido atual */
+    uint32_t rx_len;            /**< Tamanho restante sendo decodificado */
+    uint8_t rx_shift;           /**< Deslocamento do próximo byte do tamanho */
+    uint8_t rx_type;            /**< Tipo do pacote recebido atual */
+    bool rx_in_len;             /**< Se o tamanho do pacote atual está sendo decodificado */
+    uint8_t rx_pos;             /**< Bytes já lidos do ID de pacote (2: lido ou sem ID) */
+    uint16_t rx_pkt_id;         /**< ID de pacote da confirmação atual */
+} mqtt_acks_t;
+
+/**
+ * Quantidade de faixas dos histogramas de latência: a faixa 0 conta latências abaixo de 1 ms,
+ * a faixa `i` latências em [2^(i-1), 2^i) ms e a última tudo acima disso.
+ */
+#ifndef MQTT_METRICS_HIST_LEN
+#define MQTT_METRICS_HIST_LEN 12
+#endif
+
+/**
+ * Tópico padrão do snapshot de métricas (passa por `mqtt_topic_register`).
+ */
+#ifndef MQTT_METRICS_TOPIC
+#define MQTT_METRICS_TOPIC "sys/metrics"
+#endif
+
+#define MQTT_METRICS_VERSION 1 /**< Versão do formato binário do snapshot */
+
+/**
+ * @brief Métricas do cliente e da rede, publicadas periodicamente como snapshot binário.
+ *
+ * Os histogramas e as medições de PINGREQ cobrem o intervalo desde o último snapshot
+ * publicado; os demais contadores (reconexões, fila, lwIP) são acumulados.
+ */
+typedef struct mqtt_metrics_t {
+    uint16_t pub_hist[3][MQTT_METRICS_HIST_LEN]; /**< Latência entrega ao lwIP → conclusão, por QoS */
+    uint32_t ping_sent_us;      /**< Instante do PINGREQ aguardando resposta */
+    bool ping_pending;          /**< Se há um PINGREQ aguardando PINGRESP */
+    uint16_t pings;             /**< PINGREQs enviados no intervalo */
+    uint16_t pongs;             /**< PINGRESPs recebidos no intervalo */
+    uint16_t rtt_last_ms;       /**< Último tempo de ida e volta do PINGREQ */
+    uint16_t rtt_min_ms;        /**< Menor tempo de ida e volta no intervalo */
+    uint16_t rtt_max_ms;        /**< Maior tempo de ida e volta no intervalo */
+    altcp_recv_fn recv;         /**< Callback de recepção do lwIP, chamado após a inspeção dos pacotes */
+    uint32_t rx_skip;           /**< Bytes restantes do pacote recebido atual */
+    uint32_t rx_len;            /**< Tamanho restante sendo decodificado */
+    uint8_t rx_shift;           /**< Deslocamento do próximo byte do tamanho */
+    uint8_t rx_type;            /**< Tipo do pacote recebido atual */
+    bool rx_in_len;             /**< Se o tamanho do pacote atual está sendo decodificado */
+    mqtt_topic_t topic;         /**< Tópico do snapshot */
+    uint32_t period_ms;         /**< Intervalo entre snapshots (0 = desativado) */
+    uint32_t snapshots;         /**< Snapshots publicados */
+    async_at_time_worker_t timer; /**< Temporizador dos snapshots */
+} mqtt_metrics_t;
+
+/**
+ * Profundidade máxima de mapas/arrays aninhados no codificador de telemetria
+ * (um bit por nível em `pending` e `indefinite`).
+ */
+#define MQTT_ENC_MAX_DEPTH 8
+
+/**
+ * @brief Formato de saída do codificador de telemetria.
+ */
+typedef enum {
+    MQTT_ENC_JSON = 0, /**< JSON mínimo, sem espaços */
+    MQTT_ENC_CBOR      /**< CBOR (RFC 8949) com tamanhos definidos */
+} mqtt_enc_format_t;
+
+/**
+ * @brief Codificador de payloads que escreve direto no buffer de saída, sem heap nem printf.
+ *
+ * Números com casas decimais são passados em ponto fixo (valor inteiro e quantidade de
+ * casas). Se o buffer acabar, `overflow` é marcado e as escritas seguintes são ignoradas.
+ */
+typedef struct mqtt_encoder_t {
+    uint8_t *buf;              /**< Buffer de saída */
+    uint16_t size;             /**< Tamanho de `buf` */
+    uint16_t len;              /**< Bytes escritos */
+    mqtt_enc_format_t format;  /**< Formato de saída */
+    uint8_t depth;             /**< Nível de aninhamento atual */
+    uint8_t pending;           /**< Bits por nível: 1 se o próximo item precisa de ',' (JSON) */
+    uint8_t indefinite;        /**< Bits por nível: 1 se o array tem tamanho indefinido (CBOR) */
+    bool key;                  /**< Se uma chave foi escrita e aguarda o valor (JSON) */
+    bool overflow;             /**< Se algum item não coube no buffer */
+} mqtt_encoder_t;
+
+/**
+ * Janela do compressor LZSS: distâncias de 8 bits, fixas no formato.
+ */
+#define MQTT_COMPRESS_WINDOW 256
+
+#define MQTT_COMPRESS_HEADER 3 /**< Método (1 byte) e tamanho original (2 bytes, big-endian) */
+
+/**
+ * @brief Método indicado no primeiro byte de um payload comprimido.
+ */
+typedef enum {
+    MQTT_COMPRESS_STORED = 0, /**< Payload sem compressão (não houve ganho) */
+    MQTT_COMPRESS_LZSS   = 1  /**< LZSS: grupos de 8 itens precedidos por um byte de flags */
+} mqtt_compress_method_t;
+
+/**
+ * @brief Contadores da compressão de payloads.
+ *
+ * A taxa de compressão é `tx_bytes / tx_raw` (envio) e `rx_bytes / rx_raw` (recepção).
+ */
+typedef struct mqtt_compress_stats_t {
+    uint32_t tx_messages;   /**< Publicações de tópicos com compressão */
+    uint32_t tx_stored;     /**< Publicações enviadas como `MQTT_COMPRESS_STORED`, sem ganho */
+    uint32_t tx_raw;        /**< Bytes antes da compressão */
+    uint32_t tx_bytes;      /**< Bytes publicados, com cabeçalho */
+    uint32_t tx_us;         /**< Tempo de CPU gasto comprimindo */
+    uint32_t rx_messages;   /**< Mensagens recebidas em rotas com compressão */
+    uint32_t rx_bytes;      /**< Bytes recebidos, com cabeçalho */
+    uint32_t rx_raw;        /**< Bytes entregues após a descompressão */
+    uint32_t rx_us;         /**< Tempo de CPU gasto descomprimindo (sem o dos handlers) */
+    uint32_t rx_errors;     /**< Mensagens malformadas, descartadas */
+} mqtt_compress_stats_t;
+
+/**
+ * @brief Estado do descompressor em fluxo: a mensagem é decodificada fragmento a fragmento.
+ */
+typedef struct mqtt_inflate_t {
+    uint8_t window[MQTT_COMPRESS_WINDOW]; /**< Últimos bytes produzidos (anel) */
+    uint32_t tot_len;       /**< Tamanho original, lido do cabeçalho */
+    uint32_t produced;      /**< Bytes produzidos */
+    uint8_t header;         /**< Bytes do cabeçalho já lidos */
+    uint8_t method;         /**< `mqtt_compress_method_t` */
+    uint8_t pos;            /**< Próxima posição de escrita em `window` */
+    uint8_t flushed;        /**< Início dos bytes de `window` ainda não entregues */
+    uint8_t flags;          /**< Flags restantes do grupo atual (1: referência, 0: literal) */
+    uint8_t items;          /**< Itens restantes do grupo atual */
+    bool match;             /**< Distância lida, aguardando o comprimento da referência */
+    uint8_t dist;           /**< Distância da referência em andamento, menos 1 */
+    bool error;             /**< Dados malformados: o restante da mensagem é ignorado */
+} mqtt_inflate_t;
+
+/**
+ * @brief Recebe os bytes produzidos pelo descompressor.
+ *
+ * @param[in] arg    Argumento de `mqtt_inflate_feed`.
+ * @param[in] offset Posição de `data` no payload original (0 na primeira chamada).
+ * @param[in] data   Bytes produzidos.
+ * @param[in] len    Tamanho de `data`.
+ * @param[in] last   Indica os últimos bytes da mensagem.
+ */
+typedef void (*mqtt_inflate_out_t)(void *arg, uint32_t offset, const uint8_t *data, uint32_t len, bool last);
+
+/**
+ * @brief Compressão de payloads: descompressor da mensagem recebida e contadores.
+ */
+typedef struct mqtt_compress_t {
+    mqtt_inflate_t inflate;         /**< Descompressão da mensagem recebida em andamento */
+    mqtt_compress_stats_t stats;    /**< Contadores */
+} mqtt_compress_t;
 
 /**
  * @brief Estrutura de configuração do cliente MQTT.
@@ -50,7 +651,18 @@ typedef struct mqtt_config_t {
     mqtt_client_t *client;          /**< Ponteiro para a estrutura do cliente MQTT */
     mqtt_client_info_t client_info; /**< Informações do cliente MQTT (ID, usuário, senha, etc.) */
     ip_addr_t server_ip;            /**< Endereço IP do broker MQTT */
-    mqtt_data_t data;               /**< Dados recebidos ou a serem enviados nos tópicos */
+    mqtt_rx_t rx;                   /**< Estado de recepção das mensagens nos tópicos inscritos */
+    mqtt_router_t router;           /**< Filtros inscritos e seus handlers */
+    mqtt_sub_op_t sub_ops[MQTT_SUB_OPS]; /**< Inscrições em lote aguardando confirmação */
+    mqtt_sub_pkt_t sub_pkts[MQTT_REQ_MAX_IN_FLIGHT]; /**< Pacotes de inscrição aguardando SUBACK/UNSUBACK */
+    mqtt_pub_queue_t pub_queue;     /**< Fila de publicação */
+    mqtt_conn_t conn;               /**< Máquina de estados da conexão */
+    mqtt_topics_t topics;           /**< Tabela de tópicos pré-montados */
+    mqtt_tls_t tls;                 /**< Sessão TLS e medições dos handshakes */
+    mqtt_metrics_t metrics;         /**< Métricas do cliente e da rede */
+    mqtt_session_t session;         /**< Sessão persistente (QoS 1/2 entre reconexões) */
+    mqtt_acks_t acks;               /**< Inspeção das confirmações recebidas */
+    mqtt_compress_t compress;       /**< Compressão de payloads por tópico */
     bool connect_done;              /**< Indica se a conexão com o broker foi concluída */
     int sub_count;                  /**< Contagem de tópicos inscritos */
     bool stop_client;               /**< Flag para indicar parada do cliente MQTT */
@@ -60,6 +672,469 @@ typedef struct mqtt_config_t {
     bool unique_topic;              /**< Se true, adiciona o nome do cliente aos tópicos, permitindo múltiplos dispositivos no mesmo broker */
 } mqtt_config_t;
 
+/**
+ * Tamanho do buffer de cada lote de telemetria (limite do payload publicado).
+ */
+#ifndef MQTT_BATCH_BUF_SIZE
+#define MQTT_BATCH_BUF_SIZE 256
+#endif
+
+/**
+ * @brief Contadores de um lote de telemetria.
+ */
+typedef struct mqtt_batch_stats_t {
+    uint32_t samples;       /**< Amostras aceitas */
+    uint32_t publishes;     /**< Lotes publicados */
+    uint32_t by_count;      /**< Lotes fechados pelo limite de amostras */
+    uint32_t by_bytes;      /**< Lotes fechados pelo limite de bytes */
+    uint32_t by_deadline;   /**< Lotes fechados pelo prazo máximo */
+    uint32_t dropped;       /**< Amostras perdidas (fila de publicação cheia ou amostra maior que o lote) */
+} mqtt_batch_stats_t;
+
+/**
+ * @brief Lote de amostras de um fluxo de telemetria, publicado como uma única mensagem.
+ *
+ * As amostras são codificadas direto no buffer do lote, no formato
+ * `{"t0":<ms desde o boot>,"s":[[dt,valor],...]}` (JSON ou CBOR equivalente), com
+ * `dt` em ms relativo a `t0` e o valor em ponto fixo.
+ */
+typedef struct mqtt_batch_t {
+    struct mqtt_config_t *mqtt;     /**< Cliente usado na publicação */
+    mqtt_topic_t topic;             /**< Tópico do fluxo */
+    uint8_t decimals;               /**< Casas decimais dos valores */
+    uint16_t max_samples;           /**< Publica ao atingir esta quantidade de amostras */
+    uint16_t max_bytes;             /**< Publica antes de o payload passar deste tamanho */
+    uint32_t max_latency_ms;        /**< Publica quando a amostra mais antiga atinge esta idade */
+    uint16_t count;                 /**< Amostras no lote atual */
+    uint32_t t0;                    /**< Instante da primeira amostra do lote (ms desde o boot) */
+    mqtt_encoder_t enc;             /**< Codificador sobre `buf` */
+    async_at_time_worker_t timer;   /**< Temporizador do prazo máximo */
+    mqtt_batch_stats_t stats;       /**< Contadores */
+    uint8_t buf[MQTT_BATCH_BUF_SIZE]; /**< Payload em construção */
+} mqtt_batch_t;
+
+/**
+ * Vagas do anel de publicações do núcleo 0 para o núcleo da rede (potência de 2).
+ */
+#ifndef MQTT_DUAL_TX_LEN
+#define MQTT_DUAL_TX_LEN 8
+#endif
+
+/**
+ * Maior payload publicado pelo núcleo 0 no modo de dois núcleos.
+ */
+#ifndef MQTT_DUAL_TX_SIZE
+#define MQTT_DUAL_TX_SIZE 128
+#endif
+
+/**
+ * Vagas do anel de mensagens recebidas, do núcleo da rede para o núcleo 0 (potência de 2).
+ */
+#ifndef MQTT_DUAL_RX_LEN
+#define MQTT_DUAL_RX_LEN 4
+#endif
+
+/**
+ * Bytes de cada vaga de mensagem recebida (tópico e payload, cada um com '\0').
+ * Payloads maiores são entregues em fragmentos.
+ */
+#ifndef MQTT_DUAL_RX_SIZE
+#define MQTT_DUAL_RX_SIZE 256
+#endif
+
+#if (MQTT_DUAL_TX_LEN & (MQTT_DUAL_TX_LEN - 1)) || (MQTT_DUAL_RX_LEN & (MQTT_DUAL_RX_LEN - 1))
+#error "MQTT_DUAL_TX_LEN e MQTT_DUAL_RX_LEN devem ser potências de 2"
+#endif
+
+/**
+ * @brief Publicação enfileirada pelo núcleo 0.
+ */
+typedef struct mqtt_dual_tx_t {
+    mqtt_topic_t topic;               /**< Tópico registrado com `mqtt_topic_register` */
+    uint16_t len;                     /**< Tamanho do payload */
+    uint8_t data[MQTT_DUAL_TX_SIZE];  /**< Payload */
+} mqtt_dual_tx_t;
+
+/**
+ * @brief Mensagem recebida (ou fragmento dela) aguardando entrega no núcleo 0.
+ */
+typedef struct mqtt_dual_rx_t {
+    mqtt_payload_cb_t handler;      /**< Handler escolhido pelo roteador */
+    void *arg;                      /**< Argumento do handler */
+    uint32_t tot_len;               /**< Tamanho total do payload */
+    uint32_t offset;                /**< Posição do fragmento no payload */
+    uint16_t data;                  /**< Posição do fragmento em `buf` (após o tópico) */
+    uint16_t len;                   /**< Tamanho do fragmento */
+    bool last;                      /**< Último fragmento da mensagem */
+    char buf[MQTT_DUAL_RX_SIZE];    /**< Tópico e fragmento, cada um terminado em '\0' */
+} mqtt_dual_rx_t;
+
+/**
+ * @brief Contadores do modo de dois núcleos.
+ */
+typedef struct mqtt_dual_stats_t {
+    uint32_t tx_accepted;   /**< Publicações aceitas no anel pelo núcleo 0 */
+    uint32_t tx_dropped;    /**< Publicações recusadas (anel cheio ou payload maior que `MQTT_DUAL_TX_SIZE`) */
+    uint32_t tx_queued;     /**< Publicações repassadas à fila de publicação pelo núcleo da rede */
+    uint32_t rx_delivered;  /**< Fragmentos entregues aos handlers no núcleo 0 */
+    uint32_t rx_dropped;    /**< Fragmentos perdidos por anel cheio */
+} mqtt_dual_stats_t;
+
+/**
+ * @brief Callback de inicialização da rede, executado no núcleo 1 após `cyw43_arch_init`.
+ *
+ * Deve conectar o Wi-Fi e chamar `mqtt_start_client`.
+ */
+typedef void (*mqtt_net_setup_cb_t)(struct mqtt_config_t *mqtt, void *arg);
+
+/**
+ * @brief Modo de dois núcleos: lwIP, CYW43 e TLS no núcleo 1; aplicação no núcleo 0.
+ *
+ * Os dois núcleos se comunicam apenas por anéis de produtor único e consumidor único, sem
+ * travas: cada índice é escrito por um único núcleo.
+ */
+typedef struct mqtt_dual_t {
+    struct mqtt_config_t *mqtt;          /**< Cliente, operado apenas pelo núcleo 1 após o início */
+    mqtt_net_setup_cb_t setup;          /**< Inicialização da rede no núcleo 1 */
+    void *setup_arg;                     /**< Argumento de `setup` */
+    volatile bool ready;                 /**< Núcleo 1 inicializado e atendendo os anéis */
+    volatile bool failed;                /**< Falha em `cyw43_arch_init` no núcleo 1 */
+    volatile uint32_t tx_head;           /**< Próxima vaga a escrever em `tx` (núcleo 0) */
+    volatile uint32_t tx_tail;           /**< Próxima vaga a ler de `tx` (núcleo 1) */
+    volatile uint32_t rx_head;           /**< Próxima vaga a escrever em `rx` (núcleo 1) */
+    volatile uint32_t rx_tail;           /**< Próxima vaga a ler de `rx` (núcleo 0) */
+    mqtt_dual_stats_t stats;             /**< Contadores (tx_accepted/tx_dropped/rx_delivered: núcleo 0; demais: núcleo 1) */
+    mqtt_dual_tx_t tx[MQTT_DUAL_TX_LEN]; /**< Anel de publicações */
+    mqtt_dual_rx_t rx[MQTT_DUAL_RX_LEN]; /**< Anel de mensagens recebidas */
+} mqtt_dual_t;
+
+/**
+ * Bytes reservados no cache de conexão para a sessão TLS serializada (0 desativa; 1024 basta
+ * para uma sessão com ticket).
+ *
+ * Desativado por padrão: a sessão serializada contém o segredo mestre em claro, e a flash do
+ * RP2040 não é cifrada. Quem ler a flash (SWD, BOOTSEL ou a placa extraída) decifra o tráfego
+ * gravado de qualquer conexão que use essa sessão e pode retomá-la no lugar do dispositivo até
+ * o broker descartar o ticket/ID. Ative só se o ganho no handshake compensar essa exposição.
+ */
+#ifndef MQTT_CACHE_TLS_SIZE
+#define MQTT_CACHE_TLS_SIZE 0
+#endif
+
+/**
+ * Tempo máximo da associação rápida (BSSID e canal do cache) antes de voltar à varredura.
+ */
+#ifndef MQTT_CACHE_JOIN_MS
+#define MQTT_CACHE_JOIN_MS 3000
+#endif
+
+#define MQTT_CACHE_VERSION 1 /**< Versão do formato gravado na flash */
+
+/**
+ * @brief Última associação Wi-Fi e concessão DHCP.
+ */
+typedef struct mqtt_cache_net_t {
+    char ssid[33];          /**< Rede a que o registro se aplica */
+    uint8_t bssid[6];       /**< Ponto de acesso */
+    uint8_t channel;        /**< Canal do ponto de acesso (0 se desconhecido) */
+    uint32_t ip;            /**< Endereço concedido pelo DHCP */
+    uint32_t netmask;       /**< Máscara de rede */
+    uint32_t gw;            /**< Gateway */
+    uint32_t dns;           /**< Servidor DNS */
+} mqtt_cache_net_t;
+
+/**
+ * @brief Último endereço resolvido do broker.
+ */
+typedef struct mqtt_cache_broker_t {
+    char name[64];          /**< Hostname do broker */
+    uint32_t ip;            /**< Endereço IPv4 resolvido */
+} mqtt_cache_broker_t;
+
+/**
+ * @brief Registro gravado no último setor da flash.
+ */
+typedef struct mqtt_cache_record_t {
+    uint32_t crc;                       /**< FNV-1a dos campos seguintes */
+    uint32_t magic;                     /**< Identifica o registro */
+    uint16_t version;                   /**< `MQTT_CACHE_VERSION` */
+    uint16_t size;                      /**< Tamanho do registro (muda com `MQTT_CACHE_TLS_SIZE`) */
+    mqtt_cache_net_t net;               /**< Associação e concessão */
+    mqtt_cache_broker_t broker;         /**< Broker */
+    uint16_t tls_len;                   /**< Tamanho da sessão TLS serializada (0 se ausente) */
+#if MQTT_CACHE_TLS_SIZE
+    uint8_t tls[MQTT_CACHE_TLS_SIZE];   /**< Sessão TLS (`mbedtls_ssl_session_save`) */
+#endif
+} mqtt_cache_record_t;
+
+/**
+ * @brief Cache de conexão persistido na flash, para religar rápido após o boot ou o sono.
+ */
+typedef struct mqtt_cache_t {
+    mqtt_cache_record_t record; /**< Cópia em RAM do registro */
+    bool valid;                 /**< `record` foi carregado da flash e é válido */
+    uint32_t wifi_hits;         /**< Associações rápidas bem-sucedidas */
+    uint32_t wifi_misses;       /**< Associações rápidas que falharam (seguidas da varredura completa) */
+    uint32_t writes;            /**< Gravações na flash */
+} mqtt_cache_t;
+
+/**
+ * Setores da flash reservados ao log de telemetria, logo abaixo do setor do cache de conexão.
+ */
+#ifndef MQTT_FLOG_SECTORS
+#define MQTT_FLOG_SECTORS 16
+#endif
+
+/**
+ * Publicações por segundo reenviadas do log após a reconexão.
+ */
+#ifndef MQTT_FLOG_REPLAY_RATE
+#define MQTT_FLOG_REPLAY_RATE 20
+#endif
+
+#define MQTT_FLOG_PAGE_SIZE 256 /**< Página da flash: unidade de gravação do log */
+
+#if MQTT_FLOG_SECTORS < 2
+#error "MQTT_FLOG_SECTORS deve ser ao menos 2"
+#endif
+
+/**
+ * @brief Contadores do log de telemetria.
+ */
+typedef struct mqtt_flog_stats_t {
+    uint32_t appended;      /**< Registros gravados no log */
+    uint32_t replayed;      /**< Registros reenviados pela fila de publicação */
+    uint32_t dropped;       /**< Registros recusados (maiores que um setor, falha da flash ou, conectado, próximo setor não apagado) */
+    uint32_t overwritten;   /**< Setores ainda não reenviados sobrescritos com o log cheio */
+    uint32_t corrupt;       /**< Registros com CRC inválido, ignorados no reenvio */
+    uint32_t erases;        /**< Setores apagados */
+    uint32_t programs;      /**< Páginas gravadas */
+} mqtt_flog_stats_t;
+
+/**
+ * @brief Log de telemetria em anel na flash (store-and-forward).
+ *
+ * Posições são dadas por setor do anel e deslocamento dentro dele. A página em escrita fica
+ * em `page` até encher (ou até `mqtt_flog_sync`).
+ */
+typedef struct mqtt_flog_t {
+    struct mqtt_config_t *mqtt;         /**< Cliente usado no reenvio */
+    uint32_t seq;                       /**< Sequência do setor de escrita (a maior do anel) */
+    uint16_t head_sector;               /**< Setor de escrita */
+    uint16_t head_off;                  /**< Próximo byte a escrever no setor */
+    uint16_t flash_off;                 /**< Bytes do setor de escrita já gravados na flash */
+    uint16_t tail_sector;               /**< Setor do próximo registro a reenviar */
+    uint16_t tail_off;                  /**< Posição do próximo registro a reenviar */
+    uint16_t erased;                    /**< Setor apagado antecipadamente (ou `MQTT_FLOG_SECTORS`) */
+    absolute_time_t next_replay;        /**< Próximo reenvio permitido pelo limite de taxa */
+    uint8_t page[MQTT_FLOG_PAGE_SIZE];  /**< Página em escrita */
+    mqtt_flog_stats_t stats;            /**< Contadores */
+} mqtt_flog_t;
+
+#define MQTT_BUDGET_MAGIC   0x4742514D /**< "MQBG": identifica `mqtt_budget_config` no ELF */
+#define MQTT_BUDGET_VERSION 2          /**< Versão do layout de `mqtt_budget_config_t` */
+
+/**
+ * @brief Configuração de memória com que o firmware foi compilado.
+ *
+ * Gravada em `mqtt_budget_config` e lida do ELF por `tools/mqtt_budget.py`, que soma a RAM
+ * estática do mapa de ligação e estima o pico dinâmico. Todos os campos têm 32 bits, para
+ * que o script não dependa do alinhamento do compilador.
+ */
+typedef struct mqtt_budget_config_t {
+    uint32_t magic;             /**< `MQTT_BUDGET_MAGIC` */
+    uint32_t version;           /**< `MQTT_BUDGET_VERSION` */
+    uint32_t profile;           /**< Perfil de RAM: 0 padrão, 1 `MQTT_RAM_PROFILE_LOW`, 2 `MQTT_RAM_PROFILE_MIN` */
+    uint32_t config_size;       /**< sizeof(mqtt_config_t) */
+    uint32_t output_ringbuf;    /**< `MQTT_OUTPUT_RINGBUF_SIZE` (duas vezes em `mqtt_client_t`) */
+    uint32_t lwip_heap;         /**< `MEM_SIZE` (0 com `MEM_LIBC_MALLOC`) */
+    uint32_t pbuf_pool;         /**< `PBUF_POOL_SIZE` */
+    uint32_t pbuf_bufsize;      /**< `PBUF_POOL_BUFSIZE` */
+    uint32_t tcp_seg;           /**< `MEMP_NUM_TCP_SEG` */
+    uint32_t tcp_mss;           /**< `TCP_MSS` */
+    uint32_t tcp_wnd;           /**< `TCP_WND` */
+    uint32_t tcp_snd_buf;       /**< `TCP_SND_BUF` */
+    uint32_t tls_in;            /**< `MBEDTLS_SSL_IN_CONTENT_LEN` (0 sem TLS) */
+    uint32_t tls_out;           /**< `MBEDTLS_SSL_OUT_CONTENT_LEN` (0 sem TLS) */
+    uint32_t tls_heap;          /**< Estimativa do pico de heap do C do mbedTLS em um handshake completo */
+    uint32_t lwip_fixed;        /**< Heap do lwIP ocupado pelo cliente MQTT e pelo estado do TLS */
+    uint32_t tcp_segment;       /**< Heap do lwIP ocupado por um segmento TCP de saída */
+} mqtt_budget_config_t;
+
+/**
+ * @brief Uso de memória da pilha de rede: valores atuais e picos desde o boot.
+ *
+ * Os campos do lwIP exigem `MEM_STATS` e `MEMP_STATS`; sem eles, ficam em zero. Os do mbedTLS
+ * ficam em zero até o primeiro CONNACK sobre TLS.
+ */
+typedef struct mqtt_budget_usage_t {
+    uint32_t lwip_heap_used;    /**< Heap do lwIP em uso */
+    uint32_t lwip_heap_high;    /**< Pico do heap do lwIP */
+    uint32_t lwip_heap_size;    /**< Tamanho do heap do lwIP */
+    uint32_t lwip_heap_err;     /**< Alocações recusadas pelo heap do lwIP */
+    uint32_t pools_used;        /**< Bytes em uso somando todos os pools (memp) */
+    uint32_t pools_high;        /**< Soma dos picos de cada pool, em bytes */
+    uint32_t pools_size;        /**< Bytes reservados para os pools */
+    uint32_t pools_err;         /**< Alocações recusadas por pools esgotados */
+    uint16_t pbuf_used;         /**< pbufs do pool em uso */
+    uint16_t pbuf_high;         /**< Pico de pbufs do pool */
+    uint16_t pbuf_total;        /**< `PBUF_POOL_SIZE` */
+    uint16_t tcp_seg_high;      /**< Pico de segmentos TCP */
+    uint32_t tls_heap_used;     /**< Heap do C alocado pelo mbedTLS agora */
+    uint32_t tls_heap_high;     /**< Pico do heap do mbedTLS desde o boot, handshakes incluídos */
+    uint32_t tls_heap_budget;   /**< Pico estimado por `mqtt_budget.py` (`mqtt_budget_config_t.tls_heap`) */
+} mqtt_budget_usage_t;
+
+extern const mqtt_budget_config_t mqtt_budget_config;
+
+/**
+ * Lotes (`mqtt_batch_t`) esvaziados a cada janela do agendador de energia.
+ */
+#ifndef MQTT_POWER_BATCHES
+#define MQTT_POWER_BATCHES 4
+#endif
+
+/**
+ * Modo de economia do CYW43 durante as janelas (`cyw43_wifi_pm`).
+ */
+#ifndef MQTT_POWER_PM_AWAKE
+#define MQTT_POWER_PM_AWAKE CYW43_PERFORMANCE_PM
+#endif
+
+/**
+ * Modo de economia do CYW43 entre as janelas: o rádio dorme entre beacons, e o AP guarda os
+ * quadros recebidos até o próximo DTIM, de modo que comandos do broker só atrasam.
+ */
+#ifndef MQTT_POWER_PM_SLEEP
+#define MQTT_POWER_PM_SLEEP CYW43_AGGRESSIVE_PM
+#endif
+
+/**
+ * @brief Contadores do agendador de energia.
+ */
+typedef struct mqtt_power_stats_t {
+    uint32_t windows;           /**< Janelas abertas */
+    uint32_t overruns;          /**< Janelas fechadas pelo prazo com publicações pendentes */
+    uint32_t pings;             /**< PINGREQs enviados em janelas sem outro tráfego */
+    uint32_t wakes;             /**< Janelas antecipadas por `mqtt_power_wake` */
+    uint64_t radio_on_us;       /**< Tempo total em `MQTT_POWER_PM_AWAKE` */
+    uint32_t radio_on_ms_hour;  /**< Tempo em `MQTT_POWER_PM_AWAKE` na última hora completa */
+} mqtt_power_stats_t;
+
+/**
+ * @brief Agendador de energia: concentra o tráfego em janelas periódicas.
+ */
+typedef struct mqtt_power_t {
+    struct mqtt_config_t *mqtt;                 /**< Cliente agendado */
+    uint32_t period_ms;                         /**< Intervalo entre o início de janelas */
+    uint32_t window_ms;                         /**< Duração máxima de uma janela */
+    mqtt_batch_t *batches[MQTT_POWER_BATCHES];  /**< Lotes esvaziados a cada janela */
+    uint8_t batch_count;                        /**< Lotes em `batches` */
+    bool awake;                                 /**< Janela aberta */
+    absolute_time_t started;                    /**< Instante de `mqtt_power_start` */
+    absolute_time_t window_start;               /**< Início da janela atual (ou da última) */
+    absolute_time_t hour_start;                 /**< Início da hora em contabilização */
+    uint64_t hour_on_us;                        /**< Tempo em `MQTT_POWER_PM_AWAKE` na hora atual */
+    async_at_time_worker_t timer;               /**< Abre e fecha as janelas */
+    mqtt_power_stats_t stats;                   /**< Contadores */
+} mqtt_power_t;
+
+#ifdef MQTT_PICO_FREERTOS
+/**
+ * Maior payload publicado ou recebido pelas filas da variante FreeRTOS (e maior filtro inscrito).
+ */
+#ifndef MQTT_RTOS_MSG_SIZE
+#define MQTT_RTOS_MSG_SIZE 128
+#endif
+
+/**
+ * Tamanho máximo do tópico de uma mensagem recebida pelas filas da variante FreeRTOS.
+ */
+#ifndef MQTT_RTOS_TOPIC_SIZE
+#define MQTT_RTOS_TOPIC_SIZE 64
+#endif
+
+/**
+ * Comandos (publicações e inscrições) aguardando a tarefa de rede.
+ */
+#ifndef MQTT_RTOS_CMD_LEN
+#define MQTT_RTOS_CMD_LEN 8
+#endif
+
+/**
+ * Intervalo máximo (ms) entre chamadas a `cyw43_arch_poll` na tarefa de rede. 0 (padrão)
+ * bloqueia a tarefa até o próximo comando, pois no Pico o lwIP roda na própria thread.
+ */
+#ifndef MQTT_RTOS_POLL_MS
+#define MQTT_RTOS_POLL_MS 0
+#endif
+
+#ifndef MQTT_RTOS_TASK_STACK
+#define MQTT_RTOS_TASK_STACK 1024 // palavras
+#endif
+
+#define MQTT_RTOS_NOTIFY_RX     (1u << 0) /**< Bit de notificação: mensagem na fila de uma inscrição */
+#define MQTT_RTOS_NOTIFY_SUBACK (1u << 1) /**< Bit de notificação: resultado de `mqtt_rtos_subscribe` */
+
+/**
+ * @brief Tipos de comando enviados à tarefa de rede.
+ */
+typedef enum {
+    MQTT_RTOS_CMD_PUBLISH = 0,  /**< Publicar em um tópico registrado */
+    MQTT_RTOS_CMD_SUBSCRIBE,    /**< Registrar a rota e inscrever o filtro */
+    MQTT_RTOS_CMD_UNSUBSCRIBE   /**< Remover a rota e a inscrição */
+} mqtt_rtos_cmd_type_t;
+
+struct mqtt_rtos_sub_t;
+
+/**
+ * @brief Comando copiado para a fila da tarefa de rede.
+ */
+typedef struct mqtt_rtos_cmd_t {
+    mqtt_rtos_cmd_type_t type;      /**< Tipo do comando */
+    mqtt_topic_t topic;             /**< Tópico da publicação */
+    uint16_t len;                   /**< Tamanho do payload ou do filtro (sem '\0') */
+    struct mqtt_rtos_sub_t *sub;    /**< Inscrição (SUBSCRIBE) */
+    uint8_t data[MQTT_RTOS_MSG_SIZE + 1]; /**< Payload ou filtro terminado em '\0' */
+} mqtt_rtos_cmd_t;
+
+/**
+ * @brief Mensagem recebida, entregue pela fila de uma inscrição.
+ */
+typedef struct mqtt_rtos_msg_t {
+    char topic[MQTT_RTOS_TOPIC_SIZE];     /**< Tópico, terminado em '\0' (truncado se necessário) */
+    uint32_t tot_len;                     /**< Tamanho do payload publicado */
+    uint16_t len;                         /**< Bytes em `data` (menor que `tot_len` se truncado) */
+    uint8_t data[MQTT_RTOS_MSG_SIZE + 1]; /**< Payload, terminado em '\0' */
+} mqtt_rtos_msg_t;
+
+/**
+ * @brief Inscrição de uma tarefa: fila das mensagens e tarefa notificada.
+ */
+typedef struct mqtt_rtos_sub_t {
+    struct mqtt_rtos_t *rtos;   /**< Variante dona da inscrição */
+    QueueHandle_t queue;        /**< Fila de `mqtt_rtos_msg_t` */
+    TaskHandle_t task;          /**< Tarefa notificada a cada mensagem e no SUBACK */
+    volatile err_t result;      /**< Resultado do SUBACK */
+    uint32_t received;          /**< Mensagens entregues na fila */
+    uint32_t dropped;           /**< Mensagens descartadas com a fila cheia */
+} mqtt_rtos_sub_t;
+
+/**
+ * @brief Variante FreeRTOS: tarefa de rede dona do cliente, alimentada por uma fila de comandos.
+ */
+typedef struct mqtt_rtos_t {
+    struct mqtt_config_t *mqtt;     /**< Cliente, operado apenas pela tarefa de rede */
+    mqtt_net_setup_cb_t setup;     /**< Inicialização da rede, na tarefa de rede */
+    void *setup_arg;                /**< Argumento de `setup` */
+    QueueHandle_t cmds;             /**< Fila de `mqtt_rtos_cmd_t` */
+    TaskHandle_t task;              /**< Tarefa de rede */
+    TaskHandle_t starter;           /**< Tarefa aguardando o fim da inicialização */
+    volatile bool ready;            /**< Inicialização concluída */
+    mqtt_rtos_msg_t rx;             /**< Mensagem em montagem nos handlers das inscrições */
+} mqtt_rtos_t;
+#endif // MQTT_PICO_FREERTOS
+
 /**
  * @brief Ações possíveis para gerenciar tópicos MQTT.
  */
@@ -68,21 +1143,238 @@ typedef enum {
     MQTT_SUBSCRIBE   = 1  /**< Inscrever em um tópico */
 } mqtt_action_t;
 
+void mqtt_config_init(mqtt_config_t *mqtt);
+
 void mqtt_tls(mqtt_config_t *mqtt);
 
 bool mqtt_start_client(
     mqtt_config_t *mqtt,
-    char *server,
+    const char *server,
     mqtt_connection_cb_t conn_cb,
     mqtt_incoming_publish_cb_t pub_cb,
     mqtt_incoming_data_cb_t data_cb,
     dns_found_callback dns_cb
 );
 
+void mqtt_stop_client(mqtt_config_t *mqtt);
+
 char *mqtt_full_topic(mqtt_config_t *mqtt, char *name);
 
+mqtt_topic_t mqtt_topic_register(mqtt_config_t *mqtt, const char *name);
+
+const char *mqtt_topic_str(const mqtt_config_t *mqtt, mqtt_topic_t topic);
+
 char *mqtt_generate_client_id(char *device_name);
 
+void mqtt_set_payload_handler(mqtt_config_t *mqtt, mqtt_payload_mode_t mode, mqtt_payload_cb_t cb, void *arg);
+
+void mqtt_incoming_publish(void *arg, const char *topic, u32_t tot_len);
+
+void mqtt_incoming_data(void *arg, const u8_t *data, u16_t len, u8_t flags);
+
 void mqtt_manage_topics(mqtt_config_t *mqtt, char **topics, size_t num_topics, mqtt_action_t action, mqtt_request_cb_t cb);
 
+void mqtt_manage_routes(mqtt_config_t *mqtt, const mqtt_route_t *routes, size_t num_routes, mqtt_action_t action, mqtt_request_cb_t cb);
+
+err_t mqtt_sub_batch(mqtt_config_t *mqtt, const char *const *filters, size_t count, mqtt_action_t action,
+                     mqtt_request_cb_t cb, void *arg, uint16_t *packets);
+
+mqtt_sub_op_t *mqtt_sub_op_begin(mqtt_config_t *mqtt, mqtt_request_cb_t cb, void *arg);
+
+void mqtt_sub_op_done(void *arg, err_t err);
+
+void mqtt_sub_suback(mqtt_config_t *mqtt, uint16_t pkt_id, uint8_t code);
+
+void mqtt_sub_release(mqtt_config_t *mqtt);
+
+void mqtt_queue_config(mqtt_config_t *mqtt, bool coalesce, mqtt_request_cb_t cb, void *arg);
+
+err_t mqtt_queue_publish(mqtt_config_t *mqtt, const char *topic, const void *payload, uint16_t len);
+
+err_t mqtt_queue_publish_topic(mqtt_config_t *mqtt, mqtt_topic_t topic, const void *payload, uint16_t len);
+
+err_t mqtt_queue_publish_keep(mqtt_config_t *mqtt, mqtt_topic_t topic, const void *payload, uint16_t len);
+
+void mqtt_queue_poll(mqtt_config_t *mqtt);
+
+void mqtt_queue_release_in_flight(mqtt_config_t *mqtt);
+
+void mqtt_queue_pubrec(mqtt_config_t *mqtt, uint16_t pkt_id);
+
+void mqtt_queue_late_ack(mqtt_config_t *mqtt, uint16_t pkt_id);
+
+void mqtt_session_config(mqtt_config_t *mqtt, bool clean_session);
+
+void mqtt_session_begin(mqtt_config_t *mqtt, uint16_t pkt_id_seq);
+
+bool mqtt_session_duplicate(mqtt_config_t *mqtt);
+
+void mqtt_acks_attach(mqtt_config_t *mqtt);
+
+bool mqtt_topic_compress(mqtt_config_t *mqtt, mqtt_topic_t topic, bool enable);
+
+uint16_t mqtt_compress(const uint8_t *in, uint16_t len, uint8_t *out, uint16_t size);
+
+const void *mqtt_compress_payload(mqtt_config_t *mqtt, mqtt_topic_t topic, const void *payload, uint16_t *len);
+
+void mqtt_inflate_begin(mqtt_inflate_t *z);
+
+void mqtt_inflate_feed(mqtt_inflate_t *z, const uint8_t *in, uint32_t len, bool last, mqtt_inflate_out_t out, void *arg);
+
+bool mqtt_metrics_start(mqtt_config_t *mqtt, const char *name, uint32_t period_ms);
+
+void mqtt_metrics_stop(mqtt_config_t *mqtt);
+
+uint16_t mqtt_metrics_snapshot(mqtt_config_t *mqtt, uint8_t *buf, uint16_t size);
+
+void mqtt_metrics_attach(mqtt_config_t *mqtt);
+
+void mqtt_metrics_pub_done(mqtt_config_t *mqtt, uint8_t qos, uint32_t latency_us);
+
+void mqtt_enc_init(mqtt_encoder_t *enc, mqtt_enc_format_t format, void *buf, uint16_t size);
+
+void mqtt_enc_map_begin(mqtt_encoder_t *enc, uint8_t count);
+
+void mqtt_enc_map_end(mqtt_encoder_t *enc);
+
+void mqtt_enc_array_begin(mqtt_encoder_t *enc, uint8_t count);
+
+void mqtt_enc_array_begin_indefinite(mqtt_encoder_t *enc);
+
+void mqtt_enc_array_end(mqtt_encoder_t *enc);
+
+void mqtt_enc_key(mqtt_encoder_t *enc, const char *key);
+
+void mqtt_enc_int(mqtt_encoder_t *enc, int32_t value);
+
+void mqtt_enc_fixed(mqtt_encoder_t *enc, int32_t value, uint8_t decimals);
+
+void mqtt_enc_float(mqtt_encoder_t *enc, float value, uint8_t decimals);
+
+void mqtt_enc_bool(mqtt_encoder_t *enc, bool value);
+
+void mqtt_enc_str(mqtt_encoder_t *enc, const char *str);
+
+uint16_t mqtt_enc_finish(mqtt_encoder_t *enc);
+
+#ifdef MQTT_PICO_AHT20
+void mqtt_enc_aht20(mqtt_encoder_t *enc, const AHT20_Data *data);
+
+void mqtt_enc_aht20_fixed(mqtt_encoder_t *enc, const AHT20_Fixed *data);
+#endif
+
+#ifdef MQTT_PICO_MAX6675
+void mqtt_enc_max6675(mqtt_encoder_t *enc, const MAX6675_Data *data);
+
+void mqtt_enc_max6675_fixed(mqtt_encoder_t *enc, const MAX6675_Fixed *data);
+#endif
+
+void mqtt_batch_init(mqtt_batch_t *batch, mqtt_config_t *mqtt, mqtt_topic_t topic, mqtt_enc_format_t format,
+                     uint8_t decimals, uint16_t max_samples, uint16_t max_bytes, uint32_t max_latency_ms);
+
+bool mqtt_batch_add(mqtt_batch_t *batch, int32_t value);
+
+void mqtt_batch_flush(mqtt_batch_t *batch);
+
+bool mqtt_dual_start(mqtt_dual_t *dual, mqtt_config_t *mqtt, mqtt_net_setup_cb_t setup, void *arg);
+
+bool mqtt_dual_publish(mqtt_dual_t *dual, mqtt_topic_t topic, const void *payload, uint16_t len);
+
+uint16_t mqtt_dual_poll(mqtt_dual_t *dual);
+
+bool mqtt_cache_load(mqtt_cache_t *cache);
+
+int mqtt_cache_wifi_connect(mqtt_cache_t *cache, const char *ssid, const char *pw, uint32_t auth, uint32_t timeout_ms);
+
+void mqtt_cache_attach(mqtt_cache_t *cache, mqtt_config_t *mqtt, const char *server);
+
+bool mqtt_cache_save(mqtt_cache_t *cache, const mqtt_config_t *mqtt);
+
+void mqtt_flog_init(mqtt_flog_t *flog, mqtt_config_t *mqtt);
+
+bool mqtt_flog_append(mqtt_flog_t *flog, mqtt_topic_t topic, const void *payload, uint16_t len);
+
+err_t mqtt_flog_publish(mqtt_flog_t *flog, mqtt_topic_t topic, const void *payload, uint16_t len);
+
+void mqtt_flog_sync(mqtt_flog_t *flog);
+
+uint16_t mqtt_flog_poll(mqtt_flog_t *flog);
+
+bool mqtt_flog_pending(const mqtt_flog_t *flog);
+
+void mqtt_budget_sample(mqtt_budget_usage_t *usage);
+
+bool mqtt_lwip_output_empty(const mqtt_client_t *client);
+
+bool mqtt_lwip_rx_at_packet_start(const mqtt_client_t *client);
+
+uint32_t mqtt_lwip_keepalive_left_ms(const mqtt_client_t *client);
+
+bool mqtt_lwip_send_pingreq(mqtt_client_t *client);
+
+bool mqtt_lwip_hook_recv(mqtt_client_t *client, altcp_recv_fn hook, altcp_recv_fn *next);
+
+uint16_t mqtt_lwip_pkt_id_seq(const mqtt_client_t *client);
+
+void mqtt_lwip_set_pkt_id_seq(mqtt_client_t *client, uint16_t pkt_id_seq);
+
+uint16_t mqtt_lwip_inpub_pkt_id(const mqtt_client_t *client);
+
+bool mqtt_lwip_inpub_dup(const mqtt_client_t *client);
+
+bool mqtt_lwip_connect_keep_session(mqtt_client_t *client);
+
+err_t mqtt_lwip_publish_dup(mqtt_client_t *client, const char *topic, const void *payload, uint16_t len,
+                            uint8_t qos, bool retain, uint16_t pkt_id, mqtt_request_cb_t cb, void *arg);
+
+err_t mqtt_lwip_pubrel(mqtt_client_t *client, uint16_t pkt_id, mqtt_request_cb_t cb, void *arg);
+
+uint16_t mqtt_lwip_output_free(const mqtt_client_t *client);
+
+err_t mqtt_lwip_sub_unsub(mqtt_client_t *client, bool subscribe, const void *filters, uint16_t len,
+                          mqtt_request_cb_t cb, void *arg, uint16_t *pkt_id);
+
+void mqtt_tls_heap_usage(size_t *used, size_t *high);
+
+void *mqtt_tls_calloc(size_t n, size_t size);
+
+void mqtt_tls_free(void *ptr);
+
+#if LWIP_ALTCP && LWIP_ALTCP_TLS
+struct mbedtls_ssl_session;
+uint32_t mqtt_tls_session_tag(const struct mbedtls_ssl_session *session);
+
+struct mbedtls_ssl_session *mqtt_lwip_tls_session(struct altcp_tls_session *session);
+#endif
+
+void mqtt_power_start(mqtt_power_t *power, mqtt_config_t *mqtt, uint32_t period_ms, uint32_t window_ms);
+
+bool mqtt_power_add_batch(mqtt_power_t *power, mqtt_batch_t *batch);
+
+void mqtt_power_wake(mqtt_power_t *power);
+
+void mqtt_power_stop(mqtt_power_t *power);
+
+uint32_t mqtt_power_radio_on_per_hour(mqtt_power_t *power);
+
+#ifdef MQTT_PICO_FREERTOS
+bool mqtt_rtos_start(mqtt_rtos_t *rtos, mqtt_config_t *mqtt, mqtt_net_setup_cb_t setup, void *arg, UBaseType_t priority);
+
+err_t mqtt_rtos_publish(mqtt_rtos_t *rtos, mqtt_topic_t topic, const void *payload, uint16_t len, TickType_t timeout);
+
+err_t mqtt_rtos_subscribe(mqtt_rtos_t *rtos, mqtt_rtos_sub_t *sub, const char *filter, UBaseType_t queue_len, TickType_t timeout);
+
+err_t mqtt_rtos_unsubscribe(mqtt_rtos_t *rtos, const char *filter, TickType_t timeout);
+
+bool mqtt_rtos_receive(mqtt_rtos_sub_t *sub, mqtt_rtos_msg_t *msg, TickType_t timeout);
+#endif
+
+void mqtt_router_init(mqtt_router_t *router);
+
+mqtt_router_route_t *mqtt_router_add(mqtt_router_t *router, const char *filter, mqtt_payload_cb_t handler, void *arg);
+
+bool mqtt_router_remove(mqtt_router_t *router, const char *filter);
+
+const mqtt_router_route_t *mqtt_router_match(const mqtt_router_t *router, const char *topic);
+
 #endif // MQTT_PICO_H
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include "mqtt_pico.h"
+
+#define MQTT_POWER_CHECK_MS 20           // intervalo entre verificações do fim da janela
+#define MQTT_POWER_HOUR_US  3600000000ll // período da contabilização do tempo com o rádio ativo
+
+/**
+ * @brief Indica se o keep alive venceria antes da próxima janela.
+ *
+ * Enviado na janela, o PINGREQ zera o contador de keep alive do lwIP e evita que ele acorde
+ * o rádio para enviá-lo entre as janelas.
+ */
+static bool power_keepalive_due(const mqtt_power_t *power) {
+    return mqtt_lwip_keepalive_left_ms(power->mqtt->client) <= power->period_ms + MQTT_CYCLIC_TIMER_INTERVAL * 1000u;
+}
+
+/**
+ * @brief Acumula o tempo da janela que terminou, fechando a hora em contabilização.
+ */
+static void power_account(mqtt_power_t *power, absolute_time_t now) {
+    uint64_t on_us = (uint64_t)absolute_time_diff_us(power->window_start, now);
+
+    power->stats.radio_on_us += on_us;
+    power->hour_on_us += on_us;
+    if (absolute_time_diff_us(power->hour_start, now) >= MQTT_POWER_HOUR_US) {
+        power->stats.radio_on_ms_hour = (uint32_t)(power->hour_on_us / 1000);
+        power->hour_on_us = 0;
+        power->hour_start = now;
+    }
+}
+
+/**
+ * @brief Abre uma janela: rádio em modo de desempenho, lotes esvaziados e fila liberada.
+ */
+static void power_open(mqtt_power_t *power) {
+    mqtt_config_t *mqtt = power->mqtt;
+
+    power->awake = true;
+    power->window_start = get_absolute_time();
+    power->stats.windows++;
+    cyw43_wifi_pm(&cyw43_state, MQTT_POWER_PM_AWAKE);
+
+    for (uint8_t i = 0; i < power->batch_count; i++) {
+        mqtt_batch_flush(power->batches[i]);
+    }
+    mqtt->pub_queue.held = false;
+    mqtt_queue_poll(mqtt);
+
+    if (mqtt->client && mqtt_client_is_connected(mqtt->client) && mqtt->pub_queue.in_flight == 0 &&
+        power_keepalive_due(power)) {
+        if (mqtt_lwip_send_pingreq(mqtt->client)) {
+            power->stats.pings++;
+        }
+    }
+}
+
+/**
+ * @brief Indica se a janela já cumpriu seu trabalho: fila vazia, confirmações recebidas e
+ *        buffer de saída do lwIP enviado.
+ */
+static bool power_idle(const mqtt_power_t *power) {
+    const mqtt_config_t *mqtt = power->mqtt;
+
+    if (!mqtt->client || !mqtt_client_is_connected(mqtt->client)) {
+        return false; // a reconexão pode terminar dentro da janela
+    }
+    const mqtt_pub_queue_t *q = &mqtt->pub_queue;
+    bool queued = false;
+    for (uint8_t i = 0; i < q->count; i++) {
+        const mqtt_pub_entry_t *e = &q->entries[(q->head + i) % MQTT_PUB_QUEUE_LEN];
+        queued |= !e->dead && !e->sent;
+    }
+    return !queued && q->in_flight == 0 && mqtt->conn.pending_subs == 0 &&
+           mqtt_lwip_output_empty(mqtt->client);
+}
+
+/**
+ * @brief Fecha a janela: novas publicações aguardam a próxima e o rádio volta a economizar.
+ */
+static void power_close(mqtt_power_t *power, absolute_time_t now) {
+    power->awake = false;
+    power->mqtt->pub_queue.held = true;
+    cyw43_wifi_pm(&cyw43_state, MQTT_POWER_PM_SLEEP);
+    power_account(power, now);
+}
+
+/**
+ * @brief Worker do agendador: abre a janela no horário e a fecha quando o tráfego termina.
+ */
+static void power_timer(async_context_t *context, async_at_time_worker_t *worker) {
+    mqtt_power_t *power = (mqtt_power_t *)worker->user_data;
+    absolute_time_t now = get_absolute_time();
+
+    if (!power->awake) {
+        power_open(power);
+        async_context_add_at_time_worker_in_ms(context, worker, MQTT_POWER_CHECK_MS);
+        return;
+    }
+
+    int64_t elapsed_us = absolute_time_diff_us(power->window_start, now);
+    bool idle = power_idle(power);
+    if (!idle && elapsed_us < (int64_t)power->window_ms * 1000) {
+        async_context_add_at_time_worker_in_ms(context, worker, MQTT_POWER_CHECK_MS);
+        return;
+    }
+    if (!idle) {
+        power->stats.overruns++;
+    }
+    power_close(power, now);
+
+    // As janelas seguem a grade do período, mesmo que uma delas tenha se estendido
+    absolute_time_t next = delayed_by_ms(power->window_start, power->period_ms);
+    if (absolute_time_diff_us(now, next) < 0) {
+        next = delayed_by_ms(now, power->period_ms);
+    }
+    async_context_add_at_time_worker_at(context, worker, next);
+}
+
+/**
+ * @brief Inicia o agendador de energia: publicações, esvaziamento de lotes e keep alive
+ *        passam a acontecer em janelas periódicas, com o rádio em economia entre elas.
+ *
+ * A cada `period_ms`, o CYW43 passa para `MQTT_POWER_PM_AWAKE`, os lotes registrados com
+ * `mqtt_power_add_batch` são publicados e a fila de publicação é liberada. A janela fecha
+ * quando a fila esvazia e as confirmações (PUBACK/PUBCOMP) chegam, ou após `window_ms`; então
+ * a fila volta a reter as publicações e o rádio volta a `MQTT_POWER_PM_SLEEP`. Se o keep alive
+ * venceria antes da próxima janela e não houve outro tráfego, um PINGREQ é enviado na janela.
+ *
+ * Entre as janelas o cliente continua conectado: mensagens do broker chegam com o atraso de
+ * um intervalo de DTIM, sem serem perdidas. Publicações urgentes podem antecipar a janela
+ * com `mqtt_power_wake`.
+ *
+ * @param[out] power     Agendador. Deve permanecer válido enquanto estiver em uso (prefira
+ *                       alocação estática).
+ * @param[in]  mqtt      Cliente agendado, com a fila de publicação configurada.
+ * @param[in]  period_ms Intervalo entre janelas. Use um valor menor que o keep alive, para que
+ *                       o lwIP nunca precise acordar o rádio por conta própria.
+ * @param[in]  window_ms Duração máxima de uma janela (cobre reconexões e confirmações lentas).
+ *
+ * @code
+ * // Telemetria e keep alive a cada 30 s, rádio em economia no restante do tempo
+ * static mqtt_power_t power;
+ * mqtt.client_info.keep_alive = 60;
+ * mqtt_power_start(&power, &mqtt, 30000, 2000);
+ * mqtt_power_add_batch(&power, &temp_batch);
+ * @endcode
+ *
+ * @see mqtt_power_radio_on_per_hour
+ */
+void mqtt_power_start(mqtt_power_t *power, mqtt_config_t *mqtt, uint32_t period_ms, uint32_t window_ms) {
+    cyw43_arch_lwip_begin();
+    async_context_remove_at_time_worker(cyw43_arch_async_context(), &power->timer);
+    memset(power, 0, sizeof(*power));
+    power->mqtt = mqtt;
+    power->period_ms = period_ms;
+    power->window_ms = window_ms;
+    power->timer.do_work = power_timer;
+    power->timer.user_data = power;
+    power->started = get_absolute_time();
+    power->window_start = power->started;
+    power->hour_start = power->started;
+
+    // Primeira janela imediata: entrega o que foi enfileirado antes do início
+    async_context_add_at_time_worker_in_ms(cyw43_arch_async_context(), &power->timer, 0);
+    cyw43_arch_lwip_end();
+}
+
+/**
+ * @brief Registra um lote para ser publicado a cada janela, mesmo que incompleto.
+ *
+ * Os limites do lote continuam valendo: um lote que atinge `max_samples` entre as janelas
+ * entra na fila e aguarda a próxima janela.
+ *
+ * @return false se já houver `MQTT_POWER_BATCHES` lotes registrados.
+ */
+bool mqtt_power_add_batch(mqtt_power_t *power, mqtt_batch_t *batch) {
+    if (power->batch_count >= MQTT_POWER_BATCHES) {
+        return false;
+    }
+    power->batches[power->batch_count++] = batch;
+    return true;
+}
+
+/**
+ * @brief Antecipa a próxima janela para agora (alarmes, respostas a comandos).
+ *
+ * A grade das janelas seguintes passa a contar a partir desta.
+ */
+void mqtt_power_wake(mqtt_power_t *power) {
+    cyw43_arch_lwip_begin();
+    if (!power->awake && power->mqtt) {
+        power->stats.wakes++;
+        async_context_remove_at_time_worker(cyw43_arch_async_context(), &power->timer);
+        async_context_add_at_time_worker_in_ms(cyw43_arch_async_context(), &power->timer, 0);
+    }
+    cyw43_arch_lwip_end();
+}
+
+/**
+ * @brief Interrompe o agendador: a fila volta a enviar na hora e o rádio volta ao modo de
+ *        economia padrão do CYW43.
+ */
+void mqtt_power_stop(mqtt_power_t *power) {
+    cyw43_arch_lwip_begin();
+    async_context_remove_at_time_worker(cyw43_arch_async_context(), &power->timer);
+    if (power->awake) {
+        power_account(power, get_absolute_time());
+        power->awake = false;
+    }
+    if (power->mqtt) {
+        power->mqtt->pub_queue.held = false;
+        mqtt_queue_poll(power->mqtt);
+    }
+    cyw43_wifi_pm(&cyw43_state, CYW43_DEFAULT_PM);
+    cyw43_arch_lwip_end();
+}
+
+/**
+ * @brief Tempo com o rádio em modo de desempenho por hora, na média desde `mqtt_power_start`.
+ *
+ * Para a última hora completa, veja `stats.radio_on_ms_hour`. O tempo em economia (acordando
+ * nos beacons) não é contado.
+ *
+ * @return Milissegundos por hora.
+ */
+uint32_t mqtt_power_radio_on_per_hour(mqtt_power_t *power) {
+    cyw43_arch_lwip_begin();
+    absolute_time_t now = get_absolute_time();
+    uint64_t on_us = power->stats.radio_on_us;
+    if (power->awake) {
+        on_us += (uint64_t)absolute_time_diff_us(power->window_start, now);
+    }
+    int64_t total_us = absolute_time_diff_us(power->started, now);
+    cyw43_arch_lwip_end();
+
+    if (total_us < 3600) {
+        return 0;
+    }
+    return (uint32_t)(on_us * 1000 / ((uint64_t)total_us / 3600));
+}
@@ -0,0 +1,480 @@
+#include "mqtt_pico.h"
+
+/**
+ * @brief Reserva `size` bytes contíguos na arena circular da fila.
+ *
+ * As alocações são liberadas na mesma ordem em que foram feitas (FIFO), então
+ * basta manter o início da mais antiga (`rd`) e a próxima posição livre (`wr`).
+ *
+ * @return Posição da alocação, ou -1 se não houver espaço contíguo.
+ */
+static int32_t queue_alloc(mqtt_pub_queue_t *q, uint16_t size) {
+    if (q->count == 0) {
+        q->rd = 0;
+        q->wr = 0;
+    }
+
+    int32_t offset = -1;
+    if (q->count == 0 || q->wr > q->rd) {
+        // Livre: [wr, fim) e [0, rd)
+        if (MQTT_PUB_ARENA_SIZE - q->wr >= size) {
+            offset = q->wr;
+        } else if (q->rd > size) {
+            offset = 0;
+        }
+    } else if (q->wr < q->rd && q->rd - q->wr > size) {
+        // Livre: [wr, rd)
+        offset = q->wr;
+    }
+
+    if (offset >= 0) {
+        q->wr = offset + size;
+        uint16_t used = (q->wr >= q->rd) ? q->wr - q->rd : MQTT_PUB_ARENA_SIZE - q->rd + q->wr;
+        if (q->count == 0) {
+            used = size;
+        }
+        if (used > q->stats.arena_high_water) {
+            q->stats.arena_high_water = used;
+        }
+    }
+    return offset;
+}
+
+/**
+ * @brief Remove a mensagem mais antiga da fila, liberando sua alocação na arena.
+ */
+static void queue_pop(mqtt_pub_queue_t *q) {
+    q->head = (q->head + 1) % MQTT_PUB_QUEUE_LEN;
+    q->count--;
+    if (q->count) {
+        q->rd = q->entries[q->head].offset;
+    }
+}
+
+static void queue_drain(mqtt_config_t *mqtt);
+
+/**
+ * @brief Callback de conclusão de cada publicação entregue ao lwIP.
+ *
+ * Libera a vaga de requisição em uso, registra a latência da publicação e volta a
+ * drenar a fila. Uma mensagem retida pela sessão é liberada na confirmação; se o lwIP
+ * desistir dela (`MQTT_REQ_TIMEOUT`), continua retida e só é reenviada na reconexão, a única
+ * retransmissão que o MQTT 3.1.1 permite (4.4).
+ */
+static void queue_pub_done(void *arg, err_t err) {
+    mqtt_pub_slot_t *slot = (mqtt_pub_slot_t *)arg;
+    mqtt_config_t *mqtt = slot->mqtt;
+    mqtt_pub_queue_t *q = &mqtt->pub_queue;
+
+    if (!slot->busy) {
+        return;
+    }
+    slot->busy = false;
+    if (q->in_flight) {
+        q->in_flight--;
+    }
+    bool retained = slot->entry != NULL;
+    if (retained) {
+        slot->entry->dead = err == ERR_OK;
+        slot->entry = NULL;
+    }
+    if (err == ERR_OK) {
+        q->stats.completed++;
+        mqtt_metrics_pub_done(mqtt, slot->qos, (uint32_t)to_us_since_boot(get_absolute_time()) - slot->sent_us);
+    } else if (!retained) {
+        q->stats.failed++;
+    }
+    if (q->cb) {
+        q->cb(q->cb_arg, err);
+    }
+
+    queue_drain(mqtt);
+}
+
+/**
+ * @brief Retorna uma vaga livre para uma nova publicação, ou NULL se todas estiverem em uso.
+ */
+static mqtt_pub_slot_t *queue_slot(mqtt_pub_queue_t *q) {
+    for (uint8_t i = 0; i < MQTT_REQ_MAX_IN_FLIGHT; i++) {
+        if (!q->slots[i].busy) {
+            return &q->slots[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Entrega ao lwIP as mensagens da fila enquanto houver espaço de saída.
+ *
+ * Sem sessão persistente, cada mensagem sai da fila ao ser entregue. Com ela, as QoS 1/2
+ * ficam retidas (`sent`) até a confirmação; as seguintes continuam sendo enviadas, e a arena
+ * é liberada em ordem assim que as mais antigas são confirmadas.
+ *
+ * Deve ser chamada no contexto do lwIP (callback ou entre `cyw43_arch_lwip_begin/end`).
+ */
+static void queue_drain(mqtt_config_t *mqtt) {
+    mqtt_pub_queue_t *q = &mqtt->pub_queue;
+
+    while (q->count && q->entries[q->head].dead) {
+        queue_pop(q);
+    }
+    if (q->held || !mqtt->client || !mqtt_client_is_connected(mqtt->client)) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < q->count; i++) {
+        mqtt_pub_entry_t *e = &q->entries[(q->head + i) % MQTT_PUB_QUEUE_LEN];
+        if (e->dead || e->sent) {
+            continue;
+        }
+
+        mqtt_pub_slot_t *slot = queue_slot(q);
+        if (!slot) {
+            // Todas as vagas em uso: tenta de novo quando uma publicação concluir
+            break;
+        }
+        slot->mqtt = mqtt;
+        slot->qos = e->qos;
+        slot->sent_us = (uint32_t)to_us_since_boot(get_absolute_time());
+
+        // Retransmissão: com o PUBREC já recebido, só falta o PUBREL; senão, o PUBLISH com DUP
+        err_t err;
+        if (e->pubrec) {
+            err = mqtt_lwip_pubrel(mqtt->client, e->pkt_id, queue_pub_done, slot);
+        } else if (e->pkt_id) {
+            err = mqtt_lwip_publish_dup(mqtt->client, e->topic, &q->arena[e->data], e->len, e->qos, e->retain,
+                                        e->pkt_id, queue_pub_done, slot);
+        } else {
+            err = mqtt_publish(mqtt->client, e->topic, &q->arena[e->data], e->len, e->qos, e->retain, queue_pub_done, slot);
+        }
+        if (err == ERR_MEM) {
+            // Buffer de saída ou requisições esgotados: tenta de novo quando uma publicação concluir
+            q->stats.retries++;
+            break;
+        }
+        if (err == ERR_OK) {
+            slot->busy = true;
+            q->in_flight++;
+            if (q->in_flight > q->stats.in_flight_high_water) {
+                q->stats.in_flight_high_water = q->in_flight;
+            }
+            q->stats.sent++;
+            if (mqtt->session.enabled && e->qos > 0) {
+                if (e->pkt_id) {
+                    mqtt->session.retransmits++;
+                } else {
+                    e->pkt_id = mqtt_lwip_pkt_id_seq(mqtt->client);
+                }
+                e->sent = true;
+                slot->entry = e;
+                continue;
+            }
+        } else {
+            q->stats.failed++;
+        }
+        e->dead = true;
+    }
+
+    while (q->count && q->entries[q->head].dead) {
+        queue_pop(q);
+    }
+}
+
+/**
+ * @brief Copia uma mensagem para a fila, substituindo a pendente do mesmo tópico se configurado.
+ *
+ * @param[in] stable Se true, `topic` é uma string da tabela de tópicos, que não precisa ser
+ *                   copiada para a arena.
+ * @param[in] keep   Se true, a mensagem não substitui nem pode ser substituída por outra.
+ *
+ * @return ERR_OK se a mensagem foi aceita, ERR_MEM se não houver espaço.
+ */
+static err_t queue_push(mqtt_config_t *mqtt, const char *topic, bool stable, bool keep, const void *payload, uint16_t len) {
+    mqtt_pub_queue_t *q = &mqtt->pub_queue;
+    size_t topic_size = stable ? 0 : strlen(topic) + 1;
+    mqtt_pub_entry_t *replaced = NULL;
+
+    if (q->coalesce && !keep) {
+        for (uint8_t i = 0; i < q->count; i++) {
+            mqtt_pub_entry_t *e = &q->entries[(q->head + i) % MQTT_PUB_QUEUE_LEN];
+            // Mensagens com ID de pacote já foram enviadas e aguardam retransmissão com o mesmo
+            // conteúdo: só as nunca enviadas podem ser substituídas
+            if (e->dead || e->keep || e->sent || e->pkt_id ||
+                (e->topic != topic && strcmp(e->topic, topic) != 0)) {
+                continue;
+            }
+            if (e->data - e->offset + len <= e->size) {
+                // O novo valor cabe na alocação existente: substitui no lugar
+                memcpy(&q->arena[e->data], payload, len);
+                e->len = len;
+                e->qos = mqtt->pub_qos;
+                e->retain = mqtt->retain;
+                q->stats.coalesced++;
+                q->stats.enqueued++;
+                return ERR_OK;
+            }
+            // Só é descartada depois que o novo valor tiver espaço; sem espaço, a pendente fica
+            replaced = e;
+            break;
+        }
+    }
+
+    if (q->count >= MQTT_PUB_QUEUE_LEN || topic_size + len > MQTT_PUB_ARENA_SIZE) {
+        q->stats.dropped++;
+        return ERR_MEM;
+    }
+
+    uint16_t size = (topic_size + len + 3) & ~3u; // mantém as alocações alinhadas em 4 bytes
+    if (size == 0) {
+        size = 4; // mensagens vazias também ocupam uma posição na arena
+    }
+    int32_t offset = queue_alloc(q, size);
+    if (offset < 0) {
+        q->stats.dropped++;
+        return ERR_MEM;
+    }
+
+    mqtt_pub_entry_t *e = &q->entries[(q->head + q->count) % MQTT_PUB_QUEUE_LEN];
+    if (stable) {
+        e->topic = topic;
+    } else {
+        memcpy(&q->arena[offset], topic, topic_size);
+        e->topic = (const char *)&q->arena[offset];
+    }
+    if (len) {
+        memcpy(&q->arena[offset + topic_size], payload, len);
+    }
+    e->offset = (uint16_t)offset;
+    e->size = size;
+    e->data = (uint16_t)(offset + topic_size);
+    e->len = len;
+    e->qos = mqtt->pub_qos;
+    e->retain = mqtt->retain;
+    e->dead = false;
+    e->keep = keep;
+    e->sent = false;
+    e->pubrec = false;
+    e->pkt_id = 0;
+    q->count++;
+    q->stats.enqueued++;
+    if (replaced) {
+        replaced->dead = true;
+        q->stats.coalesced++;
+    }
+    if (q->count > q->stats.high_water) {
+        q->stats.high_water = q->count;
+    }
+    return ERR_OK;
+}
+
+/**
+ * @brief Configura o comportamento da fila de publicação.
+ *
+ * @param[in] mqtt     Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in] coalesce Se true, uma nova mensagem para um tópico que ainda tem mensagem na fila
+ *                     substitui a anterior (vale o último valor).
+ * @param[in] cb       Callback opcional chamado a cada publicação concluída. Pode ser NULL.
+ * @param[in] arg      Argumento repassado a `cb`.
+ */
+void mqtt_queue_config(mqtt_config_t *mqtt, bool coalesce, mqtt_request_cb_t cb, void *arg) {
+    mqtt->pub_queue.coalesce = coalesce;
+    mqtt->pub_queue.cb = cb;
+    mqtt->pub_queue.cb_arg = arg;
+}
+
+/**
+ * @brief Publica uma mensagem através da fila de publicação.
+ *
+ * Tópico e payload são copiados para a arena estática da fila e a fila é drenada
+ * imediatamente. O que não couber no buffer de saída do lwIP ou nas requisições em
+ * andamento (`MQTT_REQ_MAX_IN_FLIGHT`) permanece na fila e é enviado assim que uma
+ * publicação anterior for concluída, sem que o chamador precise repetir a chamada.
+ * Usa `mqtt->pub_qos` e `mqtt->retain`.
+ *
+ * @param[in] mqtt    Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in] topic   Tópico da publicação.
+ * @param[in] payload Dados a publicar.
+ * @param[in] len     Tamanho de `payload`.
+ *
+ * @return ERR_OK se a mensagem foi aceita, ERR_MEM se foi descartada por falta de espaço
+ *         (contabilizada em `mqtt->pub_queue.stats.dropped`).
+ *
+ * @see mqtt_queue_config, mqtt_queue_poll
+ */
+err_t mqtt_queue_publish(mqtt_config_t *mqtt, const char *topic, const void *payload, uint16_t len) {
+    cyw43_arch_lwip_begin();
+    err_t err = queue_push(mqtt, topic, false, false, payload, len);
+    queue_drain(mqtt);
+    cyw43_arch_lwip_end();
+    return err;
+}
+
+/**
+ * @brief Publica uma mensagem em um tópico da tabela de tópicos através da fila de publicação.
+ *
+ * Igual a `mqtt_queue_publish`, mas o tópico não é formatado nem copiado: a entrada da fila
+ * aponta para a string pré-montada por `mqtt_topic_register`, e apenas o payload ocupa a arena.
+ * Em tópicos com `mqtt_topic_compress`, o payload entra na arena já comprimido.
+ *
+ * @param[in] mqtt    Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in] topic   Handle retornado por `mqtt_topic_register`.
+ * @param[in] payload Dados a publicar.
+ * @param[in] len     Tamanho de `payload`.
+ *
+ * @return ERR_OK se a mensagem foi aceita, ERR_ARG se o handle for inválido, ERR_MEM se foi
+ *         descartada por falta de espaço.
+ *
+ * @see mqtt_topic_register, mqtt_queue_publish
+ */
+err_t mqtt_queue_publish_topic(mqtt_config_t *mqtt, mqtt_topic_t topic, const void *payload, uint16_t len) {
+    const char *str = mqtt_topic_str(mqtt, topic);
+    if (!str) {
+        return ERR_ARG;
+    }
+
+    cyw43_arch_lwip_begin();
+    err_t err = ERR_MEM;
+    const void *data = mqtt_compress_payload(mqtt, topic, payload, &len);
+    if (data) {
+        err = queue_push(mqtt, str, true, false, data, len);
+    } else {
+        mqtt->pub_queue.stats.dropped++;
+    }
+    queue_drain(mqtt);
+    cyw43_arch_lwip_end();
+    return err;
+}
+
+/**
+ * @brief Publica uma mensagem que não pode ser descartada pela coalescência.
+ *
+ * Igual a `mqtt_queue_publish_topic`, mas a mensagem nunca substitui nem é substituída por
+ * outra do mesmo tópico, mesmo com a coalescência ativa. Usada quando cada mensagem carrega
+ * dados distintos, como os lotes de `mqtt_batch_add`.
+ *
+ * @see mqtt_queue_publish_topic, mqtt_queue_config
+ */
+err_t mqtt_queue_publish_keep(mqtt_config_t *mqtt, mqtt_topic_t topic, const void *payload, uint16_t len) {
+    const char *str = mqtt_topic_str(mqtt, topic);
+    if (!str) {
+        return ERR_ARG;
+    }
+
+    cyw43_arch_lwip_begin();
+    err_t err = ERR_MEM;
+    const void *data = mqtt_compress_payload(mqtt, topic, payload, &len);
+    if (data) {
+        err = queue_push(mqtt, str, true, true, data, len);
+    } else {
+        mqtt->pub_queue.stats.dropped++;
+    }
+    queue_drain(mqtt);
+    cyw43_arch_lwip_end();
+    return err;
+}
+
+/**
+ * @brief Tenta drenar a fila de publicação.
+ *
+ * A fila já é drenada a cada publicação enfileirada e a cada publicação concluída;
+ * esta função serve para retomar o envio após uma (re)conexão.
+ *
+ * @param[in] mqtt Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ */
+void mqtt_queue_poll(mqtt_config_t *mqtt) {
+    cyw43_arch_lwip_begin();
+    queue_drain(mqtt);
+    cyw43_arch_lwip_end();
+}
+
+/**
+ * @brief Libera as vagas das publicações perdidas com a queda da conexão.
+ *
+ * Ao fechar a conexão, o lwIP descarta as requisições pendentes sem chamar seus callbacks;
+ * sem esta liberação, as vagas ficariam ocupadas e a fila pararia de drenar após algumas
+ * quedas. As publicações perdidas são contadas em `failed`, exceto as retidas pela sessão
+ * persistente, que voltam a aguardar envio e são retransmitidas na reconexão, inclusive as
+ * que o lwIP abandonou por timeout. Chamada pela máquina de estados no contexto do lwIP.
+ *
+ * @param[in] mqtt Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ */
+void mqtt_queue_release_in_flight(mqtt_config_t *mqtt) {
+    mqtt_pub_queue_t *q = &mqtt->pub_queue;
+
+    for (uint8_t i = 0; i < MQTT_REQ_MAX_IN_FLIGHT; i++) {
+        mqtt_pub_slot_t *slot = &q->slots[i];
+        if (!slot->busy) {
+            continue;
+        }
+        slot->busy = false;
+        if (slot->entry) {
+            slot->entry = NULL;
+        } else {
+            q->stats.failed++;
+        }
+    }
+    q->in_flight = 0;
+
+    for (uint8_t i = 0; i < q->count; i++) {
+        q->entries[(q->head + i) % MQTT_PUB_QUEUE_LEN].sent = false;
+    }
+}
+
+/**
+ * @brief Procura a mensagem retida pela sessão com o ID de pacote `pkt_id`.
+ */
+static mqtt_pub_entry_t *queue_find_sent(mqtt_pub_queue_t *q, uint16_t pkt_id) {
+    for (uint8_t i = 0; i < q->count; i++) {
+        mqtt_pub_entry_t *e = &q->entries[(q->head + i) % MQTT_PUB_QUEUE_LEN];
+        if (e->sent && !e->dead && e->pkt_id == pkt_id) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Registra o PUBREC de uma publicação QoS 2 retida pela sessão.
+ *
+ * A partir daí o broker já tem a mensagem: se a conexão cair antes do PUBCOMP, a reconexão
+ * reenvia o PUBREL, e não o PUBLISH (MQTT-4.4.0-1). Chamada pela inspeção dos pacotes
+ * recebidos, antes de o lwIP responder com o PUBREL.
+ *
+ * @param[in] mqtt   Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in] pkt_id ID de pacote do PUBREC.
+ */
+void mqtt_queue_pubrec(mqtt_config_t *mqtt, uint16_t pkt_id) {
+    mqtt_pub_entry_t *e = queue_find_sent(&mqtt->pub_queue, pkt_id);
+
+    if (e && e->qos == 2) {
+        e->pubrec = true;
+    }
+}
+
+/**
+ * @brief Libera a mensagem retida confirmada depois do timeout do lwIP.
+ *
+ * Um PUBACK/PUBCOMP que chega após `MQTT_REQ_TIMEOUT` não tem mais requisição no lwIP e é
+ * ignorado por ele; sem esta liberação, a mensagem seria reenviada na reconexão, e no QoS 2
+ * o broker a entregaria de novo, pois o ID já foi liberado. As confirmações de mensagens ainda
+ * em uma vaga seguem pelo callback de conclusão.
+ *
+ * @param[in] mqtt   Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in] pkt_id ID de pacote do PUBACK/PUBCOMP.
+ */
+void mqtt_queue_late_ack(mqtt_config_t *mqtt, uint16_t pkt_id) {
+    mqtt_pub_queue_t *q = &mqtt->pub_queue;
+    mqtt_pub_entry_t *e = queue_find_sent(q, pkt_id);
+
+    if (!e) {
+        return;
+    }
+    for (uint8_t i = 0; i < MQTT_REQ_MAX_IN_FLIGHT; i++) {
+        if (q->slots[i].busy && q->slots[i].entry == e) {
+            return;
+        }
+    }
+    e->dead = true;
+    q->stats.completed++;
+    queue_drain(mqtt);
+}
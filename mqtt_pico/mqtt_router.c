@@ -0,0 +1,306 @@
+#include "mqtt_pico.h"
+
+/**
+ * @brief Procura, entre os filhos de um nó, o nível com o texto informado.
+ *
+ * @return Índice do filho, ou MQTT_ROUTER_NONE se não existir.
+ */
+static uint8_t router_find_child(const mqtt_router_t *router, uint8_t parent, const char *seg, size_t len) {
+    for (uint8_t i = router->nodes[parent].child; i != MQTT_ROUTER_NONE; i = router->nodes[i].sibling) {
+        const mqtt_router_node_t *node = &router->nodes[i];
+        if (node->seg_len == len && memcmp(&router->pool[node->seg], seg, len) == 0) {
+            return i;
+        }
+    }
+    return MQTT_ROUTER_NONE;
+}
+
+/**
+ * @brief Retorna o tamanho do nível que começa em `level` (até '/' ou '\0').
+ */
+static size_t router_level_len(const char *level) {
+    const char *end = strchr(level, '/');
+    return end ? (size_t)(end - level) : strlen(level);
+}
+
+/**
+ * @brief Verifica se um filtro de tópico é válido: níveis de até 255 caracteres,
+ *        `+` sozinho no nível e `#` sozinho no último nível.
+ */
+static bool router_valid_filter(const char *filter) {
+    const char *level = filter;
+    while (true) {
+        size_t len = router_level_len(level);
+        if (len > 255) {
+            return false;
+        }
+        for (size_t i = 0; i < len; i++) {
+            if ((level[i] == '+' || level[i] == '#') && len != 1) {
+                return false;
+            }
+        }
+        if (level[len] == '\0') {
+            return true;
+        }
+        if (len == 1 && level[0] == '#') {
+            return false; // '#' precisa ser o último nível
+        }
+        level += len + 1;
+    }
+}
+
+/**
+ * @brief Percorre a árvore seguindo os níveis de um filtro, sem criar nós.
+ *
+ * @param[out] missing Quantidade de níveis que ainda não existem na árvore.
+ * @return Último nó existente no caminho do filtro.
+ */
+static uint8_t router_walk(const mqtt_router_t *router, const char *filter, size_t *missing) {
+    uint8_t node = 0;
+    const char *level = filter;
+    *missing = 0;
+
+    while (true) {
+        size_t len = router_level_len(level);
+        if (*missing == 0) {
+            uint8_t child = router_find_child(router, node, level, len);
+            if (child == MQTT_ROUTER_NONE) {
+                *missing = 1;
+            } else {
+                node = child;
+            }
+        } else {
+            (*missing)++;
+        }
+        if (level[len] == '\0') {
+            return node;
+        }
+        level += len + 1;
+    }
+}
+
+/**
+ * @brief Inicializa um roteador vazio (apenas o nó raiz).
+ *
+ * @param[out] router Ponteiro para o roteador. Não deve ser NULL.
+ */
+void mqtt_router_init(mqtt_router_t *router) {
+    memset(router, 0, sizeof(*router));
+    router->nodes[0].child = MQTT_ROUTER_NONE;
+    router->nodes[0].sibling = MQTT_ROUTER_NONE;
+    router->nodes[0].route = MQTT_ROUTER_NONE;
+    router->node_count = 1;
+}
+
+/**
+ * @brief Registra (ou atualiza) o handler de um filtro de tópico.
+ *
+ * O filtro é copiado para o buffer do roteador e cada nível vira um nó da árvore,
+ * compartilhando os prefixos já existentes. Registrar novamente o mesmo filtro
+ * apenas substitui o handler.
+ *
+ * @param[in] router  Ponteiro para o roteador. Não deve ser NULL.
+ * @param[in] filter  Filtro de tópico, podendo conter `+` e `#`.
+ * @param[in] handler Handler das mensagens que casarem com o filtro. Pode ser NULL.
+ * @param[in] arg     Argumento repassado ao handler.
+ *
+ * @return A rota registrada, ou NULL se o filtro for inválido ou não houver espaço
+ *         (nós, rotas ou `MQTT_ROUTER_POOL_SIZE`).
+ */
+mqtt_router_route_t *mqtt_router_add(mqtt_router_t *router, const char *filter, mqtt_payload_cb_t handler, void *arg) {
+    if (router->node_count == 0) {
+        mqtt_router_init(router);
+    }
+    if (!router_valid_filter(filter)) {
+        return NULL;
+    }
+
+    size_t missing;
+    uint8_t node = router_walk(router, filter, &missing);
+    if (missing == 0 && router->nodes[node].route != MQTT_ROUTER_NONE) {
+        mqtt_router_route_t *route = &router->routes[router->nodes[node].route];
+        route->handler = handler;
+        route->arg = arg;
+        route->active = true;
+        return route;
+    }
+
+    // Reaproveita rotas removidas antes de ocupar uma nova posição; se o mesmo
+    // filtro já foi registrado antes, seu texto no buffer também é reaproveitado
+    uint8_t route = MQTT_ROUTER_NONE;
+    for (uint8_t i = 0; i < router->route_count; i++) {
+        if (router->routes[i].active) {
+            continue;
+        }
+        if (route == MQTT_ROUTER_NONE || strcmp(&router->pool[router->routes[i].filter], filter) == 0) {
+            route = i;
+        }
+    }
+    if (route == MQTT_ROUTER_NONE) {
+        if (router->route_count >= MQTT_ROUTER_MAX_ROUTES) {
+            return NULL;
+        }
+        route = router->route_count;
+    }
+
+    uint16_t pos;
+    if (missing == 0 && route < router->route_count &&
+        strcmp(&router->pool[router->routes[route].filter], filter) == 0) {
+        pos = router->routes[route].filter;
+    } else {
+        size_t filter_len = strlen(filter);
+        if (router->node_count + missing > MQTT_ROUTER_MAX_NODES ||
+            router->pool_used + filter_len + 1 > MQTT_ROUTER_POOL_SIZE) {
+            return NULL;
+        }
+
+        // Copia o filtro: os nós novos apontam para os níveis desta cópia
+        pos = router->pool_used;
+        memcpy(&router->pool[pos], filter, filter_len + 1);
+        router->pool_used += filter_len + 1;
+    }
+
+    node = 0;
+    const char *level = &router->pool[pos];
+    while (true) {
+        size_t len = router_level_len(level);
+        uint8_t child = router_find_child(router, node, level, len);
+        if (child == MQTT_ROUTER_NONE) {
+            child = router->node_count++;
+            mqtt_router_node_t *n = &router->nodes[child];
+            n->seg = (uint16_t)(level - router->pool);
+            n->seg_len = (uint8_t)len;
+            n->child = MQTT_ROUTER_NONE;
+            n->route = MQTT_ROUTER_NONE;
+            n->sibling = router->nodes[node].child;
+            router->nodes[node].child = child;
+        }
+        node = child;
+        if (level[len] == '\0') {
+            break;
+        }
+        level += len + 1;
+    }
+
+    router->routes[route].handler = handler;
+    router->routes[route].arg = arg;
+    router->routes[route].filter = pos;
+    router->routes[route].active = true;
+    router->routes[route].compressed = false;
+    router->nodes[node].route = route;
+    if (route == router->route_count) {
+        router->route_count++;
+    }
+    return &router->routes[route];
+}
+
+/**
+ * @brief Remove o handler de um filtro de tópico.
+ *
+ * Os nós da árvore são mantidos e reaproveitados se o filtro for registrado novamente.
+ *
+ * @param[in] router Ponteiro para o roteador. Não deve ser NULL.
+ * @param[in] filter Filtro exatamente como foi registrado.
+ *
+ * @return true se o filtro estava registrado, false caso contrário.
+ */
+bool mqtt_router_remove(mqtt_router_t *router, const char *filter) {
+    if (router->node_count == 0) {
+        return false;
+    }
+
+    size_t missing;
+    uint8_t node = router_walk(router, filter, &missing);
+    uint8_t route = router->nodes[node].route;
+    if (missing != 0 || node == 0 || route == MQTT_ROUTER_NONE) {
+        return false;
+    }
+
+    router->routes[route].active = false;
+    router->nodes[node].route = MQTT_ROUTER_NONE;
+    return true;
+}
+
+/**
+ * @brief Retorna a rota ativa de um nó, ou MQTT_ROUTER_NONE.
+ */
+static uint8_t router_active_route(const mqtt_router_t *router, uint8_t node) {
+    uint8_t route = router->nodes[node].route;
+    if (route != MQTT_ROUTER_NONE && router->routes[route].active) {
+        return route;
+    }
+    return MQTT_ROUTER_NONE;
+}
+
+/**
+ * @brief Rota de um nó em que o tópico termina: a do próprio nó ou, na falta dela,
+ *        a de um filho `#` ("a/#" também casa com "a").
+ */
+static uint8_t router_terminal_route(const mqtt_router_t *router, uint8_t node) {
+    uint8_t route = router_active_route(router, node);
+    if (route == MQTT_ROUTER_NONE) {
+        uint8_t hash = router_find_child(router, node, "#", 1);
+        if (hash != MQTT_ROUTER_NONE) {
+            route = router_active_route(router, hash);
+        }
+    }
+    return route;
+}
+
+/**
+ * @brief Casa os níveis restantes de um tópico a partir de um nó.
+ *
+ * Prioriza o nível exato, depois `+` e por fim `#`, de modo que o filtro mais
+ * específico vence. Níveis iniciados por '$' não casam com curingas no primeiro nível.
+ */
+static uint8_t router_match_from(const mqtt_router_t *router, uint8_t node, const char *level, bool first) {
+    size_t len = router_level_len(level);
+    const char *next = level[len] ? &level[len + 1] : NULL;
+    bool wildcards = !(first && level[0] == '$');
+    uint8_t plus = MQTT_ROUTER_NONE;
+    uint8_t hash = MQTT_ROUTER_NONE;
+    uint8_t route;
+
+    for (uint8_t i = router->nodes[node].child; i != MQTT_ROUTER_NONE; i = router->nodes[i].sibling) {
+        const mqtt_router_node_t *child = &router->nodes[i];
+        const char *seg = &router->pool[child->seg];
+
+        if (child->seg_len == 1 && seg[0] == '+') {
+            plus = i;
+        } else if (child->seg_len == 1 && seg[0] == '#') {
+            hash = i;
+        } else if (child->seg_len == len && memcmp(seg, level, len) == 0) {
+            route = next ? router_match_from(router, i, next, false) : router_terminal_route(router, i);
+            if (route != MQTT_ROUTER_NONE) {
+                return route;
+            }
+        }
+    }
+
+    if (wildcards && plus != MQTT_ROUTER_NONE) {
+        route = next ? router_match_from(router, plus, next, false) : router_terminal_route(router, plus);
+        if (route != MQTT_ROUTER_NONE) {
+            return route;
+        }
+    }
+    if (wildcards && hash != MQTT_ROUTER_NONE) {
+        return router_active_route(router, hash);
+    }
+    return MQTT_ROUTER_NONE;
+}
+
+/**
+ * @brief Encontra a rota mais específica para um tópico recebido.
+ *
+ * @param[in] router Ponteiro para o roteador. Não deve ser NULL.
+ * @param[in] topic  Tópico da publicação (sem curingas).
+ *
+ * @return Rota encontrada, ou NULL se nenhum filtro registrado casar com o tópico.
+ */
+const mqtt_router_route_t *mqtt_router_match(const mqtt_router_t *router, const char *topic) {
+    if (router->node_count == 0) {
+        return NULL;
+    }
+    uint8_t route = router_match_from(router, 0, topic, true);
+    return route == MQTT_ROUTER_NONE ? NULL : &router->routes[route];
+}
@@ -0,0 +1,79 @@
+#include "mqtt_pico.h"
+
+/**
+ * @brief Ativa a sessão persistente: entrega ao menos uma vez das publicações QoS 1/2
+ *        mesmo com quedas de conexão, e descarte de retransmissões recebidas.
+ *
+ * Com a sessão ativa, cada publicação QoS 1/2 da fila de publicação permanece na arena até
+ * o PUBACK (QoS 1) ou PUBCOMP (QoS 2). Se a conexão cair, a mensagem volta a ser enviada na
+ * reconexão com o ID de pacote original e o flag DUP, ou apenas o PUBREL se o PUBREC já tinha
+ * chegado. Se o lwIP desistir da confirmação (`MQTT_REQ_TIMEOUT`) com a conexão ativa, a
+ * mensagem continua retida até a próxima reconexão. As retransmissões usam as mesmas vagas de
+ * requisição (`MQTT_REQ_MAX_IN_FLIGHT`) das publicações novas: após uma reconexão, no máximo
+ * essa quantidade fica em andamento ao mesmo tempo.
+ *
+ * Publicações recebidas com o flag DUP cujo ID está entre os últimos `MQTT_SESSION_IN_WINDOW`
+ * entregues são confirmadas ao broker (pelo lwIP) mas não chegam aos handlers.
+ *
+ * @param[in] mqtt          Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in] clean_session Flag clean session do CONNECT. Com false, o broker guarda as
+ *                          inscrições e as mensagens QoS 1/2 enquanto o cliente estiver
+ *                          desconectado, e as entrega na reconexão.
+ *
+ * @note Chame antes de `mqtt_start_client`. O descarte de duplicatas depende do callback de
+ *       publicação padrão (`pub_cb` NULL em `mqtt_start_client`).
+ *
+ * @see mqtt_queue_publish
+ */
+void mqtt_session_config(mqtt_config_t *mqtt, bool clean_session) {
+    mqtt->session.enabled = true;
+    mqtt->session.clean = clean_session;
+}
+
+/**
+ * @brief Ajusta a conexão recém-aberta por `mqtt_client_connect` à sessão.
+ *
+ * O lwIP zera o cliente a cada conexão e sempre envia clean session: a sequência de IDs de
+ * pacote é restaurada, para que publicações novas não reaproveitem IDs de mensagens ainda
+ * retidas, e o flag é corrigido no CONNECT, que ainda está no buffer de saída
+ * (`mqtt_lwip_connect_keep_session`).
+ *
+ * @param[in] mqtt       Cliente com a conexão recém-aberta.
+ * @param[in] pkt_id_seq Último ID de pacote usado antes de `mqtt_client_connect`.
+ */
+void mqtt_session_begin(mqtt_config_t *mqtt, uint16_t pkt_id_seq) {
+    mqtt_lwip_set_pkt_id_seq(mqtt->client, pkt_id_seq);
+    if (!mqtt->session.enabled || mqtt->session.clean) {
+        return;
+    }
+    mqtt_lwip_connect_keep_session(mqtt->client);
+}
+
+/**
+ * @brief Verifica se a publicação recebida é a retransmissão de uma já entregue.
+ *
+ * Chamada no início de cada publicação recebida, quando o lwIP já decodificou o cabeçalho
+ * fixo e o ID de pacote. Só publicações QoS 1/2 com DUP são comparadas com a janela; as
+ * demais apenas registram seu ID, pois o broker pode reutilizar IDs já confirmados.
+ *
+ * @return true se a mensagem deve ser descartada.
+ */
+bool mqtt_session_duplicate(mqtt_config_t *mqtt) {
+    mqtt_session_t *session = &mqtt->session;
+    uint16_t id = mqtt_lwip_inpub_pkt_id(mqtt->client);
+
+    if (!session->enabled || id == 0) {
+        return false;
+    }
+    if (mqtt_lwip_inpub_dup(mqtt->client)) {
+        for (uint8_t i = 0; i < MQTT_SESSION_IN_WINDOW; i++) {
+            if (session->in_ids[i] == id) {
+                session->duplicates++;
+                return true;
+            }
+        }
+    }
+    session->in_ids[session->in_pos] = id;
+    session->in_pos = (session->in_pos + 1) % MQTT_SESSION_IN_WINDOW;
+    return false;
+}
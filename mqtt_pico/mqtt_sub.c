@@ -0,0 +1,220 @@
+#include "mqtt_pico.h"
+
+#define MQTT_SUB_REFUSED 0x80 // código de retorno de um filtro recusado no SUBACK
+
+static uint8_t sub_packet[MQTT_OUTPUT_RINGBUF_SIZE]; // filtros do pacote em montagem; usado só no contexto do lwIP
+
+/**
+ * @brief Bytes do campo de tamanho restante do cabeçalho fixo.
+ */
+static uint8_t sub_len_bytes(uint32_t remaining) {
+    return remaining < 128 ? 1 : remaining < 16384 ? 2 : 3;
+}
+
+/**
+ * @brief Conclusão de cada pacote: um SUBACK com algum filtro recusado resulta em ERR_ABRT.
+ */
+static void sub_packet_done(void *arg, err_t err) {
+    mqtt_sub_pkt_t *pkt = (mqtt_sub_pkt_t *)arg;
+
+    if (!pkt->busy) {
+        return;
+    }
+    pkt->busy = false;
+    if (err == ERR_OK && pkt->refused) {
+        err = ERR_ABRT; // o mesmo erro do lwIP para o primeiro filtro recusado
+    }
+    if (pkt->cb) {
+        pkt->cb(pkt->arg, err);
+    }
+}
+
+/**
+ * @brief Monta e enfileira um SUBSCRIBE/UNSUBSCRIBE com `count` filtros.
+ *
+ * O pacote segue pelo buffer de saída do lwIP (`mqtt_lwip_sub_unsub`), como os demais.
+ *
+ * @return ERR_OK, ou ERR_MEM sem vaga de pacote, de requisição ou espaço de saída.
+ */
+static err_t sub_write(mqtt_config_t *mqtt, const char *const *filters, size_t count, mqtt_action_t action,
+                       mqtt_request_cb_t cb, void *arg) {
+    mqtt_sub_pkt_t *pkt = NULL;
+    for (uint8_t i = 0; i < MQTT_REQ_MAX_IN_FLIGHT; i++) {
+        if (!mqtt->sub_pkts[i].busy) {
+            pkt = &mqtt->sub_pkts[i];
+            break;
+        }
+    }
+    if (!pkt) {
+        return ERR_MEM;
+    }
+
+    uint16_t len = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint16_t filter_len = (uint16_t)strlen(filters[i]);
+        sub_packet[len++] = (uint8_t)(filter_len >> 8);
+        sub_packet[len++] = (uint8_t)filter_len;
+        memcpy(&sub_packet[len], filters[i], filter_len);
+        len += filter_len;
+        if (action == MQTT_SUBSCRIBE) {
+            sub_packet[len++] = mqtt->sub_qos;
+        }
+    }
+
+    pkt->cb = cb;
+    pkt->arg = arg;
+    pkt->refused = false;
+    err_t err = mqtt_lwip_sub_unsub(mqtt->client, action == MQTT_SUBSCRIBE, sub_packet, len,
+                                    sub_packet_done, pkt, &pkt->pkt_id);
+    pkt->busy = err == ERR_OK;
+    return err;
+}
+
+/**
+ * @brief Inscreve (ou remove inscrições) em vários filtros com o mínimo de pacotes.
+ *
+ * Os filtros são agrupados em pacotes SUBSCRIBE/UNSUBSCRIBE do tamanho do espaço livre no
+ * buffer de saída do lwIP, cada um com um único ID e uma única vaga de requisição: inscrever
+ * em 20 filtros custa um ida e volta, e não 20.
+ *
+ * `cb` é chamado uma vez por pacote, no SUBACK/UNSUBACK ou no timeout da requisição. O
+ * SUBACK resulta em ERR_ABRT se o broker recusar qualquer filtro do pacote (código 0x80).
+ *
+ * Deve ser chamada no contexto do lwIP, com o cliente conectado.
+ *
+ * @param[in]  mqtt    Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in]  filters Filtros de tópico.
+ * @param[in]  count   Quantidade de filtros.
+ * @param[in]  action  MQTT_SUBSCRIBE (com `mqtt->sub_qos`) ou MQTT_UNSUBSCRIBE.
+ * @param[in]  cb      Callback de cada pacote. Pode ser NULL.
+ * @param[in]  arg     Argumento de `cb`.
+ * @param[out] packets Quantidade de pacotes enviados, ou seja, de chamadas futuras a `cb`.
+ *
+ * @return ERR_OK se todos os filtros foram enviados, ERR_MEM se algum ficou de fora (sem
+ *         requisições livres ou espaço de saída).
+ */
+err_t mqtt_sub_batch(mqtt_config_t *mqtt, const char *const *filters, size_t count, mqtt_action_t action,
+                     mqtt_request_cb_t cb, void *arg, uint16_t *packets) {
+    uint8_t per_filter = action == MQTT_SUBSCRIBE ? 3 : 2; // tamanho (2 bytes) e QoS (1 byte)
+    err_t result = ERR_OK;
+    size_t i = 0;
+
+    *packets = 0;
+    while (i < count) {
+        uint16_t room = mqtt_lwip_output_free(mqtt->client);
+
+        // Quantos filtros cabem em um pacote
+        uint32_t remaining = 2; // ID do pacote
+        size_t n = 0;
+        while (i + n < count) {
+            uint32_t next = remaining + strlen(filters[i + n]) + per_filter;
+            if (1 + sub_len_bytes(next) + next > room) {
+                break;
+            }
+            remaining = next;
+            n++;
+        }
+
+        if (n == 0) {
+            // Nem este filtro cabe no espaço livre agora
+            result = ERR_MEM;
+            i++;
+            continue;
+        }
+        if (sub_write(mqtt, &filters[i], n, action, cb, arg) != ERR_OK) {
+            return ERR_MEM;
+        }
+        (*packets)++;
+        i += n;
+    }
+    return result;
+}
+
+/**
+ * @brief Registra um código de retorno do SUBACK de um pacote de `mqtt_sub_batch`.
+ *
+ * Chamada pela inspeção dos pacotes recebidos para cada filtro, antes de o lwIP concluir a
+ * requisição.
+ *
+ * @param[in] mqtt   Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ * @param[in] pkt_id ID de pacote do SUBACK.
+ * @param[in] code   Código de retorno: QoS concedido (0 a 2) ou 0x80 (recusado).
+ */
+void mqtt_sub_suback(mqtt_config_t *mqtt, uint16_t pkt_id, uint8_t code) {
+    for (uint8_t i = 0; i < MQTT_REQ_MAX_IN_FLIGHT; i++) {
+        mqtt_sub_pkt_t *pkt = &mqtt->sub_pkts[i];
+        if (pkt->busy && pkt->pkt_id == pkt_id) {
+            if (code == MQTT_SUB_REFUSED) {
+                pkt->refused = true;
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Reserva uma vaga de callback agregado para uma inscrição em lote.
+ *
+ * A vaga começa com uma pendência, que mantém o callback retido enquanto os pacotes são
+ * enviados; ela é liberada com `mqtt_sub_op_done(op, err)` ao fim do envio.
+ *
+ * @return A vaga, ou NULL se `cb` for NULL ou não houver vaga livre (`MQTT_SUB_OPS`).
+ */
+mqtt_sub_op_t *mqtt_sub_op_begin(mqtt_config_t *mqtt, mqtt_request_cb_t cb, void *arg) {
+    if (!cb) {
+        return NULL;
+    }
+    for (uint8_t i = 0; i < MQTT_SUB_OPS; i++) {
+        mqtt_sub_op_t *op = &mqtt->sub_ops[i];
+        if (!op->cb) {
+            op->cb = cb;
+            op->arg = arg;
+            op->pending = 1;
+            op->err = ERR_OK;
+            return op;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Conclui uma pendência da inscrição em lote (`mqtt_request_cb_t` de cada pacote).
+ *
+ * Guarda o primeiro erro e, na última pendência, libera a vaga e chama o callback agregado.
+ */
+void mqtt_sub_op_done(void *arg, err_t err) {
+    mqtt_sub_op_t *op = (mqtt_sub_op_t *)arg;
+
+    if (!op->cb || op->pending == 0) {
+        return;
+    }
+    if (err != ERR_OK && op->err == ERR_OK) {
+        op->err = err;
+    }
+    if (--op->pending == 0) {
+        mqtt_request_cb_t cb = op->cb;
+        op->cb = NULL;
+        cb(op->arg, op->err);
+    }
+}
+
+/**
+ * @brief Conclui com `ERR_CONN` as inscrições em lote perdidas com a queda da conexão.
+ *
+ * O lwIP descarta as requisições pendentes sem chamar seus callbacks. Os filtros continuam
+ * no roteador e são reinscritos pela máquina de estados na próxima conexão.
+ *
+ * @param[in] mqtt Ponteiro para a estrutura de configuração do cliente MQTT. Não deve ser NULL.
+ */
+void mqtt_sub_release(mqtt_config_t *mqtt) {
+    for (uint8_t i = 0; i < MQTT_REQ_MAX_IN_FLIGHT; i++) {
+        mqtt->sub_pkts[i].busy = false;
+    }
+    for (uint8_t i = 0; i < MQTT_SUB_OPS; i++) {
+        mqtt_sub_op_t *op = &mqtt->sub_ops[i];
+        if (op->cb) {
+            op->pending = 1;
+            mqtt_sub_op_done(op, ERR_CONN);
+        }
+    }
+}
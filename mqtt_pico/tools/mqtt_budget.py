@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""
+Relatório de RAM de um firmware com mqtt_pico: RAM estática por componente (a partir do
+mapa de ligação) e pico dinâmico estimado para a configuração do lwIP/mbedTLS compilada.
+
+Uso:
+    mqtt_budget.py mqtt-example1.elf
+    mqtt_budget.py mqtt-example1.elf --map mqtt-example1.elf.map --symbols 15
+    mqtt_budget.py mqtt-example1.elf --ram-size 520K   # RP2350
+    mqtt_budget.py mqtt-example1.elf --tls-heap-high 41234  # pico medido no dispositivo
+
+A configuração vem de `mqtt_budget_config` (mqtt_budget.c), lida do ELF; o mapa é o gerado
+pelo Pico SDK ao lado do ELF (`<alvo>.elf.map`). O mbedTLS aloca no heap do C; o heap do lwIP
+(MEM_SIZE) guarda o cliente MQTT, o estado do TLS e os segmentos TCP de saída. Os dois valores
+são estimativas do modelo de mqtt_budget.c, não medições: confirme no dispositivo com
+`mqtt_budget_sample` e passe o pico medido do mbedTLS (`tls_heap_high`) com --tls-heap-high.
+No CMake, o alvo `<exemplo>_budget` roda este script após a compilação.
+"""
+import argparse
+import re
+import struct
+import sys
+
+BUDGET_MAGIC = 0x4742514D
+BUDGET_VERSION = 2
+BUDGET_FIELDS = (
+    "magic", "version", "profile", "config_size", "output_ringbuf", "lwip_heap", "pbuf_pool",
+    "pbuf_bufsize", "tcp_seg", "tcp_mss", "tcp_wnd", "tcp_snd_buf", "tls_in", "tls_out", "tls_heap",
+    "lwip_fixed", "tcp_segment",
+)
+PROFILES = ("padrão", "LOW", "MIN")
+
+# Componente de cada arquivo objeto do mapa, na ordem em que são testados
+COMPONENTS = (
+    ("mqtt_pico", re.compile(r"libmqtt_pico[^/]*\.a\(")),
+    ("lwIP", re.compile(r"[/\\]lwip[/\\]|liblwip")),
+    ("mbedTLS", re.compile(r"mbedtls", re.I)),
+    ("CYW43", re.compile(r"cyw43", re.I)),
+    ("FreeRTOS", re.compile(r"freertos", re.I)),
+    ("libc", re.compile(r"lib(c|g|m|gcc|nosys|stdc\+\+)(_nano)?\.a\(")),
+    ("Pico SDK", re.compile(r"pico[-_]sdk|[/\\]src[/\\]rp2_common[/\\]|[/\\]src[/\\]common[/\\]")),
+)
+RESERVED = re.compile(r"^\.(stack|heap)")
+
+
+def parse_size(text):
+    """Aceita 264K, 0x42000 ou 270336."""
+    text = text.strip().upper()
+    if text.endswith("K"):
+        return int(text[:-1], 0) * 1024
+    return int(text, 0)
+
+
+def read_budget(path):
+    """Lê `mqtt_budget_config` da tabela de símbolos do ELF (32 ou 64 bits, little-endian)."""
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[5] != 1:
+        sys.exit(f"{path}: não é um ELF little-endian")
+    is64 = elf[4] == 2
+    if is64:
+        shoff, = struct.unpack_from("<Q", elf, 0x28)
+        shentsize, shnum = struct.unpack_from("<HH", elf, 0x3A)
+        sh_fmt, sym_fmt = "<IIQQQQIIQQ", "<IBBHQQ"
+    else:
+        shoff, = struct.unpack_from("<I", elf, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", elf, 0x2E)
+        sh_fmt, sym_fmt = "<IIIIIIIIII", "<IIIBBH"
+
+    sections = [struct.unpack_from(sh_fmt, elf, shoff + i * shentsize) for i in range(shnum)]
+    for sh in sections:
+        if sh[1] != 2:  # SHT_SYMTAB
+            continue
+        strtab = sections[sh[6]]
+        for off in range(sh[4], sh[4] + sh[5], sh[9]):
+            sym = struct.unpack_from(sym_fmt, elf, off)
+            if is64:
+                name, value, shndx = sym[0], sym[4], sym[3]
+            else:
+                name, value, shndx = sym[0], sym[1], sym[5]
+            start = strtab[4] + name
+            if elf[start:elf.index(b"\0", start)] != b"mqtt_budget_config":
+                continue
+            data = sections[shndx]
+            pos = data[4] + value - data[3]  # sh_offset + (endereço - sh_addr)
+            values = struct.unpack_from("<%dI" % len(BUDGET_FIELDS), elf, pos)
+            budget = dict(zip(BUDGET_FIELDS, values))
+            if budget["magic"] != BUDGET_MAGIC:
+                sys.exit(f"{path}: mqtt_budget_config inválido")
+            if budget["version"] != BUDGET_VERSION:
+                sys.exit(f"{path}: mqtt_budget_config versão {budget['version']}, esperada {BUDGET_VERSION}")
+            return budget
+    sys.exit(f"{path}: símbolo mqtt_budget_config não encontrado (mqtt_budget.c foi ligado?)")
+
+
+def read_map(path, ram_start, ram_end):
+    """Retorna as seções de entrada em RAM do mapa do GNU ld: (seção, endereço, tamanho, objeto)."""
+    entries = []
+    pending = None
+    in_map = False
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if line.startswith("Linker script and memory map"):
+                in_map = True
+                continue
+            if not in_map or not line.startswith(" "):
+                pending = None
+                continue
+            m = re.match(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$", line)
+            if m:
+                name, addr, size, obj = m.group(1), int(m.group(2), 16), int(m.group(3), 16), m.group(4)
+            else:
+                m = re.match(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$", line)
+                if not (m and pending):
+                    m = re.match(r"^ (\S+)$", line)
+                    pending = m.group(1) if m else None
+                    continue
+                name, addr, size, obj = pending, int(m.group(1), 16), int(m.group(2), 16), m.group(3)
+            pending = None
+            if name.startswith("*") or size == 0 or not ram_start <= addr < ram_end:
+                continue
+            entries.append((name, addr, size, obj))
+    return entries
+
+
+def component(obj, app):
+    for name, pattern in COMPONENTS:
+        if pattern.search(obj):
+            return name
+    return app
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("elf", help="firmware ligado (.elf)")
+    parser.add_argument("--map", help="mapa de ligação (padrão: <elf>.map)")
+    parser.add_argument("--ram-start", default="0x20000000", help="início da SRAM")
+    parser.add_argument("--ram-size", default="264K", help="tamanho da SRAM (RP2040: 264K, RP2350: 520K)")
+    parser.add_argument("--symbols", type=int, default=0, help="lista as N maiores variáveis")
+    parser.add_argument("--tls-heap-high", help="pico do heap do mbedTLS medido (mqtt_budget_usage_t.tls_heap_high)")
+    args = parser.parse_args()
+
+    ram_start = parse_size(args.ram_start)
+    ram_size = parse_size(args.ram_size)
+    budget = read_budget(args.elf)
+    entries = read_map(args.map or args.elf + ".map", ram_start, ram_start + ram_size)
+
+    totals = {}
+    reserved = 0
+    for name, _, size, obj in entries:
+        if RESERVED.match(name):
+            reserved += size
+        else:
+            key = component(obj, "aplicação")
+            totals[key] = totals.get(key, 0) + size
+    static = sum(totals.values())
+
+    profile = budget["profile"]
+    print(f"Perfil de RAM: {PROFILES[profile] if profile < len(PROFILES) else profile}")
+    print(f"  mqtt_config_t          {budget['config_size']:7d} B (saída MQTT: 2 x {budget['output_ringbuf']} B no cliente do lwIP)")
+    print(f"  heap do lwIP           {budget['lwip_heap']:7d} B (MEM_SIZE)")
+    if budget["lwip_heap"]:
+        room = budget["lwip_heap"] - budget["lwip_fixed"]
+        print(f"    cliente MQTT e TLS   {budget['lwip_fixed']:7d} B; sobram {room} B para "
+              f"{room // budget['tcp_segment']} segmentos de saída de {budget['tcp_segment']} B "
+              f"(TCP_SND_BUF pede {-(-budget['tcp_snd_buf'] // budget['tcp_mss'])})")
+    print(f"  pool de pbufs          {budget['pbuf_pool'] * budget['pbuf_bufsize']:7d} B "
+          f"({budget['pbuf_pool']} x {budget['pbuf_bufsize']} B)")
+    print(f"  TCP                    janela {budget['tcp_wnd']} B, envio {budget['tcp_snd_buf']} B, "
+          f"{budget['tcp_seg']} segmentos")
+    if budget["tls_in"]:
+        print(f"  registros TLS          entrada {budget['tls_in']} B, saída {budget['tls_out']} B")
+
+    print("\nRAM estática (mapa de ligação):")
+    for key, size in sorted(totals.items(), key=lambda item: -item[1]):
+        print(f"  {key:22s} {size:7d} B")
+    print(f"  {'total':22s} {static:7d} B")
+    print(f"  {'pilhas e heap mínimo':22s} {reserved:7d} B")
+
+    heap_free = ram_size - static - reserved
+    tls_heap = budget["tls_heap"]
+    print("\nPico dinâmico (heap do C):")
+    print(f"  {'mbedTLS estimado':22s} {tls_heap:7d} B")
+    if args.tls_heap_high:
+        tls_heap = parse_size(args.tls_heap_high)
+        print(f"  {'mbedTLS medido':22s} {tls_heap:7d} B (tls_heap_high"
+              f"{', acima da estimativa' if tls_heap > budget['tls_heap'] else ''})")
+    print(f"\nRAM: {ram_size} B; livre após o pico: {heap_free - tls_heap} B "
+          f"({100 * (heap_free - tls_heap) / ram_size:.1f}%)")
+
+    if args.symbols:
+        print(f"\nMaiores variáveis:")
+        for name, _, size, obj in sorted(entries, key=lambda e: -e[2])[:args.symbols]:
+            print(f"  {size:7d} B  {name}  ({obj})")
+
+    if heap_free < tls_heap:
+        sys.exit("RAM insuficiente para o pico do mbedTLS")
+
+
+if __name__ == "__main__":
+    main()
@@ -4,6 +4,8 @@
 #include <stdlib.h>
 #include <pico/stdlib.h>
 #include <hardware/spi.h>
+#include <hardware/dma.h>
+#include <hardware/sync.h>
 #include "st7735_font.h"
 
 //#define USE_SPI_DMA // Caso for usar DMA para SPI
@@ -12,7 +14,21 @@
 #define SWAP_INT16_T(a, b) { int16_t t = a; a = b; b = t; }
 #define DELAY 0x80
 
+#define ST7735_GRAM_HEIGHT 162 // Linhas da memória do controlador (área total de VSCRDEF)
+#define ST7735_MAX_WIDTH   162 // Largura máxima de uma linha do console, em pixels
+
+#ifndef ST7735_BUS_QUEUE_LEN
+#define ST7735_BUS_QUEUE_LEN 16 // Transferências pendentes por barramento SPI
+#endif
+
+#ifndef ST7735_BUS_DMA_IRQ
+#define ST7735_BUS_DMA_IRQ 0 // Linha de IRQ do DMA usada pelos barramentos (0 ou 1)
+#endif
+
+struct st7735_bus;
+
 typedef struct {
+    struct st7735_bus *bus; // Barramento compartilhado (NULL para acesso direto ao SPI)
     spi_inst_t * spi;
     uint8_t cs;
     uint8_t sck;
@@ -26,8 +42,38 @@ typedef struct {
     uint8_t y_start;
     uint8_t data_rotation;
     uint8_t value_rotation;
+    bool backlight;
 } st7735_t;
 
+/**
+ * @brief Transferência enfileirada no barramento: um comando ou um bloco de dados
+ * destinado a um painel. O barramento aciona CS/DC do painel antes de cada rajada.
+ */
+typedef struct {
+    st7735_t *st;           // Painel de destino
+    const uint8_t *data;    // Buffer a enviar (deve permanecer válido até a conclusão)
+    size_t len;             // Tamanho em bytes
+    bool is_data;           // true para dados (DC alto), false para comando (DC baixo)
+} st7735_transfer_t;
+
+/**
+ * @brief Barramento SPI compartilhado por vários painéis, cada um com seus pinos CS/DC.
+ *
+ * As transferências de todos os painéis entram em uma fila circular única e são
+ * despachadas por DMA, uma rajada por vez, alternando entre painéis à medida que
+ * cada rajada termina. Assim dois displays no mesmo SPI são atualizados em paralelo
+ * sem que o chamador precise serializar os desenhos.
+ */
+typedef struct st7735_bus {
+    spi_inst_t *spi;                                    // Instância SPI compartilhada
+    int dma_channel;                                    // Canal DMA reservado para o barramento
+    st7735_transfer_t queue[ST7735_BUS_QUEUE_LEN];      // Fila de transferências pendentes
+    volatile uint8_t head;                              // Próxima posição livre
+    volatile uint8_t tail;                              // Transferência em andamento
+    volatile bool busy;                                 // Há uma rajada DMA em curso
+    st7735_t *active;                                   // Painel com CS ativo no momento
+} st7735_bus_t;
+
 typedef enum {
     ST7735_MADCTL_MY  = 0x80,
     ST7735_MADCTL_MX  = 0x40,
@@ -64,8 +110,10 @@ typedef enum {
     ST7735_RAMRD   = 0x2E,
 
     ST7735_PTLAR   = 0x30,
+    ST7735_VSCRDEF = 0x33,
     ST7735_COLMOD  = 0x3A,
     ST7735_MADCTL  = 0x36,
+    ST7735_VSCSAD  = 0x37,
 
     ST7735_FRMCTR1 = 0xB1,
     ST7735_FRMCTR2 = 0xB2,
@@ -102,7 +150,28 @@ typedef enum {
     ST7735_WHITE   = 0xFFFF
 } st7735_color_t;
 
-void st7735_backlight(bool state);
+/**
+ * @brief Console de texto sobre a área de rolagem vertical do controlador.
+ *
+ * Cada nova linha é escrita apenas na faixa de memória que ficou visível e o
+ * ponteiro de rolagem (VSCSAD) é avançado, em vez de redesenhar todas as linhas.
+ * A rolagem de hardware atua no eixo vertical da memória do painel, portanto o
+ * console deve ser usado com rotação retrato (0 ou 2).
+ */
+typedef struct {
+    st7735_t *st;               // Display onde o console é desenhado
+    st7735_font_def_t font;     // Fonte usada nas linhas
+    st7735_color_t color;       // Cor do texto
+    st7735_color_t bgcolor;     // Cor de fundo
+    uint16_t top_fixed;         // Linhas fixas no topo (TFA)
+    uint16_t bottom_fixed;      // Linhas fixas na base (BFA)
+    uint16_t scroll_height;     // Altura da área de rolagem (VSA), em pixels
+    uint16_t scroll_start;      // Linha do painel no topo da rolagem (VSCSAD sem o y_start)
+    uint16_t rows;              // Quantidade de linhas de texto na área de rolagem
+    uint16_t used_rows;         // Linhas já escritas desde a última limpeza
+} st7735_console_t;
+
+void st7735_backlight(st7735_t *st, bool state);
 
 st7735_t st7735_init(spi_inst_t *spi, uint8_t cs, uint8_t sck, uint8_t mosi, uint8_t rst, uint8_t dc, uint8_t blk, st7735_model_t model);
 
@@ -148,10 +217,359 @@ void st7735_draw_hline(st7735_t *st, int16_t x, int16_t y, int16_t width, st7735
 
 void st7735_set_rotation(st7735_t *st, uint8_t m);
 
-uint8_t st7735_get_rotation();
-
-int16_t st7735_get_height();
-
-int16_t st7735_get_width();
+uint8_t st7735_get_rotation(st7735_t *st);
+
+int16_t st7735_get_height(st7735_t *st);
+
+int16_t st7735_get_width(st7735_t *st);
+
+
+/**
+ * @brief Inicializa um barramento SPI compartilhado e reserva um canal DMA para ele.
+ *
+ * A aplicação encaminha a IRQ do DMA (`DMA_IRQ_0`, ou `DMA_IRQ_1` com
+ * `ST7735_BUS_DMA_IRQ` 1) para st7735_bus_irq_handler, por exemplo com
+ * irq_add_shared_handler e irq_set_enabled.
+ *
+ * @param bus Barramento.
+ * @param spi Instância SPI compartilhada pelos painéis.
+ * @param baudrate Frequência do SPI em Hz.
+ */
+static inline void st7735_bus_init(st7735_bus_t *bus, spi_inst_t *spi, uint baudrate) {
+    bus->spi = spi;
+    bus->head = 0;
+    bus->tail = 0;
+    bus->busy = false;
+    bus->active = NULL;
+    spi_init(spi, baudrate);
+
+    bus->dma_channel = dma_claim_unused_channel(true);
+    dma_channel_config config = dma_channel_get_default_config(bus->dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, spi_get_dreq(spi, true));
+    dma_channel_configure(bus->dma_channel, &config, &spi_get_hw(spi)->dr, NULL, 0, false);
+    dma_irqn_set_channel_enabled(ST7735_BUS_DMA_IRQ, bus->dma_channel, true);
+}
+
+/**
+ * @brief Liga um painel ao barramento: a partir daí, suas escritas passam pela fila.
+ */
+static inline void st7735_bus_attach(st7735_bus_t *bus, st7735_t *st) {
+    st->bus = bus;
+    st->spi = bus->spi;
+    gpio_put(st->cs, 1);
+}
+
+/**
+ * @brief Despacha a transferência em `tail`, ou libera o barramento se a fila esvaziou.
+ *
+ * Chamada com o barramento ocupado: da IRQ do DMA ou de st7735_bus_submit com as
+ * interrupções desabilitadas.
+ */
+static inline void st7735_bus_dispatch(st7735_bus_t *bus) {
+    spi_inst_t *spi = bus->spi;
+
+    // O DMA termina ao preencher a FIFO: CS e DC só mudam depois do último bit
+    while (spi_is_busy(spi)) {
+        tight_loop_contents();
+    }
+    while (spi_is_readable(spi)) {
+        (void)spi_get_hw(spi)->dr;
+    }
+    spi_get_hw(spi)->icr = SPI_SSPICR_RORIC_BITS; // Descarta o overrun da recepção
+
+    if (bus->tail == bus->head) {
+        if (bus->active) {
+            gpio_put(bus->active->cs, 1);
+            bus->active = NULL;
+        }
+        bus->busy = false;
+        return;
+    }
+
+    const st7735_transfer_t *transfer = &bus->queue[bus->tail];
+    if (bus->active != transfer->st) {
+        if (bus->active) {
+            gpio_put(bus->active->cs, 1);
+        }
+        gpio_put(transfer->st->cs, 0);
+        bus->active = transfer->st;
+    }
+    gpio_put(transfer->st->dc, transfer->is_data);
+    dma_channel_transfer_from_buffer_now(bus->dma_channel, transfer->data, transfer->len);
+}
+
+/**
+ * @brief Enfileira uma transferência para um painel; começa na hora se o barramento está livre.
+ *
+ * As rajadas são despachadas na ordem de chegada, então os envios de painéis diferentes se
+ * intercalam: enquanto o DMA transmite o quadro de um painel, a CPU já prepara o do outro.
+ * Deve ser chamada sempre do mesmo núcleo que atende a IRQ do DMA.
+ *
+ * @param bus Barramento.
+ * @param st Painel de destino (ligado com st7735_bus_attach).
+ * @param data Buffer; deve permanecer válido até st7735_bus_busy(bus, st) retornar false.
+ * @param len Tamanho em bytes.
+ * @param is_data true para dados (DC alto), false para comando.
+ * @return false se a fila está cheia.
+ */
+static inline bool st7735_bus_submit(st7735_bus_t *bus, st7735_t *st, const uint8_t *data, size_t len, bool is_data) {
+    uint8_t next = (bus->head + 1) % ST7735_BUS_QUEUE_LEN;
+
+    if (len == 0) {
+        return true;
+    }
+    if (next == bus->tail) {
+        return false;
+    }
+    bus->queue[bus->head] = (st7735_transfer_t){.st = st, .data = data, .len = len, .is_data = is_data};
+
+    uint32_t irq = save_and_disable_interrupts();
+    bus->head = next;
+    if (!bus->busy) {
+        bus->busy = true;
+        st7735_bus_dispatch(bus);
+    }
+    restore_interrupts(irq);
+    return true;
+}
+
+/**
+ * @brief Indica se ainda há transferências do painel na fila (ou de qualquer painel, com st NULL).
+ */
+static inline bool st7735_bus_busy(st7735_bus_t *bus, st7735_t *st) {
+    if (!bus->busy) {
+        return false;
+    }
+    if (!st) {
+        return true;
+    }
+    for (uint8_t i = bus->tail; i != bus->head; i = (i + 1) % ST7735_BUS_QUEUE_LEN) {
+        if (bus->queue[i].st == st) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Aguarda o fim das transferências do painel (ou de todos, com st NULL).
+ */
+static inline void st7735_bus_wait(st7735_bus_t *bus, st7735_t *st) {
+    while (st7735_bus_busy(bus, st)) {
+        tight_loop_contents();
+    }
+}
+
+/**
+ * @brief Trata a IRQ do DMA: conclui a rajada atual e despacha a próxima da fila.
+ *
+ * Pode ser chamada de um handler compartilhado: ignora IRQs de outros canais.
+ */
+static inline void st7735_bus_irq_handler(st7735_bus_t *bus) {
+    if (!bus->busy || !dma_irqn_get_channel_status(ST7735_BUS_DMA_IRQ, bus->dma_channel)) {
+        return;
+    }
+    dma_irqn_acknowledge_channel(ST7735_BUS_DMA_IRQ, bus->dma_channel);
+    bus->tail = (bus->tail + 1) % ST7735_BUS_QUEUE_LEN;
+    st7735_bus_dispatch(bus);
+}
+
+/**
+ * @brief Envia um comando ou um bloco de dados ao painel, com CS e DC do próprio painel.
+ *
+ * Em um barramento compartilhado, a escrita entra na fila e a função aguarda sua conclusão,
+ * já que os parâmetros costumam estar na pilha.
+ */
+static inline void st7735_write(st7735_t *st, const uint8_t *data, size_t len, bool is_data) {
+    if (st->bus) {
+        while (!st7735_bus_submit(st->bus, st, data, len, is_data)) {
+            tight_loop_contents();
+        }
+        st7735_bus_wait(st->bus, st);
+        return;
+    }
+    gpio_put(st->dc, is_data);
+    gpio_put(st->cs, 0);
+    spi_write_blocking(st->spi, data, len);
+    gpio_put(st->cs, 1);
+}
+
+static inline void st7735_write_command(st7735_t *st, uint8_t cmd, const uint8_t *params, size_t len) {
+    st7735_write(st, &cmd, 1, false);
+    if (len) {
+        st7735_write(st, params, len, true);
+    }
+}
+
+/**
+ * @brief Abre a janela [x0, x1] x [y0, y1] (coordenadas do painel) e inicia um RAMWR.
+ */
+static inline void st7735_write_window(st7735_t *st, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+    x0 += st->x_start;
+    x1 += st->x_start;
+    y0 += st->y_start;
+    y1 += st->y_start;
+    uint8_t caset[4] = {x0 >> 8, x0 & 0xFF, x1 >> 8, x1 & 0xFF};
+    uint8_t raset[4] = {y0 >> 8, y0 & 0xFF, y1 >> 8, y1 & 0xFF};
+    st7735_write_command(st, ST7735_CASET, caset, 4);
+    st7735_write_command(st, ST7735_RASET, raset, 4);
+    st7735_write_command(st, ST7735_RAMWR, NULL, 0);
+}
+
+/**
+ * @brief Define a área de rolagem vertical (VSCRDEF), entre as faixas fixas do topo e da base.
+ *
+ * As linhas fora da altura visível do painel (memória de 162 linhas) entram na faixa fixa da base.
+ *
+ * @param st Display.
+ * @param top_fixed Linhas visíveis fixas no topo.
+ * @param bottom_fixed Linhas visíveis fixas na base.
+ */
+static inline void st7735_set_scroll_area(st7735_t *st, uint16_t top_fixed, uint16_t bottom_fixed) {
+    uint16_t tfa = st->y_start + top_fixed;
+    uint16_t vsa = st->height - top_fixed - bottom_fixed;
+    uint16_t bfa = ST7735_GRAM_HEIGHT - tfa - vsa;
+    uint8_t params[6] = {tfa >> 8, tfa & 0xFF, vsa >> 8, vsa & 0xFF, bfa >> 8, bfa & 0xFF};
+    st7735_write_command(st, ST7735_VSCRDEF, params, 6);
+}
+
+/**
+ * @brief Define a linha do painel exibida no topo da área de rolagem (VSCSAD).
+ *
+ * @param st Display.
+ * @param line Linha do painel, de top_fixed até o fim da área de rolagem.
+ */
+static inline void st7735_scroll_to(st7735_t *st, uint16_t line) {
+    uint16_t ssa = st->y_start + line;
+    uint8_t params[2] = {ssa >> 8, ssa & 0xFF};
+    st7735_write_command(st, ST7735_VSCSAD, params, 2);
+}
+
+/**
+ * @brief Desenha uma linha de texto do console em `y`, ocupando toda a largura do painel.
+ *
+ * O texto é expandido linha de pixel a linha de pixel e enviado em uma única janela; o
+ * restante da linha é preenchido com a cor de fundo.
+ */
+static inline void st7735_console_draw_line(st7735_console_t *con, uint16_t y, const char *str, size_t len) {
+    st7735_t *st = con->st;
+    uint16_t width = st->width < ST7735_MAX_WIDTH ? st->width : ST7735_MAX_WIDTH;
+    uint8_t pixels[2 * ST7735_MAX_WIDTH];
+
+    st7735_write_window(st, 0, y, width - 1, y + con->font.height - 1);
+    for (uint8_t row = 0; row < con->font.height; row++) {
+        for (uint16_t x = 0; x < width; x++) {
+            uint16_t color = con->bgcolor;
+            size_t col = x / con->font.width;
+            if (col < len) {
+                char c = str[col];
+                if (c < ' ' || c > '~') {
+                    c = ' ';
+                }
+                uint16_t bits = con->font.data[(c - ' ') * con->font.height + row];
+                if (bits & (0x8000 >> (x % con->font.width))) {
+                    color = con->color;
+                }
+            }
+            pixels[2 * x] = color >> 8;
+            pixels[2 * x + 1] = color & 0xFF;
+        }
+        st7735_write(st, pixels, 2 * width, true);
+    }
+}
+
+/**
+ * @brief Limpa a área de rolagem e volta o console para a primeira linha.
+ */
+static inline void st7735_console_clear(st7735_console_t *con) {
+    for (uint16_t i = 0; i < con->rows; i++) {
+        st7735_console_draw_line(con, con->top_fixed + i * con->font.height, "", 0);
+    }
+    con->scroll_start = con->top_fixed;
+    con->used_rows = 0;
+    st7735_scroll_to(con->st, con->scroll_start);
+}
+
+/**
+ * @brief Cria um console de texto na área entre as faixas fixas e a limpa.
+ *
+ * A área de rolagem é ajustada para um múltiplo da altura da fonte; a sobra vai para a
+ * faixa fixa da base.
+ *
+ * @param st Display, em rotação retrato.
+ * @param top_fixed Linhas fixas no topo (cabeçalho).
+ * @param bottom_fixed Linhas fixas na base (rodapé).
+ * @param font Fonte das linhas.
+ * @param color Cor do texto.
+ * @param bgcolor Cor de fundo.
+ * @return Console pronto para st7735_console_print.
+ */
+static inline st7735_console_t st7735_console_init(st7735_t *st, uint16_t top_fixed, uint16_t bottom_fixed,
+                                                   st7735_font_def_t font, st7735_color_t color,
+                                                   st7735_color_t bgcolor) {
+    uint16_t rows = (st->height - top_fixed - bottom_fixed) / font.height;
+    st7735_console_t con = {
+        .st = st,
+        .font = font,
+        .color = color,
+        .bgcolor = bgcolor,
+        .top_fixed = top_fixed,
+        .bottom_fixed = st->height - top_fixed - rows * font.height,
+        .scroll_height = rows * font.height,
+        .scroll_start = top_fixed,
+        .rows = rows,
+        .used_rows = 0,
+    };
+
+    st7735_set_scroll_area(st, con.top_fixed, con.bottom_fixed);
+    st7735_console_clear(&con);
+    return con;
+}
+
+/**
+ * @brief Acrescenta uma linha de texto ao console.
+ *
+ * Enquanto há linhas livres, o texto é escrito abaixo da última. Depois, a linha mais
+ * antiga (no topo da rolagem) é sobrescrita e o ponteiro de rolagem avança uma linha:
+ * cada nova entrada custa uma linha de texto em pixels e um VSCSAD, sem redesenhar o resto.
+ * Quebras de linha ('\n') e textos mais largos que o painel ocupam várias linhas.
+ *
+ * @param con Console.
+ * @param str Texto (ASCII).
+ */
+static inline void st7735_console_print(st7735_console_t *con, const char *str) {
+    size_t cols = con->st->width / con->font.width;
+
+    if (con->rows == 0 || cols == 0) {
+        return;
+    }
+    do {
+        size_t len = 0;
+        while (str[len] && str[len] != '\n' && len < cols) {
+            len++;
+        }
+
+        if (con->used_rows < con->rows) {
+            st7735_console_draw_line(con, con->top_fixed + con->used_rows * con->font.height, str, len);
+            con->used_rows++;
+        } else {
+            // A linha do topo é a mais antiga: reescrita, passa a ser exibida na base
+            st7735_console_draw_line(con, con->scroll_start, str, len);
+            con->scroll_start += con->font.height;
+            if (con->scroll_start >= con->top_fixed + con->scroll_height) {
+                con->scroll_start = con->top_fixed;
+            }
+            st7735_scroll_to(con->st, con->scroll_start);
+        }
+
+        str += len;
+        if (*str == '\n') {
+            str++;
+        }
+    } while (*str);
+}
 
 #endif // ST7735_H
\ No newline at end of file
@@ -0,0 +1,278 @@
+/* Gerado por st7735_fontgen.py a partir de st7735_font_7x10.bdf */
+#ifndef ST7735_FONT_7X10_PACKED_H
+#define ST7735_FONT_7X10_PACKED_H
+
+#include "st7735_packed_font.h"
+
+static const uint8_t st7735_font_7x10_packed_bitmap[] = {
+    0xFD, 0x2D, 0xA0, 0x00, 0x00, 0x4A, 0x7E, 0x99, 0x7E, 0x52, 0x00, 0x1D, 0x5A, 0x38, 0xB5, 0xAB,
+    0x88, 0x04, 0x56, 0xCC, 0x55, 0x4A, 0x20, 0x00, 0x8A, 0x51, 0x1B, 0x29, 0x34, 0x00, 0xE0, 0x0A,
+    0x92, 0x49, 0x11, 0x88, 0x92, 0x49, 0x51, 0x75, 0x40, 0x00, 0x00, 0x00, 0x84, 0xF9, 0x08, 0x00,
+    0x00, 0x07, 0x0E, 0x82, 0x0B, 0x01, 0x09, 0x49, 0x29, 0x00, 0x74, 0x63, 0x58, 0xC6, 0x2E, 0x00,
+    0x0B, 0xA4, 0x92, 0x40, 0x74, 0x62, 0x11, 0x11, 0x1F, 0x00, 0x1D, 0x10, 0x98, 0x21, 0x8B, 0x80,
+    0x01, 0x19, 0x4A, 0x97, 0xC4, 0x20, 0x03, 0xF0, 0x87, 0x82, 0x18, 0xB8, 0x00, 0x74, 0x61, 0xE8,
+    0xC6, 0x2E, 0x00, 0x3E, 0x11, 0x10, 0x88, 0x42, 0x00, 0x07, 0x46, 0x2E, 0x8C, 0x62, 0xE0, 0x01,
+    0xD1, 0x8C, 0x5E, 0x18, 0xB8, 0x00, 0x21, 0x04, 0x70, 0x00, 0x6C, 0x83, 0x06, 0x00, 0x00, 0x0E,
+    0x84, 0x04, 0x84, 0x13, 0x00, 0x30, 0x60, 0x9B, 0x00, 0x00, 0x1D, 0x10, 0x88, 0x84, 0x01, 0x00,
+    0x07, 0x46, 0x75, 0xBC, 0x20, 0xE0, 0x00, 0x8A, 0x52, 0x95, 0xF8, 0xC4, 0x00, 0xF4, 0x63, 0xE8,
+    0xC6, 0x3E, 0x00, 0x1D, 0x18, 0x42, 0x10, 0x8B, 0x80, 0x0E, 0x4A, 0x31, 0x8C, 0x65, 0xC0, 0x03,
+    0xF0, 0x87, 0xE1, 0x08, 0x7C, 0x00, 0xFC, 0x21, 0xE8, 0x42, 0x10, 0x00, 0x1D, 0x18, 0x42, 0xF1,
+    0x8B, 0x80, 0x08, 0xC6, 0x3F, 0x8C, 0x63, 0x10, 0x03, 0xA4, 0x92, 0x5C, 0x00, 0x84, 0x21, 0x08,
+    0x62, 0xE0, 0x02, 0x32, 0xA6, 0x29, 0x29, 0x44, 0x00, 0x84, 0x21, 0x08, 0x42, 0x1F, 0x00, 0x23,
+    0xBD, 0xD6, 0x31, 0x8C, 0x40, 0x08, 0xE7, 0x35, 0xAC, 0xE7, 0x10, 0x01, 0xD1, 0x8C, 0x63, 0x18,
+    0xB8, 0x00, 0xF4, 0x63, 0x1F, 0x42, 0x10, 0x00, 0x1D, 0x18, 0xC6, 0x31, 0xAB, 0x82, 0x0F, 0x46,
+    0x31, 0xF4, 0xA5, 0x10, 0x01, 0xD1, 0x83, 0x04, 0x18, 0xB8, 0x00, 0xF9, 0x08, 0x42, 0x10, 0x84,
+    0x00, 0x23, 0x18, 0xC6, 0x31, 0x8B, 0x80, 0x08, 0xC6, 0x2A, 0x52, 0x88, 0x40, 0x02, 0x31, 0xAD,
+    0x6B, 0xB5, 0x28, 0x00, 0x8A, 0x94, 0x42, 0x29, 0x51, 0x00, 0x23, 0x15, 0x28, 0x84, 0x21, 0x00,
+    0x0F, 0x84, 0x44, 0x22, 0x21, 0xF0, 0x03, 0xAA, 0xAA, 0xE4, 0x49, 0x22, 0x40, 0xD5, 0x55, 0x72,
+    0x29, 0x51, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x86, 0x90, 0x00, 0x00, 0x01, 0xD1, 0x7C, 0x66, 0xD0,
+    0x02, 0x10, 0xB6, 0x63, 0x1C, 0xD8, 0x00, 0x00, 0x1D, 0x18, 0x42, 0x2E, 0x00, 0x02, 0x16, 0xCE,
+    0x31, 0x9B, 0x40, 0x00, 0x01, 0xD1, 0xFC, 0x22, 0xE0, 0x00, 0x64, 0xF9, 0x08, 0x42, 0x10, 0x00,
+    0x00, 0x1B, 0x38, 0xC6, 0x6D, 0x0F, 0xA1, 0x0B, 0x66, 0x31, 0x8C, 0x40, 0x02, 0x39, 0x24, 0x90,
+    0x04, 0x1C, 0x44, 0x44, 0x47, 0xA1, 0x09, 0x53, 0x14, 0x94, 0x40, 0x0E, 0x49, 0x24, 0x90, 0x00,
+    0x0F, 0x56, 0xB5, 0xAD, 0x40, 0x00, 0x02, 0xD9, 0x8C, 0x63, 0x10, 0x00, 0x00, 0x74, 0x63, 0x18,
+    0xB8, 0x00, 0x00, 0x2D, 0x98, 0xC7, 0x36, 0x84, 0x00, 0x06, 0xCE, 0x31, 0x9B, 0x42, 0x10, 0x02,
+    0xD9, 0x84, 0x21, 0x00, 0x00, 0x00, 0x74, 0x58, 0x28, 0xB8, 0x00, 0x44, 0xF4, 0x44, 0x43, 0x00,
+    0x00, 0x23, 0x18, 0xC6, 0x6D, 0x00, 0x00, 0x08, 0xC5, 0x4A, 0x51, 0x00, 0x00, 0x02, 0xB5, 0xAE,
+    0xD4, 0xA0, 0x00, 0x00, 0x8A, 0x88, 0x45, 0x44, 0x00, 0x00, 0x23, 0x15, 0x28, 0x84, 0x26, 0x00,
+    0x0F, 0x88, 0x88, 0x87, 0xC0, 0x06, 0x92, 0x91, 0x24, 0xC0, 0x89, 0xC9, 0x22, 0x52, 0x58, 0x00,
+    0x07, 0x66, 0x00, 0x00, 0x00, 0x74, 0x61, 0x08, 0x42, 0x2E, 0x23, 0x10, 0x47, 0x45, 0xF1, 0x9B,
+    0x40, 0x01, 0x11, 0xD1, 0x7C, 0x66, 0xD0, 0x00, 0x8A, 0x74, 0x5F, 0x19, 0xB4, 0x00, 0x6D, 0x9D,
+    0x17, 0xC6, 0x6D, 0x00, 0x00, 0x07, 0x46, 0x10, 0x8B, 0x88, 0xC1, 0x11, 0xD1, 0xFC, 0x22, 0xE0,
+    0x00, 0x8A, 0x74, 0x7F, 0x08, 0xB8, 0x00, 0x12, 0xE2, 0x22, 0x22, 0x00, 0x11, 0x1D, 0x18, 0xC6,
+    0x2E, 0x00, 0x08, 0xA7, 0x46, 0x31, 0x8B, 0x80, 0x06, 0xD9, 0xD1, 0x8C, 0x62, 0xE0, 0x00, 0x44,
+    0x8C, 0x63, 0x19, 0xB4, 0x00, 0x02, 0xA3, 0x18, 0xC6, 0x6D, 0x00, 0x00,
+};
+
+static const st7735_glyph_t st7735_font_7x10_packed_glyphs[] = {
+    {0, 0, 7, 0, 0}, // U+0020
+    {0, 1, 7, 0, 3}, // !
+    {10, 3, 7, 0, 2}, // "
+    {40, 5, 7, 0, 1}, // #
+    {90, 5, 7, 0, 1}, // $
+    {140, 5, 7, 0, 1}, // %
+    {190, 5, 7, 0, 1}, // &
+    {240, 1, 7, 0, 3}, // '
+    {250, 3, 7, 0, 2}, // (
+    {280, 3, 7, 0, 2}, // )
+    {310, 3, 7, 0, 2}, // *
+    {340, 5, 7, 0, 1}, // +
+    {390, 1, 7, 0, 3}, // ,
+    {50, 3, 7, 1, 2}, // -
+    {424, 1, 7, 0, 3}, // .
+    {434, 3, 7, 0, 2}, // /
+    {464, 5, 7, 0, 1}, // 0
+    {514, 3, 7, 0, 1}, // 1
+    {544, 5, 7, 0, 1}, // 2
+    {594, 5, 7, 0, 1}, // 3
+    {644, 5, 7, 0, 1}, // 4
+    {694, 5, 7, 0, 1}, // 5
+    {744, 5, 7, 0, 1}, // 6
+    {794, 5, 7, 0, 1}, // 7
+    {844, 5, 7, 0, 1}, // 8
+    {894, 5, 7, 0, 1}, // 9
+    {944, 1, 7, 0, 3}, // :
+    {954, 1, 7, 0, 3}, // ;
+    {964, 5, 7, 0, 1}, // <
+    {127, 5, 7, 1, 1}, // =
+    {1056, 5, 7, 0, 1}, // >
+    {1106, 5, 7, 0, 1}, // ?
+    {1156, 5, 7, 0, 1}, // @
+    {1206, 5, 7, 0, 1}, // A
+    {1256, 5, 7, 0, 1}, // B
+    {1306, 5, 7, 0, 1}, // C
+    {1356, 5, 7, 0, 1}, // D
+    {1406, 5, 7, 0, 1}, // E
+    {1456, 5, 7, 0, 1}, // F
+    {1506, 5, 7, 0, 1}, // G
+    {1556, 5, 7, 0, 1}, // H
+    {1606, 3, 7, 0, 2}, // I
+    {1636, 5, 7, 0, 1}, // J
+    {1686, 5, 7, 0, 1}, // K
+    {1736, 5, 7, 0, 1}, // L
+    {1786, 5, 7, 0, 1}, // M
+    {1836, 5, 7, 0, 1}, // N
+    {1886, 5, 7, 0, 1}, // O
+    {1936, 5, 7, 0, 1}, // P
+    {1986, 5, 7, 0, 1}, // Q
+    {2036, 5, 7, 0, 1}, // R
+    {2086, 5, 7, 0, 1}, // S
+    {2136, 5, 7, 0, 1}, // T
+    {2186, 5, 7, 0, 1}, // U
+    {2236, 5, 7, 0, 1}, // V
+    {2286, 5, 7, 0, 1}, // W
+    {2336, 5, 7, 0, 1}, // X
+    {2386, 5, 7, 0, 1}, // Y
+    {2436, 5, 7, 0, 1}, // Z
+    {2486, 2, 7, 0, 3}, // [
+    {2506, 3, 7, 0, 2}, // U+005C
+    {2536, 2, 7, 0, 2}, // ]
+    {2556, 5, 7, 0, 1}, // ^
+    {326, 7, 7, 1, 0}, // _
+    {2624, 2, 7, 0, 2}, // `
+    {2644, 5, 7, 0, 1}, // a
+    {2694, 5, 7, 0, 1}, // b
+    {2744, 5, 7, 0, 1}, // c
+    {2794, 5, 7, 0, 1}, // d
+    {2844, 5, 7, 0, 1}, // e
+    {2894, 5, 7, 0, 1}, // f
+    {2944, 5, 7, 0, 1}, // g
+    {2994, 5, 7, 0, 1}, // h
+    {3044, 3, 7, 0, 1}, // i
+    {3074, 4, 7, 0, 0}, // j
+    {3114, 5, 7, 0, 1}, // k
+    {3164, 3, 7, 0, 1}, // l
+    {3194, 5, 7, 0, 1}, // m
+    {3244, 5, 7, 0, 1}, // n
+    {3294, 5, 7, 0, 1}, // o
+    {3344, 5, 7, 0, 1}, // p
+    {3394, 5, 7, 0, 1}, // q
+    {3444, 5, 7, 0, 1}, // r
+    {3494, 5, 7, 0, 1}, // s
+    {3544, 4, 7, 0, 1}, // t
+    {3584, 5, 7, 0, 1}, // u
+    {3634, 5, 7, 0, 1}, // v
+    {3684, 5, 7, 0, 1}, // w
+    {3734, 5, 7, 0, 1}, // x
+    {3784, 5, 7, 0, 1}, // y
+    {3834, 5, 7, 0, 1}, // z
+    {3884, 3, 7, 0, 2}, // {
+    {490, 1, 7, 1, 3}, // |
+    {3928, 3, 7, 0, 2}, // }
+    {3958, 5, 7, 0, 1}, // ~
+    {0, 0, 0, 0, 0}, // U+007F
+    {0, 0, 0, 0, 0}, // U+0080
+    {0, 0, 0, 0, 0}, // U+0081
+    {0, 0, 0, 0, 0}, // U+0082
+    {0, 0, 0, 0, 0}, // U+0083
+    {0, 0, 0, 0, 0}, // U+0084
+    {0, 0, 0, 0, 0}, // U+0085
+    {0, 0, 0, 0, 0}, // U+0086
+    {0, 0, 0, 0, 0}, // U+0087
+    {0, 0, 0, 0, 0}, // U+0088
+    {0, 0, 0, 0, 0}, // U+0089
+    {0, 0, 0, 0, 0}, // U+008A
+    {0, 0, 0, 0, 0}, // U+008B
+    {0, 0, 0, 0, 0}, // U+008C
+    {0, 0, 0, 0, 0}, // U+008D
+    {0, 0, 0, 0, 0}, // U+008E
+    {0, 0, 0, 0, 0}, // U+008F
+    {0, 0, 0, 0, 0}, // U+0090
+    {0, 0, 0, 0, 0}, // U+0091
+    {0, 0, 0, 0, 0}, // U+0092
+    {0, 0, 0, 0, 0}, // U+0093
+    {0, 0, 0, 0, 0}, // U+0094
+    {0, 0, 0, 0, 0}, // U+0095
+    {0, 0, 0, 0, 0}, // U+0096
+    {0, 0, 0, 0, 0}, // U+0097
+    {0, 0, 0, 0, 0}, // U+0098
+    {0, 0, 0, 0, 0}, // U+0099
+    {0, 0, 0, 0, 0}, // U+009A
+    {0, 0, 0, 0, 0}, // U+009B
+    {0, 0, 0, 0, 0}, // U+009C
+    {0, 0, 0, 0, 0}, // U+009D
+    {0, 0, 0, 0, 0}, // U+009E
+    {0, 0, 0, 0, 0}, // U+009F
+    {0, 0, 0, 0, 0}, // U+00A0
+    {0, 0, 0, 0, 0}, // U+00A1
+    {0, 0, 0, 0, 0}, // U+00A2
+    {0, 0, 0, 0, 0}, // U+00A3
+    {0, 0, 0, 0, 0}, // U+00A4
+    {0, 0, 0, 0, 0}, // U+00A5
+    {0, 0, 0, 0, 0}, // U+00A6
+    {0, 0, 0, 0, 0}, // U+00A7
+    {0, 0, 0, 0, 0}, // U+00A8
+    {0, 0, 0, 0, 0}, // U+00A9
+    {0, 0, 0, 0, 0}, // U+00AA
+    {0, 0, 0, 0, 0}, // U+00AB
+    {0, 0, 0, 0, 0}, // U+00AC
+    {0, 0, 0, 0, 0}, // U+00AD
+    {0, 0, 0, 0, 0}, // U+00AE
+    {0, 0, 0, 0, 0}, // U+00AF
+    {0, 0, 0, 0, 0}, // U+00B0
+    {0, 0, 0, 0, 0}, // U+00B1
+    {0, 0, 0, 0, 0}, // U+00B2
+    {0, 0, 0, 0, 0}, // U+00B3
+    {0, 0, 0, 0, 0}, // U+00B4
+    {0, 0, 0, 0, 0}, // U+00B5
+    {0, 0, 0, 0, 0}, // U+00B6
+    {0, 0, 0, 0, 0}, // U+00B7
+    {0, 0, 0, 0, 0}, // U+00B8
+    {0, 0, 0, 0, 0}, // U+00B9
+    {0, 0, 0, 0, 0}, // U+00BA
+    {0, 0, 0, 0, 0}, // U+00BB
+    {0, 0, 0, 0, 0}, // U+00BC
+    {0, 0, 0, 0, 0}, // U+00BD
+    {0, 0, 0, 0, 0}, // U+00BE
+    {0, 0, 0, 0, 0}, // U+00BF
+    {0, 0, 0, 0, 0}, // U+00C0
+    {0, 0, 0, 0, 0}, // U+00C1
+    {0, 0, 0, 0, 0}, // U+00C2
+    {0, 0, 0, 0, 0}, // U+00C3
+    {0, 0, 0, 0, 0}, // U+00C4
+    {0, 0, 0, 0, 0}, // U+00C5
+    {0, 0, 0, 0, 0}, // U+00C6
+    {4008, 5, 7, 0, 1}, // U+00C7
+    {0, 0, 0, 0, 0}, // U+00C8
+    {0, 0, 0, 0, 0}, // U+00C9
+    {0, 0, 0, 0, 0}, // U+00CA
+    {0, 0, 0, 0, 0}, // U+00CB
+    {0, 0, 0, 0, 0}, // U+00CC
+    {0, 0, 0, 0, 0}, // U+00CD
+    {0, 0, 0, 0, 0}, // U+00CE
+    {0, 0, 0, 0, 0}, // U+00CF
+    {0, 0, 0, 0, 0}, // U+00D0
+    {0, 0, 0, 0, 0}, // U+00D1
+    {0, 0, 0, 0, 0}, // U+00D2
+    {0, 0, 0, 0, 0}, // U+00D3
+    {0, 0, 0, 0, 0}, // U+00D4
+    {0, 0, 0, 0, 0}, // U+00D5
+    {0, 0, 0, 0, 0}, // U+00D6
+    {0, 0, 0, 0, 0}, // U+00D7
+    {0, 0, 0, 0, 0}, // U+00D8
+    {0, 0, 0, 0, 0}, // U+00D9
+    {0, 0, 0, 0, 0}, // U+00DA
+    {0, 0, 0, 0, 0}, // U+00DB
+    {0, 0, 0, 0, 0}, // U+00DC
+    {0, 0, 0, 0, 0}, // U+00DD
+    {0, 0, 0, 0, 0}, // U+00DE
+    {0, 0, 0, 0, 0}, // U+00DF
+    {4058, 5, 7, 0, 1}, // U+00E0
+    {4108, 5, 7, 0, 1}, // U+00E1
+    {4158, 5, 7, 0, 1}, // U+00E2
+    {4208, 5, 7, 0, 1}, // U+00E3
+    {0, 0, 0, 0, 0}, // U+00E4
+    {0, 0, 0, 0, 0}, // U+00E5
+    {0, 0, 0, 0, 0}, // U+00E6
+    {4258, 5, 7, 0, 1}, // U+00E7
+    {0, 0, 0, 0, 0}, // U+00E8
+    {4308, 5, 7, 0, 1}, // U+00E9
+    {4358, 5, 7, 0, 1}, // U+00EA
+    {0, 0, 0, 0, 0}, // U+00EB
+    {0, 0, 0, 0, 0}, // U+00EC
+    {4408, 4, 7, 0, 1}, // U+00ED
+    {0, 0, 0, 0, 0}, // U+00EE
+    {0, 0, 0, 0, 0}, // U+00EF
+    {0, 0, 0, 0, 0}, // U+00F0
+    {0, 0, 0, 0, 0}, // U+00F1
+    {0, 0, 0, 0, 0}, // U+00F2
+    {4448, 5, 7, 0, 1}, // U+00F3
+    {4498, 5, 7, 0, 1}, // U+00F4
+    {4548, 5, 7, 0, 1}, // U+00F5
+    {0, 0, 0, 0, 0}, // U+00F6
+    {0, 0, 0, 0, 0}, // U+00F7
+    {0, 0, 0, 0, 0}, // U+00F8
+    {0, 0, 0, 0, 0}, // U+00F9
+    {4598, 5, 7, 0, 1}, // U+00FA
+    {0, 0, 0, 0, 0}, // U+00FB
+    {4648, 5, 7, 0, 1}, // U+00FC
+    {0, 0, 0, 0, 0}, // U+00FD
+    {0, 0, 0, 0, 0}, // U+00FE
+    {0, 0, 0, 0, 0}, // U+00FF
+};
+
+static const st7735_packed_font_t st7735_font_7x10_packed = {
+    10, 0x20, 224, st7735_font_7x10_packed_glyphs, st7735_font_7x10_packed_bitmap
+};
+
+#endif // ST7735_FONT_7X10_PACKED_H
@@ -0,0 +1,244 @@
+/* vim: set ai et ts=4 sw=4: */
+/**
+ * @file st7735_packed_font.h
+ *
+ * @brief Formato de fonte compactado (1bpp em fluxo de bits) para o ST7735.
+ *      Cada glifo guarda apenas `width * height` bits, com largura própria
+ *      (fontes proporcionais) e, opcionalmente, compressão por comprimento de
+ *      sequência (RLE). As linhas são expandidas diretamente em buffers RGB565,
+ *      prontos para serem enviados ao display após um RAMWR.
+ *
+ *      As fontes são geradas pela ferramenta `tools/st7735_fontgen.py` a partir
+ *      de arquivos BDF ou TTF.
+ */
+#ifndef ST7735_PACKED_FONT_H
+#define ST7735_PACKED_FONT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ST7735_GLYPH_RLE 0x01 // Bitmap do glifo codificado em RLE
+
+/**
+ * @brief Descritor de um glifo dentro do fluxo de bits da fonte.
+ *
+ * Sem RLE, `offset` é a posição (em bits) do primeiro pixel do glifo, e os
+ * pixels seguem linha a linha, `width` bits por linha, MSB primeiro. O bitmap
+ * cobre só a tinta: começa `xoff` colunas após a origem do glifo e pode passar
+ * de `advance`.
+ * Com RLE, `offset` é a posição em bytes da primeira sequência: cada byte
+ * codifica no bit 7 o valor do pixel e nos bits 0-6 o comprimento - 1.
+ */
+typedef struct {
+    uint32_t offset;  // Posição do glifo no bitmap (bits, ou bytes se RLE)
+    uint8_t width;    // Largura do glifo em pixels
+    uint8_t advance;  // Avanço horizontal até o próximo glifo
+    uint8_t flags;    // ST7735_GLYPH_RLE
+    int8_t xoff;      // Primeira coluna do bitmap em relação à origem (negativo: avança sobre o anterior)
+} st7735_glyph_t;
+
+/**
+ * @brief Fonte compactada. Os glifos cobrem os codepoints contíguos
+ * `first` a `first + count - 1` (por exemplo 0x20-0xFF para Latin-1).
+ */
+typedef struct {
+    uint8_t height;                 // Altura de todos os glifos em pixels
+    uint16_t first;                 // Primeiro codepoint presente
+    uint16_t count;                 // Quantidade de glifos
+    const st7735_glyph_t *glyphs;   // Tabela de glifos
+    const uint8_t *bitmap;          // Fluxo de bits / sequências RLE
+} st7735_packed_font_t;
+
+/**
+ * @brief Decodifica o próximo codepoint de uma string UTF-8.
+ *
+ * @param str Ponteiro para o cursor na string. É avançado até o próximo caractere.
+ * @return Codepoint decodificado, ou '?' para sequências inválidas.
+ */
+static inline uint32_t st7735_utf8_next(const char **str) {
+    const uint8_t *s = (const uint8_t *)*str;
+    uint32_t cp;
+    int extra;
+
+    if (s[0] < 0x80) {
+        cp = s[0];
+        extra = 0;
+    } else if ((s[0] & 0xE0) == 0xC0) {
+        cp = s[0] & 0x1F;
+        extra = 1;
+    } else if ((s[0] & 0xF0) == 0xE0) {
+        cp = s[0] & 0x0F;
+        extra = 2;
+    } else {
+        *str += 1;
+        return '?';
+    }
+
+    for (int i = 1; i <= extra; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            *str += i;
+            return '?';
+        }
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    *str += extra + 1;
+    return cp;
+}
+
+/**
+ * @brief Retorna o glifo de um codepoint, ou NULL se a fonte não o possui.
+ */
+static inline const st7735_glyph_t *st7735_packed_glyph(const st7735_packed_font_t *font, uint32_t cp) {
+    if (cp < font->first || cp >= (uint32_t)font->first + font->count) {
+        return NULL;
+    }
+    return &font->glyphs[cp - font->first];
+}
+
+/**
+ * @brief Expande uma linha de um glifo em pixels RGB565, preservando o fundo já desenhado.
+ *
+ * Os primeiros `keep` pixels já pertencem a outro glifo: recebem apenas a tinta deste.
+ */
+static inline void st7735_packed_glyph_row_over(const st7735_packed_font_t *font, const st7735_glyph_t *glyph,
+                                                uint8_t row, uint16_t *line, uint16_t color, uint16_t bgcolor,
+                                                uint8_t keep) {
+    uint32_t skip = (uint32_t)row * glyph->width;
+
+    if (glyph->flags & ST7735_GLYPH_RLE) {
+        // Percorre as sequências até a linha pedida, sem descompactar em memória
+        const uint8_t *run = &font->bitmap[glyph->offset];
+        uint32_t left = (*run & 0x7F) + 1;
+        while (skip >= left) {
+            skip -= left;
+            run++;
+            left = (*run & 0x7F) + 1;
+        }
+        left -= skip;
+        for (uint8_t x = 0; x < glyph->width; x++) {
+            if (left == 0) {
+                run++;
+                left = (*run & 0x7F) + 1;
+            }
+            if (*run & 0x80) {
+                line[x] = color;
+            } else if (x >= keep) {
+                line[x] = bgcolor;
+            }
+            left--;
+        }
+    } else {
+        uint32_t bit = glyph->offset + skip;
+        for (uint8_t x = 0; x < glyph->width; x++, bit++) {
+            if (font->bitmap[bit >> 3] & (0x80 >> (bit & 7))) {
+                line[x] = color;
+            } else if (x >= keep) {
+                line[x] = bgcolor;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Expande uma linha de um glifo em pixels RGB565.
+ *
+ * @param font Fonte compactada.
+ * @param glyph Glifo a ser expandido.
+ * @param row Linha do glifo (0 a height-1).
+ * @param line Buffer de saída, com pelo menos `glyph->width` posições.
+ * @param color Cor dos pixels acesos.
+ * @param bgcolor Cor dos pixels apagados.
+ */
+static inline void st7735_packed_glyph_row(const st7735_packed_font_t *font, const st7735_glyph_t *glyph,
+                                           uint8_t row, uint16_t *line, uint16_t color, uint16_t bgcolor) {
+    st7735_packed_glyph_row_over(font, glyph, row, line, color, bgcolor, 0);
+}
+
+/**
+ * @brief Posiciona um glifo no texto: primeira coluna do bitmap e fim da área ocupada.
+ *
+ * Um apoio negativo no início do texto desloca a origem (`*x`) para a tinta começar em 0.
+ */
+static inline void st7735_packed_place(const st7735_glyph_t *glyph, uint16_t *x, uint16_t *left, uint16_t *end) {
+    int32_t start = (int32_t)*x + glyph->xoff;
+    if (start < 0) {
+        *x -= start;
+        start = 0;
+    }
+    *left = start;
+    *end = *x + glyph->advance;
+    if (glyph->width && *left + glyph->width > *end) {
+        *end = *left + glyph->width; // Tinta além do avanço
+    }
+}
+
+/**
+ * @brief Calcula a largura em pixels de uma string UTF-8, incluindo a tinta além do último avanço.
+ */
+static inline uint16_t st7735_packed_text_width(const st7735_packed_font_t *font, const char *str) {
+    uint16_t x = 0, width = 0;
+    while (*str) {
+        const st7735_glyph_t *glyph = st7735_packed_glyph(font, st7735_utf8_next(&str));
+        if (glyph) {
+            uint16_t left, end;
+            st7735_packed_place(glyph, &x, &left, &end);
+            if (end > width) {
+                width = end;
+            }
+            x += glyph->advance;
+        }
+    }
+    return width;
+}
+
+/**
+ * @brief Expande uma linha de pixels de uma string inteira em um buffer RGB565.
+ *
+ * Desenhar um texto com esta função custa `height` chamadas e uma janela
+ * CASET/RASET, enviando cada linha como um único bloco após o RAMWR. Glifos
+ * que avançam sobre o vizinho (apoio negativo, itálicos) somam sua tinta à dele.
+ *
+ * @param font Fonte compactada.
+ * @param str String UTF-8.
+ * @param row Linha de pixels do texto (0 a height-1).
+ * @param line Buffer de saída.
+ * @param max_width Tamanho do buffer em pixels; o texto é cortado no último glifo que cabe inteiro.
+ * @param color Cor do texto.
+ * @param bgcolor Cor de fundo.
+ * @return Quantidade de pixels escritos em `line`.
+ */
+static inline uint16_t st7735_packed_text_row(const st7735_packed_font_t *font, const char *str, uint8_t row,
+                                              uint16_t *line, uint16_t max_width, uint16_t color, uint16_t bgcolor) {
+    uint16_t x = 0;   // Origem do próximo glifo
+    uint16_t end = 0; // Pixels já escritos em `line`
+
+    while (*str) {
+        const st7735_glyph_t *glyph = st7735_packed_glyph(font, st7735_utf8_next(&str));
+        if (!glyph) {
+            continue;
+        }
+        uint16_t left, cell_end;
+        st7735_packed_place(glyph, &x, &left, &cell_end);
+        if (cell_end > max_width) {
+            break; // Glifo não cabe inteiro no buffer
+        }
+
+        for (uint16_t i = end; i < cell_end; i++) {
+            line[i] = bgcolor;
+        }
+        // Expande direto na posição final, sem buffer intermediário
+        if (glyph->width) {
+            uint16_t keep = end > left ? end - left : 0;
+            st7735_packed_glyph_row_over(font, glyph, row, &line[left], color, bgcolor,
+                                         keep < glyph->width ? keep : glyph->width);
+        }
+        if (cell_end > end) {
+            end = cell_end;
+        }
+        x += glyph->advance;
+    }
+    return end;
+}
+
+#endif // ST7735_PACKED_FONT_H
@@ -0,0 +1,262 @@
+#!/usr/bin/env python3
+"""
+Verifica o formato de st7735_packed_font.h de ponta a ponta: gera fontes com
+st7735_fontgen.py, decodifica cada glifo e textos com o decodificador em C
+(compilado no host) e compara com os pixels do BDF de origem.
+
+Uso:
+    st7735_fontcheck.py            # fontes sintéticas + st7735_font_7x10_packed.h
+    CC=clang st7735_fontcheck.py
+
+As fontes sintéticas cobrem glifos com mais de 32 px de largura, apoio
+negativo, tinta além do avanço e RLE. A fonte distribuída também é gerada de
+novo a partir do BDF e comparada com o cabeçalho do repositório.
+Código de saída 0 se tudo conferir.
+"""
+import os
+import subprocess
+import sys
+import tempfile
+
+TOOLS = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(TOOLS)
+FONTGEN = os.path.join(TOOLS, "st7735_fontgen.py")
+
+SYNTHETIC_BDF = """STARTFONT 2.1
+FONT sintetica
+SIZE 6 75 75
+FONTBOUNDINGBOX 40 6 -2 -1
+STARTPROPERTIES 2
+FONT_ASCENT 5
+FONT_DESCENT 1
+ENDPROPERTIES
+CHARS 5
+STARTCHAR A
+ENCODING 65
+DWIDTH 6 0
+BBX 5 5 0 0
+BITMAP
+20
+50
+88
+F8
+88
+ENDCHAR
+STARTCHAR largo
+ENCODING 66
+DWIDTH 42 0
+BBX 40 3 1 0
+BITMAP
+8000000001
+FFFFFFFFFF
+A5A5A5A5A5
+ENDCHAR
+STARTCHAR apoio_negativo
+ENCODING 67
+DWIDTH 2 0
+BBX 4 6 -2 -1
+BITMAP
+90
+60
+60
+90
+90
+60
+ENDCHAR
+STARTCHAR italico
+ENCODING 68
+DWIDTH 3 0
+BBX 5 4 1 0
+BITMAP
+18
+30
+60
+C0
+ENDCHAR
+STARTCHAR space
+ENCODING 32
+DWIDTH 3 0
+BBX 0 0 0 0
+BITMAP
+ENDCHAR
+ENDFONT
+"""
+
+SYNTHETIC_TEXTS = ("A", "B", "AB", "CA", "ACA", "DDA", "A C", "BA")
+SHIPPED_TEXTS = ("Atenção", "Pressão: 1013 hPa", "Umidade média ~45%", "ÇÃ?")
+
+
+def read_bdf(path):
+    """Leitura independente do gerador: {codepoint: (advance, {(x, y) com tinta})}, altura."""
+    with open(path, encoding="latin-1") as f:
+        lines = [line.strip() for line in f]
+    props = {}
+    glyphs = {}
+    i = 0
+    while i < len(lines):
+        key, _, value = lines[i].partition(" ")
+        if key in ("FONT_ASCENT", "FONT_DESCENT"):
+            props[key] = int(value)
+        elif key == "STARTCHAR":
+            cp, advance, bbx, ink = None, 0, (0, 0, 0, 0), set()
+            i += 1
+            while not lines[i].startswith("BITMAP"):
+                key, _, value = lines[i].partition(" ")
+                if key == "ENCODING":
+                    cp = int(value)
+                elif key == "DWIDTH":
+                    advance = int(value.split()[0])
+                elif key == "BBX":
+                    bbx = tuple(int(v) for v in value.split())
+                i += 1
+            w, h, xoff, yoff = bbx
+            top = props["FONT_ASCENT"] - (yoff + h)
+            r = 0
+            i += 1
+            while not lines[i].startswith("ENDCHAR"):
+                bits = bin(int(lines[i], 16))[2:].zfill(len(lines[i]) * 4)
+                for x in range(w):
+                    if bits[x] == "1":
+                        ink.add((xoff + x, top + r))
+                r += 1
+                i += 1
+            glyphs[cp] = (advance, ink)
+        i += 1
+    return glyphs, props["FONT_ASCENT"] + props["FONT_DESCENT"]
+
+
+def expected_text(glyphs, height, text):
+    """Linhas esperadas de st7735_packed_text_row: tinta somada, origem deslocada por apoio negativo inicial."""
+    ink, pen, end = set(), 0, 0
+    for ch in text:
+        if ord(ch) not in glyphs:
+            continue
+        advance, dots = glyphs[ord(ch)]
+        if dots:
+            left = min(x for x, _ in dots)
+            if pen + left < 0:
+                pen = -left
+            end = max(end, pen + max(x for x, _ in dots) + 1)
+        end = max(end, pen + advance)
+        ink |= {(pen + x, y) for x, y in dots}
+        pen += advance
+    return ["".join("1" if (x, y) in ink else "0" for x in range(end)) for y in range(height)]
+
+
+def c_string(text):
+    return '"' + "".join("\\x%02X" % b for b in text.encode("utf-8")) + '"'
+
+
+HARNESS = r"""
+#include <stdio.h>
+#include "%(header)s"
+
+static const char *texts[] = {%(texts)s};
+
+int main(void) {
+    const st7735_packed_font_t *font = &%(name)s;
+    uint16_t line[1024];
+
+    for (uint16_t i = 0; i < font->count; i++) {
+        const st7735_glyph_t *glyph = &font->glyphs[i];
+        printf("G %%u %%u %%u %%d\n", font->first + i, glyph->width, glyph->advance, glyph->xoff);
+        for (uint8_t row = 0; row < font->height; row++) {
+            st7735_packed_glyph_row(font, glyph, row, line, 1, 0);
+            for (uint8_t x = 0; x < glyph->width; x++) {
+                putchar('0' + line[x]);
+            }
+            putchar('\n');
+        }
+    }
+    for (size_t t = 0; t < sizeof(texts) / sizeof(texts[0]); t++) {
+        printf("T %%zu %%u\n", t, st7735_packed_text_width(font, texts[t]));
+        for (uint8_t row = 0; row < font->height; row++) {
+            uint16_t n = st7735_packed_text_row(font, texts[t], row, line, 1024, 1, 0);
+            for (uint16_t x = 0; x < n; x++) {
+                putchar('0' + line[x]);
+            }
+            putchar('\n');
+        }
+    }
+    return 0;
+}
+"""
+
+
+def decode(tmp, header, name, texts):
+    """Compila o harness com o cabeçalho gerado e retorna (glifos, textos) decodificados."""
+    src = os.path.join(tmp, name + "_check.c")
+    exe = os.path.join(tmp, name + "_check")
+    with open(src, "w") as f:
+        f.write(HARNESS % {"header": header, "name": name, "texts": ", ".join(c_string(t) for t in texts)})
+    cc = os.environ.get("CC", "cc")
+    subprocess.run([cc, "-std=c11", "-Wall", "-Werror", "-I", ROOT, "-I", tmp, src, "-o", exe], check=True)
+    out = subprocess.run([exe], check=True, capture_output=True, text=True).stdout.splitlines()
+
+    glyphs, decoded = {}, {}
+    i = 0
+    while i < len(out):
+        head = out[i].split()
+        if head[0] == "G":
+            cp, width, advance, xoff = (int(v) for v in head[1:])
+            rows = out[i + 1:i + 1 + height_of(out, i)]
+            glyphs[cp] = (width, advance, xoff, rows)
+        else:
+            decoded[int(head[1])] = (int(head[2]), out[i + 1:i + 1 + height_of(out, i)])
+        i += 1 + height_of(out, i)
+    return glyphs, decoded
+
+
+def height_of(out, i):
+    n = 0
+    while i + 1 + n < len(out) and out[i + 1 + n][:1] in ("", "0", "1"):
+        n += 1
+    return n
+
+
+def check_font(tmp, bdf, name, texts, extra_args=(), committed=None):
+    header = os.path.join(tmp, name + ".h")
+    with open(header, "w") as f:
+        subprocess.run([sys.executable, FONTGEN, bdf, "--name", name] + list(extra_args),
+                       check=True, stdout=f, stderr=subprocess.DEVNULL)
+    errors = []
+    if committed:
+        with open(committed) as a, open(header) as b:
+            if a.read() != b.read():
+                errors.append("%s difere do gerado a partir de %s" % (os.path.basename(committed), bdf))
+
+    source, height = read_bdf(bdf)
+    glyphs, decoded = decode(tmp, os.path.basename(header), name, texts)
+    for cp, (width, advance, xoff, rows) in glyphs.items():
+        want_advance, dots = source.get(cp, (0, set()))
+        got = {(xoff + x, y) for y, row in enumerate(rows) for x, v in enumerate(row) if v == "1"}
+        if got != dots or (cp in source and advance != want_advance):
+            errors.append("%s U+%04X: glifo decodificado difere do BDF" % (name, cp))
+    for t, (width, rows) in decoded.items():
+        want = expected_text(source, height, texts[t])
+        if rows != want:
+            errors.append("%s texto %r: linha decodificada difere" % (name, texts[t]))
+        if width != len(want[0]):
+            errors.append("%s texto %r: largura %u, esperada %u" % (name, texts[t], width, len(want[0])))
+    return errors
+
+
+def main():
+    errors = []
+    with tempfile.TemporaryDirectory() as tmp:
+        bdf = os.path.join(tmp, "sintetica.bdf")
+        with open(bdf, "w") as f:
+            f.write(SYNTHETIC_BDF)
+        errors += check_font(tmp, bdf, "sintetica_bits", SYNTHETIC_TEXTS, ("--first", "0x20", "--last", "0x44"))
+        errors += check_font(tmp, bdf, "sintetica_rle", SYNTHETIC_TEXTS, ("--first", "0x20", "--last", "0x44", "--rle"))
+        errors += check_font(tmp, os.path.join(TOOLS, "st7735_font_7x10.bdf"), "st7735_font_7x10_packed",
+                             SHIPPED_TEXTS, ("--rle",), os.path.join(ROOT, "st7735_font_7x10_packed.h"))
+
+    for error in errors:
+        print(error, file=sys.stderr)
+    print("st7735_fontcheck: %s" % ("%u erro(s)" % len(errors) if errors else "ok"))
+    sys.exit(1 if errors else 0)
+
+
+if __name__ == "__main__":
+    main()
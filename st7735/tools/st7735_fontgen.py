@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+"""
+Gera fontes compactadas (st7735_packed_font.h) a partir de arquivos BDF ou TTF.
+
+Uso:
+    st7735_fontgen.py fonte.bdf --name st7735_font_8x13 > st7735_font_8x13.h
+    st7735_fontgen.py fonte.ttf --size 14 --name st7735_font_sans14 --rle > st7735_font_sans14.h
+
+Por padrão são gerados os codepoints 0x20-0xFF (ASCII + Latin-1), suficientes
+para textos em português. TTF exige o pacote Pillow.
+"""
+import argparse
+import sys
+
+
+def parse_bdf(path, first, last):
+    """Lê um BDF e retorna (altura, {codepoint: (advance, xoff, linhas)})."""
+    ascent = descent = None
+    glyphs = {}
+    with open(path, encoding="latin-1") as f:
+        lines = iter(f.read().splitlines())
+
+    for line in lines:
+        key, _, value = line.partition(" ")
+        if key == "FONT_ASCENT":
+            ascent = int(value)
+        elif key == "FONT_DESCENT":
+            descent = int(value)
+        elif key == "STARTCHAR":
+            cp = advance = None
+            bbx = (0, 0, 0, 0)
+            rows = []
+            for line in lines:
+                key, _, value = line.partition(" ")
+                if key == "ENCODING":
+                    cp = int(value.split()[0])
+                elif key == "DWIDTH":
+                    advance = int(value.split()[0])
+                elif key == "BBX":
+                    bbx = tuple(int(v) for v in value.split())
+                elif key == "BITMAP":
+                    for line in lines:
+                        line = line.strip()
+                        if line.startswith("ENDCHAR"):
+                            break
+                        # Cada linha tem ceil(w / 8) bytes em hexadecimal, MSB = pixel mais à esquerda
+                        rows.append((int(line, 16), len(line) * 4))
+                    break
+            if cp is None or not first <= cp <= last:
+                continue
+            glyphs[cp] = (advance, bbx, rows)
+
+    if ascent is None or descent is None:
+        sys.exit("BDF sem FONT_ASCENT/FONT_DESCENT")
+
+    height = ascent + descent
+    out = {}
+    for cp, (advance, (w, h, xoff, yoff), rows) in glyphs.items():
+        cell = [[0] * w for _ in range(height)]
+        top = ascent - (yoff + h)
+        for r, (bits, nbits) in enumerate(rows):
+            y = top + r
+            if not 0 <= y < height:
+                continue
+            for x in range(min(w, nbits)):
+                if bits >> (nbits - 1 - x) & 1:
+                    cell[y][x] = 1
+        # A célula começa em xoff (negativo para glifos que avançam sobre o anterior)
+        out[cp] = (advance if advance is not None else max(xoff + w, 0), xoff, cell)
+    return height, out
+
+
+def render_ttf(path, size, first, last):
+    """Rasteriza um TTF com o Pillow e retorna (altura, {codepoint: (advance, xoff, linhas)})."""
+    try:
+        from PIL import Image, ImageDraw, ImageFont
+    except ImportError:
+        sys.exit("TTF requer o pacote Pillow (pip install pillow)")
+
+    font = ImageFont.truetype(path, size)
+    ascent, descent = font.getmetrics()
+    height = ascent + descent
+    out = {}
+    for cp in range(first, last + 1):
+        ch = chr(cp)
+        advance = int(round(font.getlength(ch)))
+        if advance <= 0:
+            continue
+        # Margem de `size` pixels à esquerda e à direita para não cortar apoios negativos e saliências
+        img = Image.new("L", (advance + 2 * size, height), 0)
+        ImageDraw.Draw(img).text((size, 0), ch, font=font, fill=255)
+        px = img.load()
+        cell = [[1 if px[x, y] > 127 else 0 for x in range(img.width)] for y in range(height)]
+        out[cp] = (advance, -size, cell)
+    return height, out
+
+
+def crop(cell, xoff):
+    """Remove colunas vazias dos dois lados; retorna (linhas, largura, xoff ajustado)."""
+    left, right = None, 0
+    for row in cell:
+        for x, v in enumerate(row):
+            if v:
+                left = x if left is None else min(left, x)
+                right = max(right, x + 1)
+    if left is None:
+        return [[] for _ in cell], 0, 0
+    return [row[left:right] for row in cell], right - left, xoff + left
+
+
+def rle(pixels):
+    """Codifica pixels em bytes: bit 7 = valor, bits 0-6 = comprimento - 1."""
+    out = []
+    i = 0
+    while i < len(pixels):
+        value = pixels[i]
+        n = 1
+        while i + n < len(pixels) and pixels[i + n] == value and n < 128:
+            n += 1
+        out.append((0x80 if value else 0) | (n - 1))
+        i += n
+    return out
+
+
+class BitWriter:
+    def __init__(self):
+        self.data = bytearray()
+        self.bits = 0
+
+    def align(self):
+        self.bits = (self.bits + 7) & ~7
+
+    def put(self, value):
+        if self.bits >> 3 >= len(self.data):
+            self.data.append(0)
+        if value:
+            self.data[self.bits >> 3] |= 0x80 >> (self.bits & 7)
+        self.bits += 1
+
+    def put_bytes(self, data):
+        self.align()
+        self.data = self.data[: self.bits >> 3]
+        self.data.extend(data)
+        self.bits = len(self.data) * 8
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("font", help="arquivo .bdf ou .ttf/.otf")
+    ap.add_argument("--name", required=True, help="nome C da fonte gerada")
+    ap.add_argument("--size", type=int, default=12, help="tamanho em pixels (TTF)")
+    ap.add_argument("--first", type=lambda v: int(v, 0), default=0x20)
+    ap.add_argument("--last", type=lambda v: int(v, 0), default=0xFF)
+    ap.add_argument("--rle", action="store_true", help="usa RLE nos glifos em que ela reduz o tamanho")
+    args = ap.parse_args()
+
+    if args.font.lower().endswith(".bdf"):
+        height, glyphs = parse_bdf(args.font, args.first, args.last)
+    else:
+        height, glyphs = render_ttf(args.font, args.size, args.first, args.last)
+
+    writer = BitWriter()
+    table = []
+    for cp in range(args.first, args.last + 1):
+        if cp not in glyphs:
+            table.append((0, 0, 0, 0, 0, cp))
+            continue
+        advance, xoff, cell = glyphs[cp]
+        cell, width, xoff = crop(cell, xoff)
+        label = "U+%04X" % cp
+        if width > 255 or not 0 <= advance <= 255:
+            sys.exit("%s: largura %u / avanço %d fora do campo de 8 bits" % (label, width, advance))
+        if not -128 <= xoff <= 127:
+            sys.exit("%s: deslocamento %d fora do campo de 8 bits" % (label, xoff))
+        pixels = [v for row in cell for v in row]
+        encoded = rle(pixels) if args.rle and pixels else None
+        if encoded is not None and len(encoded) * 8 < len(pixels):
+            writer.put_bytes(encoded)
+            table.append((len(writer.data) - len(encoded), width, advance, 1, xoff, cp))
+        else:
+            offset = writer.bits
+            for v in pixels:
+                writer.put(v)
+            table.append((offset, width, advance, 0, xoff, cp))
+
+    name = args.name
+    print("/* Gerado por st7735_fontgen.py a partir de %s */" % args.font.replace("\\", "/").split("/")[-1])
+    print("#ifndef %s_H" % name.upper())
+    print("#define %s_H\n" % name.upper())
+    print('#include "st7735_packed_font.h"\n')
+    print("static const uint8_t %s_bitmap[] = {" % name)
+    for i in range(0, len(writer.data), 16):
+        print("    " + ", ".join("0x%02X" % b for b in writer.data[i:i + 16]) + ",")
+    print("};\n")
+    print("static const st7735_glyph_t %s_glyphs[] = {" % name)
+    for offset, width, advance, flags, xoff, cp in table:
+        label = chr(cp) if 0x20 < cp < 0x7F and chr(cp) not in "\\" else "U+%04X" % cp
+        print("    {%u, %u, %u, %u, %d}, // %s" % (offset, width, advance, flags, xoff, label))
+    print("};\n")
+    print("static const st7735_packed_font_t %s = {" % name)
+    print("    %u, 0x%02X, %u, %s_glyphs, %s_bitmap" % (height, args.first, len(table), name, name))
+    print("};\n")
+    print("#endif // %s_H" % name.upper())
+
+    size = len(writer.data) + len(table) * 8
+    print("%s: %u glifos, altura %u, %u bytes (bitmap %u + tabela %u)"
+          % (name, len(table), height, size, len(writer.data), len(table) * 8), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()